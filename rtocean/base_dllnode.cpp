@@ -1,15 +1,15 @@
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-#include "base_dllnode.h"
-
-////////////////////////////////////////////////////////////////
-// PUBLIC METHODS
-////////////////////////////////////////////////////////////////
-
-base_dllnode::base_dllnode(base_dllnode* next_node)
-{
-    n = next_node;
-    p = 0;
-}
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+#include "base_dllnode.h"
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+base_dllnode::base_dllnode(base_dllnode* next_node)
+{
+    n = next_node;
+    p = 0;
+}
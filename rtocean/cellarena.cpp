@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <new>
+
+// Own includes
+#include "cellarena.h"
+#include "octcell.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+cellarena::cellarena()
+{
+    num_unused_in_last_chunk = 0;
+}
+
+cellarena::~cellarena()
+{
+    for (uint i = 0; i < chunks.size(); i++) {
+        ::operator delete(chunks[i]);
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+octcell* cellarena::create_block()
+{
+    if (!free_blocks.empty()) {
+        octcell* block = free_blocks.back();
+        free_blocks.pop_back();
+        return block;
+    }
+    if (!num_unused_in_last_chunk) {
+        chunks.push_back(::operator new(BLOCKS_PER_CHUNK * octcell::MAX_NUM_CHILDREN * sizeof(octcell)));
+        num_unused_in_last_chunk = BLOCKS_PER_CHUNK;
+    }
+    octcell* block = static_cast<octcell*>(chunks.back()) +
+            (BLOCKS_PER_CHUNK - num_unused_in_last_chunk) * octcell::MAX_NUM_CHILDREN;
+    num_unused_in_last_chunk--;
+    return block;
+}
+
+void cellarena::release_block(octcell* block)
+{
+    free_blocks.push_back(block);
+}
+
+/* Takes over the chunks and the released blocks of another arena, which is left empty */
+void cellarena::adopt(cellarena& other)
+{
+    if (!other.chunks.empty()) {
+        /* The last chunk is no longer the last one, so the blocks left in it are handed out as released ones */
+        for (; num_unused_in_last_chunk; num_unused_in_last_chunk--) {
+            free_blocks.push_back(static_cast<octcell*>(chunks.back()) +
+                                  (BLOCKS_PER_CHUNK - num_unused_in_last_chunk) * octcell::MAX_NUM_CHILDREN);
+        }
+        chunks.insert(chunks.end(), other.chunks.begin(), other.chunks.end());
+        num_unused_in_last_chunk = other.num_unused_in_last_chunk;
+    }
+    free_blocks.insert(free_blocks.end(), other.free_blocks.begin(), other.free_blocks.end());
+    other.chunks.clear();
+    other.free_blocks.clear();
+    other.num_unused_in_last_chunk = 0;
+}
@@ -0,0 +1,79 @@
+#ifndef CELLARENA_H
+#define CELLARENA_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "definitions.h"
+
+////////////////////////////////////////////////////////////////
+// PREDECLARATIONS
+////////////////////////////////////////////////////////////////
+
+class octcell;
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * Hands out sibling blocks, i.e. uninitialized memory for the MAX_NUM_CHILDREN
+ * children of a cell, so that siblings are stored next to each other. The blocks
+ * are allocated in large chunks and released blocks are reused. All chunks are
+ * freed together when the arena is destroyed; the cells in them must have been
+ * destroyed by then.
+ */
+class cellarena
+{
+public:
+    cellarena();
+    ~cellarena();
+
+public:
+    /* Public methods */
+    octcell* create_block();
+    void     release_block(octcell* block);
+    void     adopt(cellarena& other);
+    uint     get_number_of_allocations() const;
+    uint     get_number_of_blocks_in_use() const;
+
+private:
+    /* Private constants */
+    static const uint BLOCKS_PER_CHUNK = 256;
+
+private:
+    /* Private member variables */
+    std::vector<void*>    chunks; /* The allocated chunks of raw memory */
+    std::vector<octcell*> free_blocks; /* Released blocks */
+    uint                  num_unused_in_last_chunk; /* The number of blocks never handed out from the last chunk */
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    cellarena(cellarena&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* The number of heap allocations made by the arena */
+inline
+uint cellarena::get_number_of_allocations() const
+{
+    return chunks.size();
+}
+
+inline
+uint cellarena::get_number_of_blocks_in_use() const
+{
+    return chunks.size() * BLOCKS_PER_CHUNK - num_unused_in_last_chunk - free_blocks.size();
+}
+
+#endif // CELLARENA_H
@@ -0,0 +1,155 @@
+#ifndef DLLNODEPOOL_H
+#define DLLNODEPOOL_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <new>
+#include <vector>
+
+// Own include files
+#include "dllnode.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * Allocates list nodes in large blocks instead of one by one. Released nodes are
+ * put on a free list and reused before a new block is allocated. All blocks are
+ * freed together when the pool is destroyed, without destroying the nodes that
+ * are still in use, so the lists using the nodes must not be used after that.
+ */
+template<typename T>
+class dllnodepool
+{
+public:
+    dllnodepool<T>();
+    ~dllnodepool<T>();
+
+public:
+    // Public methods
+    dllnode<T>* create();
+    void        release(dllnode<T>* node);
+    void        adopt(dllnodepool<T>& other);
+    uint        get_number_of_allocations() const;
+    uint        get_number_of_created_nodes() const;
+    uint        get_number_of_nodes_in_use() const;
+
+private:
+    /* Private constants */
+    static const uint BLOCK_SIZE = 4096; /* Nodes per block */
+
+private:
+    /* Private member variables */
+    std::vector<void*>       blocks; /* The allocated blocks of raw memory */
+    std::vector<dllnode<T>*> free_nodes; /* Released nodes */
+    uint num_unused_in_last_block; /* The number of nodes never handed out from the last block */
+    uint num_created; /* The number of nodes that have been created in total */
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    dllnodepool<T>(dllnodepool<T>&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTUR
+////////////////////////////////////////////////////////////////
+
+/* Default constructor */
+template<typename T>
+dllnodepool<T>::dllnodepool()
+{
+    num_unused_in_last_block = 0;
+    num_created = 0;
+}
+
+/* Destructor */
+template<typename T>
+dllnodepool<T>::~dllnodepool()
+{
+    for (uint i = 0; i < blocks.size(); i++) {
+        ::operator delete(blocks[i]);
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Creates a node, using the default constructor of the type, that is not in any list */
+template<typename T>
+dllnode<T>* dllnodepool<T>::create()
+{
+    void* mem;
+    if (!free_nodes.empty()) {
+        mem = free_nodes.back();
+        free_nodes.pop_back();
+    }
+    else {
+        if (!num_unused_in_last_block) {
+            blocks.push_back(::operator new(BLOCK_SIZE * sizeof(dllnode<T>)));
+            num_unused_in_last_block = BLOCK_SIZE;
+        }
+        mem = static_cast<dllnode<T>*>(blocks.back()) + (BLOCK_SIZE - num_unused_in_last_block);
+        num_unused_in_last_block--;
+    }
+    num_created++;
+    return new (mem) dllnode<T>(0);
+}
+
+/* Destroys a node that has already been removed from its list */
+template<typename T>
+void dllnodepool<T>::release(dllnode<T>* node)
+{
+    node->~dllnode<T>();
+    free_nodes.push_back(node);
+}
+
+/* Takes over the blocks and the released nodes of another pool, which is left empty */
+template<typename T>
+void dllnodepool<T>::adopt(dllnodepool<T>& other)
+{
+    if (!other.blocks.empty()) {
+        /* The last block is no longer the last one, so the nodes left in it are handed out as released ones */
+        for (; num_unused_in_last_block; num_unused_in_last_block--) {
+            free_nodes.push_back(static_cast<dllnode<T>*>(blocks.back()) + (BLOCK_SIZE - num_unused_in_last_block));
+        }
+        blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+        num_unused_in_last_block = other.num_unused_in_last_block;
+    }
+    free_nodes.insert(free_nodes.end(), other.free_nodes.begin(), other.free_nodes.end());
+    num_created += other.num_created;
+    other.blocks.clear();
+    other.free_nodes.clear();
+    other.num_unused_in_last_block = 0;
+    other.num_created = 0;
+}
+
+/* The number of heap allocations made by the pool */
+template<typename T>
+inline
+uint dllnodepool<T>::get_number_of_allocations() const
+{
+    return blocks.size();
+}
+
+template<typename T>
+inline
+uint dllnodepool<T>::get_number_of_created_nodes() const
+{
+    return num_created;
+}
+
+template<typename T>
+inline
+uint dllnodepool<T>::get_number_of_nodes_in_use() const
+{
+    return blocks.size() * BLOCK_SIZE - num_unused_in_last_block - free_nodes.size();
+}
+
+#endif // DLLNODEPOOL_H
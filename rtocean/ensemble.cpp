@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::out_of_range;
+
+// Own includes
+#include "ensemble.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+ensemble::ensemble(uint number_of_threads)
+{
+    workers.set_number_of_threads(number_of_threads);
+    num_time_steps = 0;
+    run_time = 0;
+}
+
+ensemble::~ensemble()
+{
+    for (uint i = 0; i < members.size(); i++) {
+        members[i]->system.undefine_water();
+        delete members[i];
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Adds a simulation of the water, which the ensemble takes over and deletes, and returns its index */
+uint ensemble::add_member(fvoctree* water, pftype time_step)
+{
+    member* m = new member;
+    m->system.set_number_of_threads(1);
+    m->system.define_water(water, 0, false, time_step);
+    m->system.set_state_updated_callback(count_time_step, m);
+    m->water = water;
+    m->time_step = time_step;
+    m->num_time_steps_left = 0;
+    m->result.num_time_steps = 0;
+    m->result.run_time = 0;
+    m->result.simulated_time = 0;
+    m->result.num_leaf_cells = 0;
+    m->result.water_volume = 0;
+    members.push_back(m);
+    return members.size() - 1;
+}
+
+watersystem& ensemble::get_member(uint member)
+{
+#if  DEBUG
+    if (member >= members.size()) {
+        throw out_of_range("Trying to get a member that is not in the ensemble");
+    }
+#endif
+    return members[member]->system;
+}
+
+const ensemble::member_result& ensemble::get_result(uint member) const
+{
+#if  DEBUG
+    if (member >= members.size()) {
+        throw out_of_range("Trying to get the result of a member that is not in the ensemble");
+    }
+#endif
+    return members[member]->result;
+}
+
+/* Runs every member for the number of time steps, continuing from where the last run stopped */
+void ensemble::run(uint num_time_steps)
+{
+    this->num_time_steps = num_time_steps;
+    double start = threadpool::get_seconds();
+    if (num_time_steps) {
+        workers.run(&ensemble::run_members, this, members.size());
+    }
+    run_time = threadpool::get_seconds() - start;
+}
+
+/* The time steps of all the members together per second of the last run */
+double ensemble::get_time_steps_per_second() const
+{
+    return run_time ? double(num_time_steps) * members.size() / run_time : 0;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Runs a range of the members one after the other, and sums up how they ended */
+void ensemble::run_members(void* ensemble_object, uint part, uint first, uint end)
+{
+    ensemble* e = static_cast<ensemble*>(ensemble_object);
+    for (uint i = first; i < end; i++) {
+        member* m = e->members[i];
+        m->num_time_steps_left = e->num_time_steps;
+        double start = threadpool::get_seconds();
+        m->system.run_simulation(m->time_step);
+        member_result& r = m->result;
+        r.num_time_steps = e->num_time_steps - m->num_time_steps_left;
+        r.run_time = threadpool::get_seconds() - start;
+        r.simulated_time = m->system.get_time();
+
+        /* The last time step may have changed the topology */
+        m->water->update_leaf_store();
+        const leafstore& lf = m->water->leaves;
+        r.num_leaf_cells = lf.size();
+        r.water_volume = 0;
+        for (uint idx = 0; idx < lf.size(); idx++) {
+            r.water_volume += lf.water_vol_coeff[idx] * lf.get_cube_volume(idx);
+        }
+    }
+    part = part;
+}
+
+/*
+ * Called by a member between its time steps, after the first one. The member is paused rather
+ * than aborted after its last time step, since the main loop of an aborted simulation still runs
+ * one more time step.
+ */
+void ensemble::count_time_step(void* member_object)
+{
+    member* m = static_cast<member*>(member_object);
+    if (!--m->num_time_steps_left) {
+        m->system.pause_simulation();
+    }
+}
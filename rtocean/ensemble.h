@@ -0,0 +1,116 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "watersystem.h"
+#include "threadpool.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * Independent simulations run side by side in one process, such as the runs of
+ * a parameter sweep. Every member is a watersystem of its own, with its own tree,
+ * and runs its solver passes on the thread that runs the member: the members are
+ * shared out between the threads of the ensemble rather than each one being split
+ * between them, so nothing has to be synchronized but the start and the end of a
+ * run. The members may be set up differently through get_member before they are
+ * run (passes_fused, instruction set), and may have trees of different surface
+ * accuracies; they are run for the same number of time steps.
+ */
+class ensemble
+{
+public:
+    /* Types */
+    struct member_result {
+        uint   num_time_steps; /* Run by the last call to run */
+        double run_time; /* [s] Of the last call to run */
+        patype simulated_time; /* [s] The time of the simulation at the end */
+        uint   num_leaf_cells; /* At the end */
+        double water_volume; /* [m^NUM_DIMENSIONS] At the end */
+    };
+
+public:
+    /* Constructors and destructor */
+    ensemble(uint number_of_threads = NUM_ENSEMBLE_THREADS);
+    ~ensemble();
+
+public:
+    /* Public methods */
+    uint   add_member(fvoctree* water, pftype time_step = SIMULATION_TIME_STEP);
+    uint   get_number_of_members() const;
+    watersystem& get_member(uint member);
+    const member_result& get_result(uint member) const;
+    void   run(uint num_time_steps);
+    uint   get_number_of_threads() const;
+    void   set_number_of_threads(uint number_of_threads);
+    double get_run_time() const;
+    double get_time_steps_per_second() const;
+
+private:
+    /* Private types */
+    struct member {
+        watersystem   system;
+        fvoctree*     water;
+        pftype        time_step;
+        uint          num_time_steps_left;
+        member_result result;
+    };
+
+private:
+    /* Private member variables */
+    threadpool workers; /* Runs the members, one task each */
+    std::vector<member*> members;
+    uint   num_time_steps; /* Per member, in the last run */
+    double run_time; /* [s] Of the last run, from its start until the last member finished */
+
+private:
+    /* Private static methods */
+    static void run_members(void* ensemble_object, uint part, uint first, uint end);
+    static void count_time_step(void* member_object);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    ensemble(ensemble&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+uint ensemble::get_number_of_members() const
+{
+    return members.size();
+}
+
+inline
+uint ensemble::get_number_of_threads() const
+{
+    return workers.get_number_of_threads();
+}
+
+inline
+void ensemble::set_number_of_threads(uint number_of_threads)
+{
+    workers.set_number_of_threads(number_of_threads);
+}
+
+/* [s] The wall clock time of the last run */
+inline
+double ensemble::get_run_time() const
+{
+    return run_time;
+}
+
+#endif // ENSEMBLE_H
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::logic_error;
+
+// Own includes
+#include "facestore.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+facestore::facestore()
+{
+    num_used = 0;
+}
+
+facestore::~facestore()
+{
+    for (uint i = 0; i < blocks.size(); i++) {
+        delete[] blocks[i];
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+octface* facestore::create()
+{
+    uint idx;
+    if (!free_idx.empty()) {
+        idx = free_idx.back();
+        free_idx.pop_back();
+    }
+    else {
+        if (num_used == blocks.size() * BLOCK_SIZE) {
+            blocks.push_back(new octface[BLOCK_SIZE]);
+        }
+        idx = num_used++;
+    }
+    octface* f = &(*this)[idx];
+    f->idx = idx;
+    return f;
+}
+
+void facestore::release(octface* f)
+{
+#if  DEBUG
+    if (f->idx >= num_used || &(*this)[f->idx] != f) {
+        throw logic_error("Trying to release a face that does not belong to the face store");
+    }
+#endif
+    free_idx.push_back(f->idx);
+}
+
+/* Takes over the faces of another store, which is left empty. The faces keep their addresses but are given new indexes. */
+void facestore::adopt(facestore& other)
+{
+    if (other.blocks.empty()) {
+        return;
+    }
+    /* The faces never handed out from the last block are handed out as released ones */
+    for (; num_used < blocks.size() * BLOCK_SIZE; num_used++) {
+        free_idx.push_back(num_used);
+    }
+    uint offset = num_used;
+    for (uint idx = 0; idx < other.num_used; idx++) {
+        other[idx].idx = offset + idx;
+    }
+    for (uint i = 0; i < other.free_idx.size(); i++) {
+        free_idx.push_back(offset + other.free_idx[i]);
+    }
+    blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+    num_used = offset + other.num_used;
+    other.blocks.clear();
+    other.free_idx.clear();
+    other.num_used = 0;
+}
@@ -0,0 +1,71 @@
+#ifndef FACESTORE_H
+#define FACESTORE_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "octface.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * Owns the cell faces of a tree. The faces are allocated in fixed-size blocks,
+ * so a face keeps both its address and its index for as long as it exists, and
+ * released faces are reused before the store grows.
+ */
+class facestore
+{
+public:
+    facestore();
+    ~facestore();
+
+public:
+    /* Public methods */
+    octface* create();
+    void     release(octface* f);
+    void     adopt(facestore& other);
+    uint     get_number_of_faces() const;
+    octface& operator[](uint idx);
+
+private:
+    /* Private constants */
+    static const uint BLOCK_SIZE_LOG2 = 10;
+    static const uint BLOCK_SIZE      = 1 << BLOCK_SIZE_LOG2;
+
+private:
+    /* Private member variables */
+    std::vector<octface*> blocks; /* The blocks of faces */
+    std::vector<uint>     free_idx; /* Indexes of released faces */
+    uint                  num_used; /* The number of faces that have been handed out from the blocks */
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    facestore(facestore&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+uint facestore::get_number_of_faces() const
+{
+    return num_used - free_idx.size();
+}
+
+inline
+octface& facestore::operator[](uint idx)
+{
+    return blocks[idx >> BLOCK_SIZE_LOG2][idx & (BLOCK_SIZE - 1)];
+}
+
+#endif // FACESTORE_H
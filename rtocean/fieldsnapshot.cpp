@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "fieldsnapshot.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+fieldsnapshot::fieldsnapshot()
+{
+    time = 0;
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*
+ * Copies the fields of the tree. The arrays keep their capacity, so capturing into
+ * the same snapshot again does not allocate unless the tree has grown. Must not be
+ * called while a time step is being taken.
+ */
+void fieldsnapshot::capture(fvoctree* tree, patype current_time)
+{
+    time = current_time;
+    leaves           .clear();
+    parents          .clear();
+    face_velocities  .clear();
+    center_velocities.clear();
+    connections      .clear();
+    if (!tree->root) {
+        return;
+    }
+
+    tree->update_leaf_store();
+    const leafstore& lf = tree->leaves;
+    leaves.resize(lf.size());
+    for (uint idx = 0; idx < lf.size(); idx++) {
+        capture_leaf_cell(lf, idx);
+#if  DRAW_CELL_FACE_VELOCITIES
+        capture_face_velocities(lf, idx);
+#endif
+#if  DRAW_CELL_CENTER_VELOCITIES
+        capture_center_velocity(lf, idx);
+#endif
+#if  DRAW_NEIGHBOR_CONNECTIONS && VISUALIZE_ONLY_FINEST_NEIGHBOR_CONNECTIONS
+        capture_finest_neighbor_connections(lf, idx);
+#endif
+    }
+#if  DRAW_CELL_CUBES && DRAW_PARENT_CELLS && !DRAW_ONLY_SURFACE_CELLS
+    capture_parent_cells_recursively(tree->root);
+#endif
+#if  DRAW_NEIGHBOR_CONNECTIONS && !VISUALIZE_ONLY_FINEST_NEIGHBOR_CONNECTIONS
+    capture_neighbor_connections_recursively(tree->root);
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+/* The divergences are calculated as in octcell, but over the neighbor spans of the leaf store */
+void fieldsnapshot::capture_leaf_cell(const leafstore& lf, uint idx)
+{
+    cell& c = leaves[idx];
+    c.corner          = lf.cell[idx]->get_corner();
+    c.s               = lf.s[idx];
+    c.p               = lf.p[idx];
+    c.water_vol_coeff = lf.water_vol_coeff[idx];
+    c.total_vol_coeff = lf.total_vol_coeff[idx];
+
+    pftype vel_div  = 0;
+    pftype flow_div = 0;
+    for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+        const octface* f = lf.neighbor_face[i];
+        pftype vel_out = f->get_vel_out(lf.neighbor_pos_dir[i]);
+        vel_div  += vel_out * f->cf_area;
+        flow_div += vel_out * f->water_vol_coeff * f->cf_area;
+    }
+    c.velocity_divergence   = vel_div  * lf.get_inverse_cube_volume(idx);
+    c.water_flow_divergence = flow_div * lf.get_inverse_cube_volume(idx);
+}
+
+void fieldsnapshot::capture_face_velocities(const leafstore& lf, uint idx)
+{
+    const pftype water_limit = 0.0001;
+
+    pfvec center1 = lf.cell[idx]->get_cell_center();
+    for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+        uint n = lf.neighbor[i];
+        pftype vel_out = lf.neighbor_face[i]->get_vel_out(lf.neighbor_pos_dir[i]);
+        if (DRAW_ALL_VELOCITIES ||
+                ((lf.water_vol_coeff[idx] > water_limit || lf.water_vol_coeff[n] > water_limit)
+                && vel_out > 0)) {
+            pfvec center2 = lf.cell[n]->get_cell_center();
+            arrow a;
+            a.start    = (center1 + center2)/2;
+            a.velocity = (center2 - center1).normalized() * vel_out;
+            face_velocities.push_back(a);
+        }
+    }
+}
+
+void fieldsnapshot::capture_center_velocity(const leafstore& lf, uint idx)
+{
+    const pftype water_limit = 0.0001;
+
+    pfvec average_velocity;
+    pfvec mixed_area;
+    pfvec air_area;
+    for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+        const octface* f = lf.neighbor_face[i];
+        if (DRAW_ALL_VELOCITIES ||
+                (lf.water_vol_coeff[idx] > water_limit || lf.water_vol_coeff[lf.neighbor[i]] > water_limit)) {
+            mixed_area[f->dim] += f->cf_area;
+            average_velocity.e[f->dim] += f->vel * f->cf_area;
+        }
+        else {
+            air_area[f->dim] += f->cf_area;
+        }
+    }
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        if (mixed_area[dim]) {
+            average_velocity[dim] /= mixed_area[dim];
+        }
+        else if (air_area[dim]) {
+            /* Borders only to air cells in this dimension */
+            return;
+        }
+    }
+    arrow a;
+    a.start    = lf.cell[idx]->get_cell_center();
+    a.velocity = average_velocity;
+    center_velocities.push_back(a);
+}
+
+void fieldsnapshot::capture_parent_cells_recursively(const octcell* c)
+{
+    if (c->is_leaf()) {
+        return;
+    }
+    if (c->get_number_of_children() < octcell::MAX_NUM_CHILDREN) {
+        cube parent;
+        parent.corner = c->get_corner();
+        parent.s      = c->get_edge_length();
+        parents.push_back(parent);
+    }
+
+    for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
+        if (c->has_child(i)) {
+            capture_parent_cells_recursively(c->get_child(i));
+        }
+    }
+}
+
+/* The connections of all neighbor lists of all cells */
+void fieldsnapshot::capture_neighbor_connections_recursively(const octcell* c)
+{
+    if (c->has_child_array()) {
+        for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
+            if (c->has_child(i)) {
+                capture_neighbor_connections_recursively(c->get_child(i));
+            }
+        }
+    }
+
+    pfvec center1 = c->get_cell_center();
+    for (uint i = 0; i < NUM_NEIGHBOR_LISTS; i++) {
+        for (nlnode* node = c->neighbor_lists[i].get_first_node(); node; node = node->get_next_node()) {
+            connection con;
+            con.from = center1;
+            con.to   = node->v.n->get_cell_center();
+            con.neighbor_list_index = i;
+            connections.push_back(con);
+        }
+    }
+}
+
+/* The connections between leaf cells */
+void fieldsnapshot::capture_finest_neighbor_connections(const leafstore& lf, uint idx)
+{
+    pfvec center1 = lf.cell[idx]->get_cell_center();
+    for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+        connection con;
+        con.from = center1;
+        con.to   = lf.cell[lf.neighbor[i]]->get_cell_center();
+        con.neighbor_list_index = 0;
+        connections.push_back(con);
+    }
+}
@@ -0,0 +1,199 @@
+#ifndef FIELDSNAPSHOT_H
+#define FIELDSNAPSHOT_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "fvoctree.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * A copy of the fields of a tree at one point in time, holding what is needed to
+ * visualize them and nothing that points back into the tree. Once captured, a
+ * snapshot can be read on any thread while the solver goes on changing the tree,
+ * see snapshotbuffer.
+ *
+ * The cells have the accessors of octcell that the drawing code uses, so that
+ * drawing from a snapshot reads the same as drawing from the tree. The leaf cells
+ * are stored in the order of the leaf store, the other records are only captured
+ * if they are drawn (see the DRAW_* flags).
+ */
+class fieldsnapshot
+{
+public:
+    /* Public types */
+
+    /* An axis aligned cube */
+    struct cube {
+        pfvec  corner; /* [m] The position of the first corner */
+        pftype s;      /* [m] Edge length */
+
+        pfvec  get_corner() const;
+        pfvec  get_cell_center() const;
+        pfvec  get_opposite_corner() const;
+        pftype get_edge_length() const;
+    };
+
+    /* A leaf cell, see octcell */
+    struct cell : public cube {
+        pftype p;                     /* [Pa] */
+        pftype water_vol_coeff;       /* [1] */
+        pftype total_vol_coeff;       /* [1] */
+        pftype velocity_divergence;   /* [1/s] */
+        pftype water_flow_divergence; /* [1/s] */
+
+        bool   has_no_air() const;
+        bool   has_no_water() const;
+        bool   is_mixed_cell() const;
+        pftype get_air_volume_coefficient() const;
+        pftype get_safe_alpha() const;
+        pftype get_velocity_divergence() const;
+        pftype get_water_flow_divergence() const;
+    };
+
+    /* A velocity placed in space */
+    struct arrow {
+        pfvec start;    /* [m] */
+        pfvec velocity; /* [m/s] */
+    };
+
+    /* A neighbor connection, from the center of a cell to the center of its neighbor */
+    struct connection {
+        pfvec from; /* [m] */
+        pfvec to;   /* [m] */
+        uint  neighbor_list_index; /* The list of the first cell that holds the connection */
+    };
+
+public:
+    fieldsnapshot();
+
+public:
+    /***************************
+     * Public member variables *
+     ***************************/
+
+    patype time; /* [s] The simulation time when the snapshot was captured */
+    std::vector<cell>       leaves;
+    std::vector<cube>       parents; /* The parent cells that do not have all of their children */
+    std::vector<arrow>      face_velocities; /* One per face with flow out of the cell, at the face */
+    std::vector<arrow>      center_velocities; /* One per leaf cell that borders to water, at the cell center */
+    std::vector<connection> connections;
+
+public:
+    /* Public methods */
+    void capture(fvoctree* tree, patype current_time);
+    bool is_empty() const;
+
+private:
+    /* Private methods */
+    void capture_leaf_cell(const leafstore& lf, uint idx);
+    void capture_face_velocities(const leafstore& lf, uint idx);
+    void capture_center_velocity(const leafstore& lf, uint idx);
+    void capture_parent_cells_recursively(const octcell* c);
+    void capture_neighbor_connections_recursively(const octcell* c);
+    void capture_finest_neighbor_connections(const leafstore& lf, uint idx);
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Whether there is anything to draw */
+inline
+bool fieldsnapshot::is_empty() const
+{
+    return leaves.empty();
+}
+
+/* Cubes */
+
+inline
+pfvec fieldsnapshot::cube::get_corner() const
+{
+    return corner;
+}
+
+inline
+pfvec fieldsnapshot::cube::get_cell_center() const
+{
+    pfvec center = corner;
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        center[dim] += s/2;
+    }
+    return center;
+}
+
+inline
+pfvec fieldsnapshot::cube::get_opposite_corner() const
+{
+    pfvec opposite = corner;
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        opposite[dim] += s;
+    }
+    return opposite;
+}
+
+inline
+pftype fieldsnapshot::cube::get_edge_length() const
+{
+    return s;
+}
+
+/* Cells */
+
+inline
+bool fieldsnapshot::cell::has_no_air() const
+{
+    return water_vol_coeff >= total_vol_coeff;
+}
+
+inline
+bool fieldsnapshot::cell::has_no_water() const
+{
+    return water_vol_coeff <= 0;
+}
+
+inline
+bool fieldsnapshot::cell::is_mixed_cell() const
+{
+    return !has_no_air() && !has_no_water();
+}
+
+inline
+pftype fieldsnapshot::cell::get_air_volume_coefficient() const
+{
+    return total_vol_coeff - water_vol_coeff;
+}
+
+inline
+pftype fieldsnapshot::cell::get_safe_alpha() const
+{
+    if (total_vol_coeff) {
+        return water_vol_coeff/total_vol_coeff;
+    }
+    else {
+        return 0;
+    }
+}
+
+inline
+pftype fieldsnapshot::cell::get_velocity_divergence() const
+{
+    return velocity_divergence;
+}
+
+inline
+pftype fieldsnapshot::cell::get_water_flow_divergence() const
+{
+    return water_flow_divergence;
+}
+
+#endif // FIELDSNAPSHOT_H
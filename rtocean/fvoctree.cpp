@@ -1,211 +1,477 @@
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-// Standard includes
-#include <iostream>
-using std::cout;
-using std::endl;
-
-// Own include files
-#include "fvoctree.h"
-
-////////////////////////////////////////////////////////////////
-// CONSTRUCTORS AND DESTRUCTOR
-////////////////////////////////////////////////////////////////
-
-fvoctree::fvoctree()
-{
-    root = 0;
-}
-
-fvoctree::fvoctree(pftype surface, pftype bottom)
-{
-    bottom = bottom;
-    surface = surface;
-    octcell *c = root = new octcell(0, 1, pfvec(), 0);
-    refine_subtree(c, surface, bottom);
-    prepare_cells_for_water_recursively(c);
-}
-
-fvoctree::~fvoctree()
-{
-    if (root) {
-        delete root;
-    }
-}
-
-////////////////////////////////////////////////////////////////
-// PRIVATE NON-STATIC METHODS
-////////////////////////////////////////////////////////////////
-
-/* Returns true if the cell should be removed from the simulation */
-bool fvoctree::refine_subtree(octcell* c, pftype surface, pftype bottom)
-{
-    static int tot_num_cells = 1;
-    static int num_leaf_cells = 1;
-    pftype s = c->s;
-
-    pftype lowest_cell_height = c->r[VERTICAL_DIMENSION];
-    pftype min_max_balance = 0.5;
-#if    NUM_DIMENSIONS == 2
-#if 1 // Step profile surface
-    //pftype hdiff = .24118956;
-    pftype hdiff = 14.0/64;
-    pftype step_x_pos = 45.0/64;
-    pftype low = SURFACE_HEIGHT;
-    pftype high = SURFACE_HEIGHT + hdiff;
-    pftype min_surf_height;
-    pftype max_surf_height;
-
-    if (c->r[HORIZONTAL_DIMENSION1] < step_x_pos) {
-        min_surf_height = low;
-        if (c->get_opposite_corner()[HORIZONTAL_DIMENSION1] < step_x_pos) {
-            max_surf_height = low;
-        }
-        else {
-            max_surf_height = high;
-            min_max_balance = (step_x_pos - c->r[HORIZONTAL_DIMENSION1])/c->get_edge_length();
-        }
-    }
-    else {
-        min_surf_height = max_surf_height = high;
-    }
-
-    /*
-    pftype local_surface_height = c->get_cell_center().e[HORIZONTAL_DIMENSION1] > step_x_pos ? SURFACE_HEIGHT + hdiff/2 : SURFACE_HEIGHT - hdiff/2;
-    pftype min_surf_height = local_surface_height;
-    pftype max_surf_height = local_surface_height;
-    */
-#elif 0 // Pilar
-#if 0 // Large pilar
-    pftype hdiff = .5;
-    pftype width = .5;
-#elif 0 // High, thin pilar
-    pftype hdiff = .5;
-    pftype width = .1;
-#else  // Small pilar
-    pftype hdiff = .1;
-    pftype width = .2;
-#endif
-    pftype low  = SURFACE_HEIGHT - hdiff/2;
-    pftype high = SURFACE_HEIGHT + hdiff/2;
-    pftype min_surf_height, max_surf_height;
-    if (c->r.e[HORIZONTAL_DIMENSION1] < .5 - width/2) {
-        min_surf_height = low;
-        if (c->get_opposite_corner().e[HORIZONTAL_DIMENSION1] > .5 - width/2) {
-            max_surf_height = high;
-        }
-        else {
-            max_surf_height = low;
-        }
-    }
-    else if (c->get_opposite_corner().e[HORIZONTAL_DIMENSION1] > .5 + width/2) {
-        min_surf_height = low;
-        if (c->r.e[HORIZONTAL_DIMENSION1] < .5 + width/2) {
-            max_surf_height = high;
-        }
-        else {
-            max_surf_height = low;
-        }
-    }
-    else {
-        min_surf_height = max_surf_height = high;
-    }
-
-#else // Sloping surface
-#if 1 // Slope to the right
-    pftype left_edge_height = 0.5501;
-    pftype slope = 0.4;
-#else // Slope to the left
-    pftype left_edge_height = 0.9501;
-    pftype slope = -0.4;
-#endif
-    pftype min_surf_height = left_edge_height + slope*(c->r[HORIZONTAL_DIMENSION1] + (slope < 0 ? s : pftype(0)));
-    pftype max_surf_height = left_edge_height + slope*(c->r[HORIZONTAL_DIMENSION1] + (slope > 0 ? s : pftype(0)));
-#endif
-#elif  NUM_DIMENSIONS == 3
-    pftype min_surf_height = 0.55 + 0.2*c->r[HORIZONTAL_DIMENSION1] + 0.1*c->r[HORIZONTAL_DIMENSION2];
-    pftype max_surf_height = 0.55 + 0.2*(c->r[HORIZONTAL_DIMENSION1]+s) + 0.1*(c->r[HORIZONTAL_DIMENSION2]+s);
-#endif
-    if (lowest_cell_height >= max_surf_height) {
-        // Cell is over the surface, remove it
-        return true;
-    }
-#if 0
-    if (lowest_cell_height + s <= min_surf_height     ||  // Cell is under the surface, keep it but stop refining
-        s <= accuracy_function(c->cell_center()) ) { // Accuracy is good enough, stop refining
-#else
-    if (c->is_fine_enough()) { // Accuracy is good enough, stop refining
-#endif
-        /* Stop refining */
-        /* Calculate properties */
-        pftype beta; /* Water volume divided by the volume of the cell */
-        pftype mean_height = lowest_cell_height + s/2;
-        pftype mean_surface_height = (min_surf_height + max_surf_height)/2;
-        pftype depth = mean_surface_height - mean_height;
-        if (depth >= 0) {
-            c->p = NORMAL_AIR_PRESSURE + depth * (P_G * NORMAL_WATER_DENSITY);
-        }
-        else {
-            c->p = NORMAL_AIR_PRESSURE * exp(depth * (P_G / AIR_COMPRESSIBILITY_FACTOR));
-        }
-        if (lowest_cell_height + s > min_surf_height) {
-            /* Cell is a surface cell */
-            /* Estimate beta */
-            pftype mean_height_diff = min_max_balance*MAX(min_surf_height - lowest_cell_height, 0) + (1-min_max_balance)*MIN(pftype(max_surf_height - lowest_cell_height), s);
-            beta = mean_height_diff / c->s;
-        }
-        else {
-            /* Cell is not a surface cell and contains only water */
-            beta = 1;
-        }
-        pftype water_vol_coeff = 1 + (c->p - NORMAL_AIR_PRESSURE)*(1/ARTIFICIAL_COMPRESSIBILITY_FACTOR);
-#if  NO_ATMOSPHERE
-        pftype air_vol_coeff = water_vol_coeff;
-#else
-        pftype air_vol_coeff = c->p / NORMAL_AIR_PRESSURE;
-#endif
-        water_vol_coeff *= beta;
-        air_vol_coeff   *= (1 - beta);
-        c->set_volume_coefficients(water_vol_coeff, water_vol_coeff + air_vol_coeff);
-        return false;
-    }
-    // Cell is not fine enough, refine it and then handle the children recursivelly
-    c->refine();
-    tot_num_cells += octcell::MAX_NUM_CHILDREN;
-    num_leaf_cells += octcell::MAX_NUM_CHILDREN - 1;
-    for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
-        if (refine_subtree(c->get_child(i), surface, bottom)) {
-            c->remove_child(i);
-            tot_num_cells--;
-            num_leaf_cells--;
-        }
-    }
-#if  DEBUG
-#if  0
-    cout << "Total number of cells: " << tot_num_cells << endl;
-    cout << "Number of leaf cells:  " << num_leaf_cells << endl;
-    cout << endl;
-#endif
-    if (!c->get_number_of_children()) {
-        throw logic_error("Cell has no children and is not a leaf cell, yet it is allowed to exist");
-    }
-#endif
-    return 0;
-}
-
-void fvoctree::prepare_cells_for_water_recursively(octcell* cell)
-{
-    if (cell->is_leaf()) {
-        if (cell->has_water()) {
-            cell->prepare_for_water();
-        }
-        return;
-    }
-    for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
-        if (cell->has_child(i)) {
-            prepare_cells_for_water_recursively(cell->get_child(i));
-        }
-    }
-}
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <algorithm>
+
+// Own include files
+#include "fvoctree.h"
+#include "threadpool.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+fvoctree::fvoctree()
+{
+    root = 0;
+    being_destroyed = false;
+    surface_accuracy = SURFACE_ACCURACY;
+    stats = construction_stats();
+}
+
+fvoctree::fvoctree(pftype surface, pftype bottom, uint number_of_threads, pftype surface_accuracy)
+{
+    double start = threadpool::get_seconds();
+    being_destroyed = false;
+    this->surface_accuracy = surface_accuracy;
+    stats = construction_stats();
+    octcell *c = root = new octcell(this, 0, ivec(), 0);
+#if  OCTREE_BACKEND == LINEAR_OCTREE
+    index.insert(root->key, root);
+#endif
+    /* The cells above the subtree level are refined here, the ones below it by build_subtrees */
+    std::vector<octcell*> subtree_roots;
+    refine_subtree(c, surface, bottom, &subtree_roots);
+    threadpool workers(number_of_threads);
+    build_subtrees(workers, subtree_roots, surface, bottom);
+    prepare_cells_for_water(workers);
+    count_cells(c);
+    stats.total_time = threadpool::get_seconds() - start;
+}
+
+fvoctree::~fvoctree()
+{
+    /*
+     * The neighbor list nodes and the faces are not released one by one when the
+     * cells are deleted; they are freed together with their pools afterwards
+     */
+    being_destroyed = true;
+    if (root) {
+        delete root;
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC NON-STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Returns the cell with the given Morton key, or 0 if there is no such cell */
+octcell* fvoctree::find_cell(uint64 key) const
+{
+    octcell* c = find_smallest_cell_containing(key);
+    return c && c->key == key ? c : 0;
+}
+
+/* Returns the cell with the given Morton key, or its closest existing ancestor */
+octcell* fvoctree::find_smallest_cell_containing(uint64 key) const
+{
+#if  OCTREE_BACKEND == LINEAR_OCTREE
+    for (; key; key = morton::parent_key(key)) {
+        octcell* c = index.find(key);
+        if (c) {
+            return c;
+        }
+    }
+    return 0;
+#else
+    if (!root) {
+        return 0;
+    }
+    /* Follow the child indexes in the key from the root */
+    uint level = 0;
+    while (key >> (NUM_DIMENSIONS * (level + 1))) {
+        level++;
+    }
+    octcell* c = root;
+    for (; level; level--) {
+        uint child_idx = morton::child_index(key >> (NUM_DIMENSIONS * (level - 1)));
+        if (c->is_leaf() || !c->has_child(child_idx)) {
+            break;
+        }
+        c = c->get_child(child_idx);
+    }
+    return c;
+#endif
+}
+
+/* The size of a leaf cell should be at the maximum the value of this function applied to its cell center */
+pftype fvoctree::size_accuracy(pfvec r) const
+{
+    if (r.e[VERTICAL_DIMENSION] < SURFACE_HEIGHT) {
+        /* Cell is under the surface */
+        return size_accuracy_below_surface(SURFACE_HEIGHT - r.e[VERTICAL_DIMENSION]);
+    }
+    else {
+        return surface_accuracy;
+    }
+}
+
+/* The size accuracy at the given distance below the surface, which grows with the depth */
+pftype fvoctree::size_accuracy_below_surface(pftype depth) const
+{
+    return surface_accuracy + depth * (1/(MIN_LOD_LAYER_THICKNESS + 0.5));
+}
+
+/*
+ * Returns the cell next to c in the given direction at the same level as c, or the
+ * smallest existing cell containing that one. Returns 0 at the boundary of the root cell.
+ */
+octcell* fvoctree::find_neighbor(const octcell* c, uint dim, bool pos_dir) const
+{
+    uint64 neighbor_key;
+    if (!morton::neighbor_key(c->key, c->lvl, dim, pos_dir, neighbor_key)) {
+        return 0;
+    }
+    return find_smallest_cell_containing(neighbor_key);
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE NON-STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*
+ * Returns true if the cell should be removed from the simulation. If subtree_roots
+ * is given, the cells at TREE_SUBTREE_LEVEL that need to be refined are added to it
+ * instead.
+ */
+bool fvoctree::refine_subtree(octcell* c, pftype surface, pftype bottom, std::vector<octcell*>* subtree_roots)
+{
+    pftype s = c->get_edge_length();
+    pfvec  r = c->get_corner();
+
+    pftype lowest_cell_height = r[VERTICAL_DIMENSION];
+    pftype min_max_balance = 0.5;
+#if    NUM_DIMENSIONS == 2
+#if 1 // Step profile surface
+    //pftype hdiff = .24118956;
+    pftype hdiff = 14.0/64;
+    pftype step_x_pos = 45.0/64;
+    pftype low = SURFACE_HEIGHT;
+    pftype high = SURFACE_HEIGHT + hdiff;
+    pftype min_surf_height;
+    pftype max_surf_height;
+
+    if (r[HORIZONTAL_DIMENSION1] < step_x_pos) {
+        min_surf_height = low;
+        if (c->get_opposite_corner()[HORIZONTAL_DIMENSION1] < step_x_pos) {
+            max_surf_height = low;
+        }
+        else {
+            max_surf_height = high;
+            min_max_balance = (step_x_pos - r[HORIZONTAL_DIMENSION1])/c->get_edge_length();
+        }
+    }
+    else {
+        min_surf_height = max_surf_height = high;
+    }
+
+    /*
+    pftype local_surface_height = c->get_cell_center().e[HORIZONTAL_DIMENSION1] > step_x_pos ? SURFACE_HEIGHT + hdiff/2 : SURFACE_HEIGHT - hdiff/2;
+    pftype min_surf_height = local_surface_height;
+    pftype max_surf_height = local_surface_height;
+    */
+#elif 0 // Pilar
+#if 0 // Large pilar
+    pftype hdiff = .5;
+    pftype width = .5;
+#elif 0 // High, thin pilar
+    pftype hdiff = .5;
+    pftype width = .1;
+#else  // Small pilar
+    pftype hdiff = .1;
+    pftype width = .2;
+#endif
+    pftype low  = SURFACE_HEIGHT - hdiff/2;
+    pftype high = SURFACE_HEIGHT + hdiff/2;
+    pftype min_surf_height, max_surf_height;
+    if (r.e[HORIZONTAL_DIMENSION1] < .5 - width/2) {
+        min_surf_height = low;
+        if (c->get_opposite_corner().e[HORIZONTAL_DIMENSION1] > .5 - width/2) {
+            max_surf_height = high;
+        }
+        else {
+            max_surf_height = low;
+        }
+    }
+    else if (c->get_opposite_corner().e[HORIZONTAL_DIMENSION1] > .5 + width/2) {
+        min_surf_height = low;
+        if (r.e[HORIZONTAL_DIMENSION1] < .5 + width/2) {
+            max_surf_height = high;
+        }
+        else {
+            max_surf_height = low;
+        }
+    }
+    else {
+        min_surf_height = max_surf_height = high;
+    }
+
+#else // Sloping surface
+#if 1 // Slope to the right
+    pftype left_edge_height = 0.5501;
+    pftype slope = 0.4;
+#else // Slope to the left
+    pftype left_edge_height = 0.9501;
+    pftype slope = -0.4;
+#endif
+    pftype min_surf_height = left_edge_height + slope*(r[HORIZONTAL_DIMENSION1] + (slope < 0 ? s : pftype(0)));
+    pftype max_surf_height = left_edge_height + slope*(r[HORIZONTAL_DIMENSION1] + (slope > 0 ? s : pftype(0)));
+#endif
+#elif  NUM_DIMENSIONS == 3
+    pftype min_surf_height = 0.55 + 0.2*r[HORIZONTAL_DIMENSION1] + 0.1*r[HORIZONTAL_DIMENSION2];
+    pftype max_surf_height = 0.55 + 0.2*(r[HORIZONTAL_DIMENSION1]+s) + 0.1*(r[HORIZONTAL_DIMENSION2]+s);
+#endif
+    if (lowest_cell_height >= max_surf_height) {
+        // Cell is over the surface, remove it
+        return true;
+    }
+#if 0
+    if (lowest_cell_height + s <= min_surf_height     ||  // Cell is under the surface, keep it but stop refining
+        s <= accuracy_function(c->cell_center()) ) { // Accuracy is good enough, stop refining
+#else
+    if (c->is_fine_enough()) { // Accuracy is good enough, stop refining
+#endif
+        /* Stop refining */
+        /* Calculate properties */
+        pftype beta; /* Water volume divided by the volume of the cell */
+        pftype mean_height = lowest_cell_height + s/2;
+        pftype mean_surface_height = (min_surf_height + max_surf_height)/2;
+        pftype depth = mean_surface_height - mean_height;
+        if (depth >= 0) {
+            c->p = NORMAL_AIR_PRESSURE + depth * (P_G * NORMAL_WATER_DENSITY);
+        }
+        else {
+            c->p = NORMAL_AIR_PRESSURE * exp(depth * (P_G / AIR_COMPRESSIBILITY_FACTOR));
+        }
+        if (lowest_cell_height + s > min_surf_height) {
+            /* Cell is a surface cell */
+            /* Estimate beta */
+            pftype mean_height_diff = min_max_balance*MAX(min_surf_height - lowest_cell_height, 0) + (1-min_max_balance)*MIN(pftype(max_surf_height - lowest_cell_height), s);
+            beta = mean_height_diff / s;
+        }
+        else {
+            /* Cell is not a surface cell and contains only water */
+            beta = 1;
+        }
+#if  USE_ARTIFICIAL_COMPRESSIBILITY
+        pftype water_vol_coeff = 1 + (c->p - NORMAL_AIR_PRESSURE)*(1/ARTIFICIAL_COMPRESSIBILITY_FACTOR);
+#if  NO_ATMOSPHERE
+        pftype air_vol_coeff = water_vol_coeff;
+#else
+        pftype air_vol_coeff = c->p / NORMAL_AIR_PRESSURE;
+#endif
+#else
+        /* Neither the water nor the air is compressed, and the pressure is kept as the first guess of the solver */
+        pftype water_vol_coeff = 1;
+        pftype air_vol_coeff = 1;
+#endif
+        water_vol_coeff *= beta;
+        air_vol_coeff   *= (1 - beta);
+        c->set_volume_coefficients(water_vol_coeff, water_vol_coeff + air_vol_coeff);
+        return false;
+    }
+    if (subtree_roots && c->lvl == TREE_SUBTREE_LEVEL) {
+        /* Leave the cell to build_subtrees */
+        subtree_roots->push_back(c);
+        return false;
+    }
+    // Cell is not fine enough, refine it and then handle the children recursivelly
+    c->refine();
+    for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
+        if (refine_subtree(c->get_child(i), surface, bottom, subtree_roots)) {
+            c->remove_child(i);
+        }
+    }
+#if  DEBUG
+    if (!c->get_number_of_children()) {
+        throw logic_error("Cell has no children and is not a leaf cell, yet it is allowed to exist");
+    }
+#endif
+    return 0;
+}
+
+/*
+ * Builds the subtrees below the given cells concurrently. Each thread takes the
+ * cells, faces and neighbor list nodes it creates from the pools of a tree of its
+ * own, and the subtrees are not connected to each other while they are built, since
+ * refining a cell changes the neighbor lists of its neighbors at the same level. So
+ * the connections between the subtree roots and the cells at their level are broken
+ * first, and made again afterwards, together with the ones between the cells below
+ * them, once this tree has taken over the cells and the pools. The result does not
+ * depend on which thread builds which subtree.
+ */
+void fvoctree::build_subtrees(threadpool& workers, std::vector<octcell*>& roots, pftype surface, pftype bottom)
+{
+    double start = threadpool::get_seconds();
+
+    /* Detach the subtrees, keeping the seams between them */
+    std::vector<subtree_seam> seams;
+    for (uint i = 0; i < roots.size(); i++) {
+        octcell* c = roots[i];
+        nlset same_level_set;
+        same_level_set.add_neighbor_list(&c->neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+        same_level_set.add_neighbor_list(&c->neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
+        for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
+            subtree_seam seam;
+            seam.cell     = node->v.pos_dir ? c : node->v.n;
+            seam.neighbor = node->v.pos_dir ? node->v.n : c;
+            seam.dim      = node->v.dim;
+            seams.push_back(seam);
+        }
+        c->break_same_level_neighbor_connections();
+    }
+
+    /* Build them, one task per subtree */
+    subtree_build build;
+    build.roots   = &roots;
+    build.surface = surface;
+    build.bottom  = bottom;
+    for (uint part = 0; part < workers.get_number_of_threads(); part++) {
+        build.parts.push_back(new fvoctree());
+        build.parts.back()->surface_accuracy = surface_accuracy;
+    }
+    workers.run_tasks(&fvoctree::run_subtree_build_task, &build, &roots);
+    for (uint i = 0; i < roots.size(); i++) {
+        take_over_cells(roots[i]);
+    }
+    for (uint part = 0; part < build.parts.size(); part++) {
+        cells.adopt(build.parts[part]->cells);
+        faces.adopt(build.parts[part]->faces);
+        neighbor_nodes.adopt(build.parts[part]->neighbor_nodes);
+        delete build.parts[part];
+    }
+    double built = threadpool::get_seconds();
+
+    /* Stitch them together */
+    for (uint i = 0; i < seams.size(); i++) {
+        seams[i].cell->stitch_neighbors(seams[i].neighbor, seams[i].dim);
+    }
+    topology_changed();
+
+    stats.num_subtrees = roots.size();
+    stats.num_threads  = workers.get_number_of_threads();
+    stats.subtree_time = built - start;
+    stats.stitch_time  = threadpool::get_seconds() - built;
+}
+
+/* Makes a cell and the cells below it, which have been built in another tree, cells of this tree */
+void fvoctree::take_over_cells(octcell* c)
+{
+    c->_tree = this;
+    if (!c->has_child_array()) {
+        return;
+    }
+    for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
+        if (c->has_child(i)) {
+#if  OCTREE_BACKEND == LINEAR_OCTREE
+            index.insert(c->get_child(i)->key, c->get_child(i));
+#endif
+            take_over_cells(c->get_child(i));
+        }
+    }
+}
+
+/*
+ * Prepares the leaf cells with water for it (see octcell::prepare_for_water), in the same way as
+ * watersystem::prepare_cells_for_water: the sides that need new air cells are found by a parallel
+ * walk over the tree, which only reads it, and the cells are then created serially, in the order
+ * of the keys of the cells that ask for them, so that the tree does not depend on the threads.
+ * The faces to the cells without water are set last, once all of them exist.
+ */
+void fvoctree::prepare_cells_for_water(threadpool& workers)
+{
+    std::vector<std::vector<wetted_cell> > parts(workers.get_number_of_threads());
+    workers.run_tasks(&fvoctree::run_wetted_cell_task, &parts, root);
+    std::vector<wetted_cell> wetted;
+    for (uint part = 0; part < parts.size(); part++) {
+        wetted.insert(wetted.end(), parts[part].begin(), parts[part].end());
+    }
+    std::sort(wetted.begin(), wetted.end());
+    for (uint i = 0; i < wetted.size(); i++) {
+        for (uint side = 0; side < 2*NUM_DIMENSIONS; side++) {
+            if (wetted[i].sides & (1 << side)) {
+                /* Not guaranteed that neighbors will be created; this may be a wall */
+                wetted[i].cell->create_new_air_neighbors(side >> 1, side & 1);
+            }
+        }
+    }
+    for (uint i = 0; i < wetted.size(); i++) {
+        if (wetted[i].cell->is_leaf()) {
+            wetted[i].cell->set_velocities_to_cells_without_water(wetted[i].mean_vel);
+        }
+    }
+}
+
+void fvoctree::count_cells(const octcell* c)
+{
+    stats.num_cells++;
+    if (!c->has_child_array()) {
+        stats.num_leaf_cells++;
+        return;
+    }
+    for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
+        if (c->has_child(i)) {
+            count_cells(c->get_child(i));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*
+ * Spawns a task per subtree root when given the roots, and builds the subtree when given one of
+ * them (see threadpool). The roots are spawned last first, so that the calling thread builds them
+ * in order while the others steal them from the end.
+ */
+void fvoctree::run_subtree_build_task(threadpool* workers, void* parameter, void* argument, uint part)
+{
+    subtree_build* build = static_cast<subtree_build*>(parameter);
+    if (argument == build->roots) {
+        for (uint i = build->roots->size(); i > 0; i--) {
+            workers->spawn(&fvoctree::run_subtree_build_task, parameter, (*build->roots)[i - 1], part);
+        }
+        return;
+    }
+    octcell* c = static_cast<octcell*>(argument);
+    fvoctree* part_tree = build->parts[part];
+    c->_tree = part_tree;
+    part_tree->refine_subtree(c, build->surface, build->bottom);
+}
+
+/*
+ * Finds the sides of the leaf cells with water below a cell that need new air cells (see
+ * prepare_cells_for_water). The children of the cells above the subtree level are spawned as
+ * tasks, and the ones below it are walked by the same task.
+ */
+void fvoctree::run_wetted_cell_task(threadpool* workers, void* parameter, void* argument, uint part)
+{
+    std::vector<std::vector<wetted_cell> >* parts = static_cast<std::vector<std::vector<wetted_cell> >*>(parameter);
+    octcell* cell = static_cast<octcell*>(argument);
+    if (cell->is_leaf()) {
+        if (cell->has_water()) {
+            wetted_cell w;
+            w.cell = cell;
+            w.sides = cell->get_sides_without_water(w.mean_vel);
+            (*parts)[part].push_back(w);
+        }
+        return;
+    }
+    for (uint i = 0; i < octcell::MAX_NUM_CHILDREN; i++) {
+        if (!cell->has_child(i)) {
+            continue;
+        }
+        if (cell->lvl < TREE_SUBTREE_LEVEL) {
+            workers->spawn(&fvoctree::run_wetted_cell_task, parameter, cell->get_child(i), part);
+        }
+        else {
+            run_wetted_cell_task(workers, parameter, cell->get_child(i), part);
+        }
+    }
+}
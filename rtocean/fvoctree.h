@@ -1,40 +1,149 @@
-#ifndef FVOCTREE_H
-#define FVOCTREE_H
-
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-#include "octcell.h"
-
-////////////////////////////////////////////////////////////////
-// CLASS DEFINITION
-////////////////////////////////////////////////////////////////
-
-class fvoctree
-{
-public:
-    fvoctree();
-    fvoctree(pftype surface, pftype bottom);
-    ~fvoctree();
-
-public:
-    octcell *root;
-
-private:
-    /* Private non-static methods */
-    bool refine_subtree(octcell* c, pftype surface, pftype bottom);
-    void prepare_cells_for_water_recursively(octcell* cell);
-
-public:
-    /* Public static methods */
-    static pftype size_accuracy(pfvec r);
-
-private:
-    /*************************
-     * Disabled constructors *
-     *************************/
-    fvoctree(fvoctree&); // Copy constructor prevented from all use
-};
-
-#endif // FVOCTREE_H
+#ifndef FVOCTREE_H
+#define FVOCTREE_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "octcell.h"
+#include "leafstore.h"
+#include "facestore.h"
+#include "cellarena.h"
+#include "mortonindex.h"
+
+////////////////////////////////////////////////////////////////
+// PREDECLARATIONS
+////////////////////////////////////////////////////////////////
+
+class threadpool;
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+class fvoctree
+{
+public:
+    /* Public types */
+    struct construction_stats {
+        uint   num_cells; /* The parent cells included */
+        uint   num_leaf_cells;
+        uint   num_subtrees; /* Built concurrently, at TREE_SUBTREE_LEVEL */
+        uint   num_threads;
+        double subtree_time; /* [s] Building the subtrees */
+        double stitch_time; /* [s] Connecting the neighbors across the subtrees */
+        double total_time; /* [s] The whole construction, the preparation of the cells for water included */
+    };
+
+public:
+    fvoctree();
+    fvoctree(pftype surface, pftype bottom, uint number_of_threads = TREE_CONSTRUCTION_THREADS, pftype surface_accuracy = SURFACE_ACCURACY);
+    ~fvoctree();
+
+public:
+    octcell *root;
+    cellarena cells; /* The sibling blocks of all cells but the root */
+    facestore faces; /* The cell faces, shared by the two cells on either side of them */
+    nlpool neighbor_nodes; /* The nodes of the cells' neighbor lists */
+    leafstore leaves; /* Flat snapshot of the leaf cells, rebuilt after topology changes */
+#if  OCTREE_BACKEND == LINEAR_OCTREE
+    mortonindex index; /* All cells by their Morton keys */
+#endif
+
+public:
+    /* Public non-static methods */
+    void topology_changed();
+    void update_leaf_store();
+    bool is_being_destroyed() const;
+    octcell* find_cell(uint64 key) const;
+    octcell* find_smallest_cell_containing(uint64 key) const;
+    octcell* find_neighbor(const octcell* c, uint dim, bool pos_dir) const;
+    const construction_stats& get_construction_stats() const;
+    pftype size_accuracy(pfvec r) const;
+    pftype size_accuracy_below_surface(pftype depth) const;
+
+private:
+    /* Private types */
+    struct subtree_seam { /* Two cells at the subtree level to stitch together */
+        octcell* cell; /* Has the other one on its positive side */
+        octcell* neighbor;
+        uint     dim;
+    };
+    struct subtree_build {
+        std::vector<octcell*>* roots;
+        std::vector<fvoctree*> parts; /* One tree per thread that owns the cells that thread creates until the subtrees are taken over */
+        pftype                 surface;
+        pftype                 bottom;
+    };
+    struct wetted_cell { /* A leaf cell with water that needs new air cells next to it, see prepare_cells_for_water */
+        octcell* cell;
+        uint     sides; /* Bit 2*dim + pos_dir, see octcell::get_sides_without_water */
+        pfvec    mean_vel;
+
+        bool operator<(const wetted_cell& other) const {
+            return cell->key < other.cell->key;
+        }
+    };
+
+private:
+    /* Private member variables */
+    bool being_destroyed; /* Set while the cells are deleted by the destructor */
+    pftype surface_accuracy; /* [m] The maximum size of the surface cells */
+    construction_stats stats;
+
+private:
+    /* Private non-static methods */
+    bool refine_subtree(octcell* c, pftype surface, pftype bottom, std::vector<octcell*>* subtree_roots = 0);
+    void build_subtrees(threadpool& workers, std::vector<octcell*>& roots, pftype surface, pftype bottom);
+    void take_over_cells(octcell* c);
+    void prepare_cells_for_water(threadpool& workers);
+    void count_cells(const octcell* c);
+
+private:
+    /* Private static methods */
+    static void run_subtree_build_task(threadpool* workers, void* parameter, void* argument, uint part);
+    static void run_wetted_cell_task(threadpool* workers, void* parameter, void* argument, uint part);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    fvoctree(fvoctree&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC NON-STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Called by the cells whenever cells or neighbor connections are added or removed */
+inline
+void fvoctree::topology_changed()
+{
+    leaves.invalidate();
+}
+
+inline
+void fvoctree::update_leaf_store()
+{
+    if (!leaves.is_up_to_date()) {
+        leaves.rebuild(root);
+    }
+}
+
+inline
+bool fvoctree::is_being_destroyed() const
+{
+    return being_destroyed;
+}
+
+inline
+const fvoctree::construction_stats& fvoctree::get_construction_stats() const
+{
+    return stats;
+}
+
+#endif // FVOCTREE_H
@@ -0,0 +1,44 @@
+#ifndef HALOTRANSPORT_H
+#define HALOTRANSPORT_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <cstddef>
+
+// Own includes
+#include "definitions.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * The messages between the processes that share a simulation (see subdomain.h).
+ * The processes are numbered from zero up to the number of processes, and the
+ * messages from one process to another arrive in the order they were sent.
+ *
+ * The processes exchange their messages in pairs, taking their partners in the
+ * order of their ranks, and the one with the lower rank of a pair sends first
+ * while the other one receives, so a message of any size can be streamed
+ * through a transport that holds only a part of it at a time. Nothing else is
+ * asked of it, so the processes may be connected by shared memory (see
+ * shmtransport.h) as well as by sockets.
+ */
+class halotransport
+{
+public:
+    /* Constructors and destructor */
+    virtual ~halotransport() {}
+
+public:
+    /* Public methods */
+    virtual uint get_rank() const = 0;
+    virtual uint get_number_of_processes() const = 0;
+    virtual void send(uint to, const void* data, size_t size) = 0;
+    virtual void receive(uint from, void* data, size_t size) = 0;
+};
+
+#endif // HALOTRANSPORT_H
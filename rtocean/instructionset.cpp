@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "instructionset.h"
+
+namespace instructionset {
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+/* Whether both the build and the processor support the instruction set */
+bool is_supported(INSTRUCTION_SET instruction_set)
+{
+    switch (instruction_set) {
+    case IS_SCALAR:
+        return true;
+#if  HAS_VECTOR_INSTRUCTIONS
+    case IS_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    case IS_AVX512:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+INSTRUCTION_SET get_best()
+{
+    for (int instruction_set = NUM_INSTRUCTION_SETS - 1; instruction_set > IS_SCALAR; instruction_set--) {
+        if (is_supported(INSTRUCTION_SET(instruction_set))) {
+            return INSTRUCTION_SET(instruction_set);
+        }
+    }
+    return IS_SCALAR;
+}
+
+const char* get_name(INSTRUCTION_SET instruction_set)
+{
+    switch (instruction_set) {
+    case IS_SCALAR: return "scalar";
+    case IS_AVX2:   return "AVX2";
+    case IS_AVX512: return "AVX-512";
+    default:        return "unknown";
+    }
+}
+
+} // namespace instructionset
@@ -0,0 +1,56 @@
+#ifndef INSTRUCTIONSET_H
+#define INSTRUCTIONSET_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "definitions.h"
+
+////////////////////////////////////////////////////////////////
+// DEFINITIONS
+////////////////////////////////////////////////////////////////
+
+/*
+ * The vector kernels read the leaf store arrays as plain doubles, so they need
+ * double precision, floats that are stored as nothing but their value, and 64-bit
+ * pointers. They are compiled with the target attributes of GCC and Clang, which
+ * need no extra compiler flags.
+ */
+#if  USE_DOUBLE_PRECISION_FOR_PHYSICS && !(DEBUG && CHECK_INITIALIZATION_OF_FLOATS) && \
+     defined(__GNUC__) && defined(__x86_64__)
+#define  HAS_VECTOR_INSTRUCTIONS  1
+#else
+#define  HAS_VECTOR_INSTRUCTIONS  0
+#endif
+
+////////////////////////////////////////////////////////////////
+// ENUMS
+////////////////////////////////////////////////////////////////
+
+/* The instructions a solver kernel is run with (see velocitykernel.h and pressurekernel.h) */
+enum INSTRUCTION_SET {
+    IS_SCALAR,
+    IS_AVX2,   /* 4 doubles at a time */
+    IS_AVX512, /* 8 doubles at a time */
+    NUM_INSTRUCTION_SETS
+};
+
+/*
+ * Which instruction sets can be used is decided at run time from the processor,
+ * so that one build runs everywhere and still uses the widest vectors there are.
+ */
+namespace instructionset {
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////
+
+bool            is_supported(INSTRUCTION_SET instruction_set);
+INSTRUCTION_SET get_best();
+const char*     get_name(INSTRUCTION_SET instruction_set);
+
+} // namespace instructionset
+
+#endif // INSTRUCTIONSET_H
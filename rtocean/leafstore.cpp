@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "leafstore.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+leafstore::leafstore()
+{
+    up_to_date = false;
+    generation = 0;
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+void leafstore::rebuild(octcell* root)
+{
+    /* Collect the leaf cells, keeping the old ones to find the old spans */
+    std::vector<octcell*> old_cell;
+    old_cell.swap(cell);
+    if (root) {
+        add_leaf_cells_recursively(root);
+    }
+
+    /* Copy the cell properties */
+    uint num_cells = size();
+    water_vol_coeff       .resize(num_cells);
+    total_vol_coeff       .resize(num_cells);
+    p                     .resize(num_cells);
+    ccv                   .resize(num_cells);
+    s                     .resize(num_cells);
+    lvl                   .resize(num_cells);
+    momentum_to_distribute.resize(num_cells);
+    std::vector<uint> old_li(num_cells);
+    for (uint idx = 0; idx < num_cells; idx++) {
+        old_li[idx] = cell[idx]->li;
+        cell[idx]->li = idx;
+        load_cell(idx);
+    }
+
+    /* Collect the connections between the leaf cells */
+    std::vector<uint>     old_first_neighbor;
+    std::vector<uint>     old_neighbor;
+    std::vector<octface*> old_neighbor_face;
+    std::vector<uint8>    old_neighbor_pos_dir;
+    old_first_neighbor  .swap(first_neighbor);
+    old_neighbor        .swap(neighbor);
+    old_neighbor_face   .swap(neighbor_face);
+    old_neighbor_pos_dir.swap(neighbor_pos_dir);
+    first_neighbor  .resize(num_cells + 1);
+    neighbor        .reserve(old_neighbor.size());
+    neighbor_face   .reserve(old_neighbor.size());
+    neighbor_pos_dir.reserve(old_neighbor.size());
+    for (uint idx = 0; idx < num_cells; idx++) {
+        octcell* c = cell[idx];
+        first_neighbor[idx] = neighbor.size();
+        if (c->leaf_neighbors_cached) {
+            /*
+             * The lists have not changed since they were copied, and neither has any
+             * of the neighbors stopped being a leaf, since that moves the connection
+             */
+            uint li = old_li[idx];
+            for (uint i = old_first_neighbor[li]; i < old_first_neighbor[li + 1]; i++) {
+                neighbor        .push_back(old_cell[old_neighbor[i]]->li);
+                neighbor_face   .push_back(old_neighbor_face[i]);
+                neighbor_pos_dir.push_back(old_neighbor_pos_dir[i]);
+            }
+        }
+        else {
+            add_neighbors_from_lists(c);
+            c->leaf_neighbors_cached = true;
+        }
+    }
+    first_neighbor[num_cells] = neighbor.size();
+    collect_velocity_faces();
+
+    up_to_date = true;
+    generation++;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+void leafstore::add_leaf_cells_recursively(octcell* c)
+{
+    if (c->is_leaf()) {
+        cell.push_back(c);
+        return;
+    }
+    for (uint idx = 0; idx < octcell::MAX_NUM_CHILDREN; idx++) {
+        if (c->has_child(idx)) {
+            add_leaf_cells_recursively(c->get_child(idx));
+        }
+    }
+}
+
+void leafstore::add_neighbors_from_lists(octcell* c)
+{
+    nlset lists;
+    c->add_leaf_neighbor_lists_to_list_set(lists);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+#if  DEBUG
+        if (!node->v.n->is_leaf()) {
+            throw logic_error("Found a non-leaf cell in a leaf neighbor list when rebuilding the leaf store");
+        }
+#endif
+        neighbor        .push_back(node->v.n->li);
+        neighbor_face   .push_back(node->v.f);
+        neighbor_pos_dir.push_back(node->v.pos_dir);
+    }
+}
+
+void leafstore::collect_velocity_faces()
+{
+    uint num_cells = size();
+    first_velocity_face   .resize(num_cells + 1);
+    velocity_face         .clear();
+    velocity_face_cell    .clear();
+    velocity_face_neighbor.clear();
+    velocity_face_dist    .clear();
+    velocity_face_g       .clear();
+    for (uint idx = 0; idx < num_cells; idx++) {
+        first_velocity_face[idx] = velocity_face.size();
+        for (uint i = first_neighbor[idx]; i < first_neighbor[idx + 1]; i++) {
+            if (octface::owns_velocity(neighbor_pos_dir[i])) {
+                octface* f = neighbor_face[i];
+                velocity_face         .push_back(f);
+                velocity_face_cell    .push_back(idx);
+                velocity_face_neighbor.push_back(neighbor[i]);
+                velocity_face_dist    .push_back(f->dist);
+                velocity_face_g       .push_back(f->g);
+            }
+        }
+    }
+    first_velocity_face[num_cells] = velocity_face.size();
+}
+
+void leafstore::load_cell(uint idx)
+{
+    octcell* c = cell[idx];
+    water_vol_coeff       [idx] = c->water_vol_coeff;
+    total_vol_coeff       [idx] = c->total_vol_coeff;
+    p                     [idx] = c->p;
+    ccv                   [idx] = c->ccv;
+    s                     [idx] = c->get_edge_length();
+    lvl                   [idx] = c->lvl;
+    momentum_to_distribute[idx] = c->momentum_to_distribute;
+}
@@ -0,0 +1,225 @@
+#ifndef LEAFSTORE_H
+#define LEAFSTORE_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "octcell.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * A flat structure-of-arrays snapshot of the leaf cells of a tree, so that the
+ * solver passes can run as linear loops instead of walking the pointer tree.
+ *
+ * The leaf cells are stored in depth-first order, which with the child indexing
+ * used by octcell is the Morton (Z) order. The store is only rebuilt when the
+ * topology of the tree has changed. In between, the cells are still the owners
+ * of their properties; every write goes to the cell and is then copied into the
+ * arrays, so reading from either is always safe.
+ *
+ * The connections between the leaf cells are stored in compressed sparse row
+ * form: the neighbors of leaf cell idx are the entries first_neighbor[idx] up to
+ * first_neighbor[idx + 1] of the neighbor arrays, in the same order as the leaf
+ * neighbor lists of the cell are traversed by an nlset.
+ *
+ * The span of neighbors of a cell stays valid until its own leaf neighbor lists
+ * are changed, which is tracked per cell (octcell::leaf_neighbors_cached) rather
+ * than per tree. A rebuild copies the spans that are still valid instead of
+ * traversing the lists again, and a pass that has changed the topology may still
+ * use the spans of the cells that were not touched.
+ *
+ * The faces that the cells own the velocity of (see octface::owns_velocity) are
+ * also listed on their own, in leaf order, so that the velocity update can run as
+ * one loop over the faces (see velocitykernel.h). The velocity faces of leaf cell
+ * idx are the entries first_velocity_face[idx] up to first_velocity_face[idx + 1].
+ */
+class leafstore
+{
+public:
+    leafstore();
+
+public:
+    /***************************
+     * Public member variables *
+     ***************************/
+
+    /* Cells */
+    std::vector<octcell*> cell; /* The leaf cells */
+
+    /* Cell properties, see octcell */
+    std::vector<pftype> water_vol_coeff;
+    std::vector<pftype> total_vol_coeff;
+    std::vector<pftype> p;
+    std::vector<pfvec>  ccv;
+    std::vector<pftype> s;
+    std::vector<uint8>  lvl; /* The level of each cell, which gives the rest of its geometry, see levelgeometry.h */
+    std::vector<pfvec>  momentum_to_distribute;
+
+    /* Adjacency */
+    std::vector<uint>     first_neighbor; /* Index of the first neighbor entry of each cell, plus the total number of entries last */
+    std::vector<uint>     neighbor; /* Leaf store index of the neighbor cell */
+    std::vector<octface*> neighbor_face; /* The face shared with the neighbor cell */
+    std::vector<uint8>    neighbor_pos_dir; /* Whether the neighbor cell is in the positive direction */
+
+    /* Velocity faces */
+    std::vector<uint>     first_velocity_face; /* Index of the first velocity face of each cell, plus the total number of velocity faces last */
+    std::vector<octface*> velocity_face;
+    std::vector<uint>     velocity_face_cell; /* Leaf store index of the cell on the negative side, which owns the velocity */
+    std::vector<uint>     velocity_face_neighbor; /* Leaf store index of the cell on the positive side */
+    std::vector<pftype>   velocity_face_dist; /* Copies of the geometric coefficients of the faces, which never change */
+    std::vector<pftype>   velocity_face_g;
+
+public:
+    /* Public methods */
+    bool   is_up_to_date() const;
+    uint   get_generation() const;
+    bool   has_valid_neighbor_span(uint idx) const;
+    bool   contains(const octcell* c) const;
+    void   invalidate();
+    void   rebuild(octcell* root);
+    uint   size() const;
+    pftype get_density(uint idx) const;
+    pftype get_alpha(uint idx) const;
+    pftype get_half_edge_length(uint idx) const;
+    pftype get_cube_volume(uint idx) const;
+    pftype get_inverse_cube_volume(uint idx) const;
+    void   set_volume_coefficients(uint idx, pftype water_volume_coefficient, pftype total_volume_coefficient);
+    void   copy_pressure_to_cell(uint idx);
+    void   set_cell_center_velocity(uint idx, pfvec cell_center_velocity);
+    void   set_momentum_to_distribute(uint idx, pfvec momentum);
+
+private:
+    /* Private member variables */
+    bool up_to_date; /* Whether the arrays reflect the current topology of the tree */
+    uint generation; /* Increased by every rebuild, so that what is derived from the arrays can tell when it is out of date */
+
+private:
+    /* Private methods */
+    void add_leaf_cells_recursively(octcell* c);
+    void add_neighbors_from_lists(octcell* c);
+    void collect_velocity_faces();
+    void load_cell(uint idx);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    leafstore(leafstore&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+bool leafstore::is_up_to_date() const
+{
+    return up_to_date;
+}
+
+inline
+uint leafstore::get_generation() const
+{
+    return generation;
+}
+
+/* Whether the cell is in the store, i.e. was a leaf cell when the store was last rebuilt */
+inline
+bool leafstore::contains(const octcell* c) const
+{
+    return c->li < cell.size() && cell[c->li] == c;
+}
+
+/* Whether the neighbor entries of cell idx are still valid, also when the store is out of date */
+inline
+bool leafstore::has_valid_neighbor_span(uint idx) const
+{
+    return up_to_date || cell[idx]->leaf_neighbors_cached;
+}
+
+inline
+void leafstore::invalidate()
+{
+    up_to_date = false;
+}
+
+inline
+uint leafstore::size() const
+{
+    return cell.size();
+}
+
+inline
+pftype leafstore::get_density(uint idx) const
+{
+    return physics::vol_coeffs_to_density(water_vol_coeff[idx], total_vol_coeff[idx]);
+}
+
+inline
+pftype leafstore::get_alpha(uint idx) const
+{
+    return water_vol_coeff[idx]/total_vol_coeff[idx];
+}
+
+inline
+pftype leafstore::get_half_edge_length(uint idx) const
+{
+    return levelgeometry::half_edge_length(lvl[idx]);
+}
+
+inline
+pftype leafstore::get_cube_volume(uint idx) const
+{
+    return levelgeometry::cube_volume(lvl[idx]);
+}
+
+inline
+pftype leafstore::get_inverse_cube_volume(uint idx) const
+{
+    return levelgeometry::inverse_cube_volume(lvl[idx]);
+}
+
+/* With a local equation of state the pressure is left to the pressure kernel, see pressurekernel.h */
+inline
+void leafstore::set_volume_coefficients(uint idx, pftype water_volume_coefficient, pftype total_volume_coefficient)
+{
+    octcell* c = cell[idx];
+#if  LOCAL_EQUATION_OF_STATE
+    c->set_volume_coefficients(water_volume_coefficient, total_volume_coefficient, false);
+#else
+    /* The pressure is updated by the cell as well */
+    c->set_volume_coefficients(water_volume_coefficient, total_volume_coefficient);
+    p              [idx] = c->p;
+#endif
+    water_vol_coeff[idx] = c->water_vol_coeff;
+    total_vol_coeff[idx] = c->total_vol_coeff;
+}
+
+/* The pressure kernel writes to the array, so this is the one property that is copied the other way */
+inline
+void leafstore::copy_pressure_to_cell(uint idx)
+{
+    cell[idx]->p = p[idx];
+}
+
+inline
+void leafstore::set_cell_center_velocity(uint idx, pfvec cell_center_velocity)
+{
+    cell[idx]->ccv = ccv[idx] = cell_center_velocity;
+}
+
+inline
+void leafstore::set_momentum_to_distribute(uint idx, pfvec momentum)
+{
+    cell[idx]->momentum_to_distribute = momentum_to_distribute[idx] = momentum;
+}
+
+#endif // LEAFSTORE_H
@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+/* Own includes */
+#include "levelgeometry.h"
+#include "math_functions.h"
+
+namespace levelgeometry {
+
+////////////////////////////////////////////////////////////////
+// TABLES
+////////////////////////////////////////////////////////////////
+
+pftype edge_lengths        [MAX_NUM_LEVELS];
+pftype half_edge_lengths   [MAX_NUM_LEVELS];
+pftype side_areas          [MAX_NUM_LEVELS];
+pftype cube_volumes        [MAX_NUM_LEVELS];
+pftype inverse_edge_lengths[MAX_NUM_LEVELS];
+pftype inverse_side_areas  [MAX_NUM_LEVELS];
+pftype inverse_cube_volumes[MAX_NUM_LEVELS];
+
+////////////////////////////////////////////////////////////////
+// INITIALIZATION
+////////////////////////////////////////////////////////////////
+
+namespace {
+
+/* Fills in the tables before main is entered (the tables are defined above, so they are constructed first) */
+struct table_initializer
+{
+    table_initializer()
+    {
+        pftype s = 1;
+        for (uint lvl = 0; lvl < MAX_NUM_LEVELS; lvl++) {
+            edge_lengths        [lvl] = s;
+            half_edge_lengths   [lvl] = 0.5 * s;
+            side_areas          [lvl] = inline_int_pow(s, NUM_DIMENSIONS-1);
+            cube_volumes        [lvl] = inline_int_pow(s, NUM_DIMENSIONS);
+            inverse_edge_lengths[lvl] = 1/edge_lengths[lvl];
+            inverse_side_areas  [lvl] = 1/side_areas  [lvl];
+            inverse_cube_volumes[lvl] = 1/cube_volumes[lvl];
+            s = 0.5 * s;
+        }
+    }
+} initializer;
+
+} // namespace
+
+} // namespace levelgeometry
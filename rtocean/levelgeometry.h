@@ -0,0 +1,108 @@
+#ifndef  LEVELGEOMETRY_H
+#define  LEVELGEOMETRY_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::out_of_range;
+
+/* Own include files */
+#include "definitions.h"
+
+/*
+ * The geometry of the cells on each level of detail. The root cell has unit size,
+ * so the size of a cell only depends on its level, and since all the sizes are
+ * powers of two the tabulated values (also the reciprocals) are exact.
+ */
+namespace levelgeometry {
+
+////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////
+
+/* The levels that can be told apart by a Morton key, see morton.h */
+const uint MAX_NUM_LEVELS = (64 - 1)/NUM_DIMENSIONS + 1;
+
+////////////////////////////////////////////////////////////////
+// TABLES
+////////////////////////////////////////////////////////////////
+
+extern pftype edge_lengths        [MAX_NUM_LEVELS]; /* [m] */
+extern pftype half_edge_lengths   [MAX_NUM_LEVELS]; /* [m] */
+extern pftype side_areas          [MAX_NUM_LEVELS]; /* [m^2] Cube side area (length in 2D) */
+extern pftype cube_volumes        [MAX_NUM_LEVELS]; /* [m^3] Cube volume (area in 2D) */
+extern pftype inverse_edge_lengths[MAX_NUM_LEVELS]; /* [1/m] */
+extern pftype inverse_side_areas  [MAX_NUM_LEVELS]; /* [1/m^2] */
+extern pftype inverse_cube_volumes[MAX_NUM_LEVELS]; /* [1/m^3] */
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////
+
+inline
+void check_level(uint lvl)
+{
+#if  DEBUG
+    if (lvl >= MAX_NUM_LEVELS) {
+        throw out_of_range("Trying to get the geometry of a level that is too deep");
+    }
+#else
+    lvl = lvl;
+#endif
+}
+
+inline
+pftype edge_length(uint lvl)
+{
+    check_level(lvl);
+    return edge_lengths[lvl];
+}
+
+inline
+pftype half_edge_length(uint lvl)
+{
+    check_level(lvl);
+    return half_edge_lengths[lvl];
+}
+
+inline
+pftype side_area(uint lvl)
+{
+    check_level(lvl);
+    return side_areas[lvl];
+}
+
+inline
+pftype cube_volume(uint lvl)
+{
+    check_level(lvl);
+    return cube_volumes[lvl];
+}
+
+inline
+pftype inverse_edge_length(uint lvl)
+{
+    check_level(lvl);
+    return inverse_edge_lengths[lvl];
+}
+
+inline
+pftype inverse_side_area(uint lvl)
+{
+    check_level(lvl);
+    return inverse_side_areas[lvl];
+}
+
+inline
+pftype inverse_cube_volume(uint lvl)
+{
+    check_level(lvl);
+    return inverse_cube_volumes[lvl];
+}
+
+} // namespace levelgeometry
+
+#endif  /* LEVELGEOMETRY_H */
@@ -1,79 +1,479 @@
-
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-// Standard includes
-#include <iostream>
-using std::cout;
-using std::endl;
-
-// OpenGL
-//#include <GL/glut.h>
-
-// Qt
-#include <QtGui/QApplication>
-
-// Widgets
-#include "mainwin.h"
-
-// Own includes
-#include "message_handler.h"
-
-////////////////////////////////////////////////////////////////
-// MAIN FUNCTION
-////////////////////////////////////////////////////////////////
-
-int main(int argc, char *argv[])
-{
-    try
-    {
-        /* Init glut */
-        //glutInit(&argc, argv);
-
-        // Init application
-        QApplication app(argc, argv);
-        mainwin win;
-        win.showMaximized();
-        win.show();
-
-#if  0
-        {
-            dllist<int> l;
-            dllnode<int>* e1 = l.add_existing_element(1);
-            dllnode<int>* e2 = l.add_new_element();
-            e2->v = 2;
-            dllnode<int>* e3 = l.add_existing_element(3);
-            l.add_existing_element(4);
-            l.add_existing_element(5);
-            dllnode<int>* e6 = l.add_existing_element(6);
-            e6->remove_from_list_and_delete();
-            l.add_existing_element(7);
-            dllnode<int>* e8 = l.add_existing_element(8);
-            dllnode<int>* e9 = l.add_existing_element(9);
-            dllnode<int>* e10 = l.add_existing_element(10);
-
-            e2->remove_from_list_and_delete();
-            e1->remove_from_list_and_delete();
-            e3->remove_from_list_and_delete();
-            e9->remove_from_list_and_delete();
-            e10->remove_from_list_and_delete();
-            e8->remove_from_list_and_delete();
-
-            for (dllnode<int>* e = l.get_first_element(); e; e = e->get_next_node()) {
-                cout << e->v << endl;
-            }
-        }
-        return 0;
-#endif
-
-        // "Start" application
-        return app.exec();
-    }
-    catch (std::exception &e) {
-        message_handler::inform_about_exception("main()", e, true);
-    }
-
-    // Will never reach this line
-    return 1;
-}
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <iostream>
+using std::cout;
+using std::endl;
+
+// OpenGL
+//#include <GL/glut.h>
+
+// Qt
+#include <QtGui/QApplication>
+
+// Widgets
+#include "mainwin.h"
+
+// Own includes
+#include "message_handler.h"
+#if  BENCHMARK_OCTREE_BACKEND
+#include "fvoctree.h"
+#endif
+#if  BENCHMARK_SOLVER_PASSES || BENCHMARK_SOLVER_KERNELS || BENCHMARK_WEAK_SCALING || BENCHMARK_REGRIDDING || BENCHMARK_LOCAL_TIME_STEPPING || BENCHMARK_PRESSURE_SOLVER
+#include "watersystem.h"
+#endif
+#if  BENCHMARK_ENSEMBLE
+#include "ensemble.h"
+#endif
+#if  BENCHMARK_WEAK_SCALING
+#include <algorithm>
+#include <cmath>
+#include "shmtransport.h"
+#endif
+#if  BENCHMARK_PRESSURE_SOLVER
+#include <cmath>
+#endif
+
+#if  BENCHMARK_SOLVER_PASSES || BENCHMARK_SOLVER_KERNELS || BENCHMARK_WEAK_SCALING || BENCHMARK_REGRIDDING || BENCHMARK_LOCAL_TIME_STEPPING || BENCHMARK_PRESSURE_SOLVER
+////////////////////////////////////////////////////////////////
+// BENCHMARK FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+struct benchmark_run {
+    watersystem* system;
+    uint         num_time_steps_left;
+};
+
+/*
+ * Stops the benchmarked simulation after a number of time steps. It is paused rather than
+ * aborted, since an aborted simulation still takes the time step that follows the callback.
+ */
+static void count_time_step(void* benchmark_run_object)
+{
+    benchmark_run* run = static_cast<benchmark_run*>(benchmark_run_object);
+    if (!--run->num_time_steps_left) {
+        run->system->pause_simulation();
+    }
+}
+#endif
+#if  BENCHMARK_PRESSURE_SOLVER
+
+struct benchmark_timed_run {
+    watersystem* system;
+    double       simulated_time;
+};
+
+/* Stops the benchmarked simulation once it has reached a simulated time, see count_time_step */
+static void check_simulated_time(void* benchmark_run_object)
+{
+    benchmark_timed_run* run = static_cast<benchmark_timed_run*>(benchmark_run_object);
+    if (run->system->get_time() >= run->simulated_time) {
+        run->system->pause_simulation();
+    }
+}
+#endif
+
+////////////////////////////////////////////////////////////////
+// MAIN FUNCTION
+////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+#if  BENCHMARK_OCTREE_BACKEND
+        {
+            const uint NUM_REPETITIONS = 100;
+            fvoctree tree(0, 0);
+            const fvoctree::construction_stats& stats = tree.get_construction_stats();
+            clock_t built = clock();
+            tree.update_leaf_store();
+            uint num_lookups = 0;
+            uint num_found = 0;
+            for (uint rep = 0; rep < NUM_REPETITIONS; rep++) {
+                for (uint idx = 0; idx < tree.leaves.size(); idx++) {
+                    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+                        for (uint pos_dir = 0; pos_dir < 2; pos_dir++) {
+                            num_lookups++;
+                            if (tree.find_neighbor(tree.leaves.cell[idx], dim, pos_dir)) {
+                                num_found++;
+                            }
+                        }
+                    }
+                }
+            }
+            clock_t searched = clock();
+            cout << "Octree backend:     " << (OCTREE_BACKEND == LINEAR_OCTREE ? "linear" : "pointer") << endl;
+            cout << "Cells:              " << stats.num_cells << " (" << stats.num_leaf_cells << " leaf cells)" << endl;
+            cout << "Subtrees:           " << stats.num_subtrees << " on " << stats.num_threads << " threads" << endl;
+            cout << "Build time:         " << stats.total_time << " s (subtrees " << stats.subtree_time << " s, stitching " << stats.stitch_time << " s)" << endl;
+            cout << "Neighbor lookups:   " << num_lookups << " (" << num_found << " found)" << endl;
+            cout << "Lookup time:        " << double(searched - built)/CLOCKS_PER_SEC << " s" << endl;
+        }
+        return 0;
+#endif
+
+#if  BENCHMARK_SOLVER_PASSES
+        {
+            /* The runs are interleaved and the fastest one of each kind is kept, to even out the noise */
+            const uint NUM_TIME_STEPS = 1000;
+            const uint NUM_REPETITIONS = 5;
+            double best_times[2] = {0, 0};
+            uint num_leaf_cells = 0;
+            uint num_threads = 0;
+            for (uint rep = 0; rep < NUM_REPETITIONS; rep++) {
+                for (uint fused = 0; fused < 2; fused++) {
+                    fvoctree* tree = new fvoctree(0, 0);
+                    watersystem system;
+                    system.set_passes_fused(fused);
+                    system.define_water(tree);
+                    benchmark_run run = {&system, NUM_TIME_STEPS};
+                    system.set_state_updated_callback(count_time_step, &run);
+                    clock_t start = clock();
+                    system.run_simulation(SIMULATION_TIME_STEP);
+                    double time = double(clock() - start)/CLOCKS_PER_SEC;
+                    if (!rep || time < best_times[fused]) {
+                        best_times[fused] = time;
+                    }
+                    num_leaf_cells = tree->leaves.size();
+                    num_threads = system.get_number_of_threads();
+                    delete tree;
+                }
+            }
+            cout << "Solver threads:     " << num_threads << endl;
+            cout << "Leaf cells:         " << num_leaf_cells << " (at the end)" << endl;
+            cout << "Separate passes:    " << best_times[0] << " s for " << NUM_TIME_STEPS << " time steps" << endl;
+            cout << "Fused passes:       " << best_times[1] << " s for " << NUM_TIME_STEPS << " time steps" << endl;
+        }
+        return 0;
+#endif
+
+#if  BENCHMARK_SOLVER_KERNELS
+        {
+            /* Some time steps are run first, so that there is something going on in the fields */
+            const uint NUM_WARM_UP_TIME_STEPS = 100;
+            const uint NUM_REPETITIONS = 1000;
+            fvoctree* tree = new fvoctree(0, 0);
+            watersystem system;
+            system.define_water(tree);
+            benchmark_run run = {&system, NUM_WARM_UP_TIME_STEPS};
+            system.set_state_updated_callback(count_time_step, &run);
+            system.run_simulation(SIMULATION_TIME_STEP);
+            tree->update_leaf_store();
+            leafstore& lf = tree->leaves;
+            uint num_faces = lf.velocity_face.size();
+            pftype dt = system.get_time_step();
+            std::vector<pftype> start_velocities(num_faces);
+            std::vector<pftype> scalar_velocities(num_faces);
+            for (uint f = 0; f < num_faces; f++) {
+                start_velocities[f] = lf.velocity_face[f]->vel;
+            }
+            cout << "Velocity faces:     " << num_faces << endl;
+            for (int i = 0; i < NUM_INSTRUCTION_SETS; i++) {
+                INSTRUCTION_SET instruction_set = INSTRUCTION_SET(i);
+                cout << instructionset::get_name(instruction_set) << ": ";
+                if (!instructionset::is_supported(instruction_set)) {
+                    cout << "not supported" << endl;
+                    continue;
+                }
+                clock_t start = clock();
+                for (uint rep = 0; rep < NUM_REPETITIONS; rep++) {
+                    velocitykernel::update_velocities(instruction_set, lf, 0, num_faces, dt);
+                }
+                double time = double(clock() - start)/CLOCKS_PER_SEC;
+                /* Compare one update from the same velocities with the scalar one */
+                bool same_as_scalar = true;
+                for (uint f = 0; f < num_faces; f++) {
+                    lf.velocity_face[f]->vel = start_velocities[f];
+                }
+                velocitykernel::update_velocities(instruction_set, lf, 0, num_faces, dt);
+                for (uint f = 0; f < num_faces; f++) {
+                    if (instruction_set == IS_SCALAR) {
+                        scalar_velocities[f] = lf.velocity_face[f]->vel;
+                    }
+                    else if (lf.velocity_face[f]->vel != scalar_velocities[f]) {
+                        same_as_scalar = false;
+                    }
+                }
+                cout << 1e9*time/(double(NUM_REPETITIONS)*num_faces) << " ns per face" << (same_as_scalar ? "" : ", differs from scalar") << endl;
+            }
+            /* The pressures, compared with calculating them cell by cell */
+            uint num_cells = lf.size();
+            cout << "Leaf cells:         " << num_cells << endl;
+            clock_t start = clock();
+            for (uint rep = 0; rep < NUM_REPETITIONS; rep++) {
+                for (uint idx = 0; idx < num_cells; idx++) {
+                    lf.cell[idx]->calculate_pressure();
+                }
+            }
+            double cell_by_cell_time = double(clock() - start)/CLOCKS_PER_SEC;
+            cout << "cell by cell: " << 1e9*cell_by_cell_time/(double(NUM_REPETITIONS)*num_cells) << " ns per cell" << endl;
+            for (int i = 0; i < NUM_INSTRUCTION_SETS; i++) {
+                INSTRUCTION_SET instruction_set = INSTRUCTION_SET(i);
+                cout << instructionset::get_name(instruction_set) << ": ";
+                if (!instructionset::is_supported(instruction_set)) {
+                    cout << "not supported" << endl;
+                    continue;
+                }
+                start = clock();
+                for (uint rep = 0; rep < NUM_REPETITIONS; rep++) {
+                    pressurekernel::calculate_pressures(instruction_set, lf, 0, num_cells);
+                }
+                double time = double(clock() - start)/CLOCKS_PER_SEC;
+                bool same_as_cell_by_cell = true;
+                for (uint idx = 0; idx < num_cells; idx++) {
+                    if (lf.p[idx] != lf.cell[idx]->p) {
+                        same_as_cell_by_cell = false;
+                    }
+                }
+                cout << 1e9*time/(double(NUM_REPETITIONS)*num_cells) << " ns per cell" << (same_as_cell_by_cell ? "" : ", differs from cell by cell") << endl;
+            }
+            delete tree;
+        }
+        return 0;
+#endif
+
+#if  BENCHMARK_WEAK_SCALING
+        {
+            /*
+             * The domain is the same for all runs, so the work per process is kept the same by making
+             * the surface cells smaller: the number of cells grows with the area of the surface. Each
+             * process runs one solver thread, and the slowest one decides the time.
+             */
+            const uint NUM_TIME_STEPS = 200;
+            const uint MAX_NUM_PROCESSES = 8;
+            double time_one_process = 0;
+            for (uint num_processes = 1; num_processes <= MAX_NUM_PROCESSES; num_processes *= 2) {
+                fvoctree* tree = new fvoctree(0, 0, TREE_CONSTRUCTION_THREADS, pftype(SURFACE_ACCURACY / std::sqrt(double(num_processes))));
+                shmtransport transport(num_processes);
+                transport.start_processes();
+                subdomain domain(&transport);
+                watersystem system;
+                system.set_number_of_threads(1);
+                system.define_water(tree);
+                system.set_subdomain(&domain);
+                uint num_leaf_cells = tree->leaves.size();
+                uint num_own_cells = domain.get_end_cell() - domain.get_first_cell();
+                benchmark_run run = {&system, NUM_TIME_STEPS};
+                system.set_state_updated_callback(count_time_step, &run);
+                clock_t start = clock();
+                system.run_simulation(SIMULATION_TIME_STEP);
+                double time = domain.get_global_max(double(clock() - start)/CLOCKS_PER_SEC);
+                std::vector<uint> own_cells(1, num_own_cells);
+                domain.all_gather(own_cells);
+                if (!domain.get_rank()) {
+                    if (num_processes == 1) {
+                        time_one_process = time;
+                    }
+                    uint max_own_cells = *std::max_element(own_cells.begin(), own_cells.end());
+                    cout << "Processes:          " << num_processes << endl;
+                    cout << "Leaf cells:         " << num_leaf_cells << " (at most " << max_own_cells << " in one process, at the start)" << endl;
+                    cout << "Time:               " << time << " s for " << NUM_TIME_STEPS << " time steps" << endl;
+                    cout << "Cell updates:       " << double(num_leaf_cells)*NUM_TIME_STEPS/(time*num_processes) << " per second and process" << endl;
+                    cout << "Efficiency:         " << 100*time_one_process/time << " %" << endl;
+                }
+                transport.stop_processes();
+                delete tree;
+            }
+        }
+        return 0;
+#endif
+
+#if  BENCHMARK_ENSEMBLE
+        {
+            /* The same members are run on one thread first, and then continued on all of them */
+            const uint NUM_TIME_STEPS = 200;
+            const uint NUM_ACCURACIES = 4;
+            ensemble members(1);
+            for (uint i = 0; i < NUM_ACCURACIES; i++) {
+                for (uint fused = 0; fused < 2; fused++) {
+                    uint member = members.add_member(new fvoctree(0, 0, TREE_CONSTRUCTION_THREADS, SURFACE_ACCURACY * (1 + pftype(i)/NUM_ACCURACIES)));
+                    members.get_member(member).set_passes_fused(fused);
+                }
+            }
+            members.run(NUM_TIME_STEPS);
+            double one_thread = members.get_time_steps_per_second();
+            members.set_number_of_threads(NUM_ENSEMBLE_THREADS);
+            members.run(NUM_TIME_STEPS);
+            for (uint member = 0; member < members.get_number_of_members(); member++) {
+                const ensemble::member_result& result = members.get_result(member);
+                cout << "Member " << member << ":           " << result.num_leaf_cells << " leaf cells, "
+                     << (members.get_member(member).are_passes_fused() ? "fused" : "separate") << " passes, "
+                     << result.num_time_steps << " time steps in " << result.run_time << " s, "
+                     << "time " << result.simulated_time << " s, water volume " << result.water_volume << endl;
+            }
+            cout << "Members:            " << members.get_number_of_members() << endl;
+            cout << "Threads:            " << members.get_number_of_threads() << endl;
+            cout << "One thread:         " << one_thread << " time steps per second" << endl;
+            cout << "All threads:        " << members.get_time_steps_per_second() << " time steps per second" << endl;
+        }
+        return 0;
+#endif
+
+#if  BENCHMARK_REGRIDDING
+        {
+            /* The runs are stopped after every segment to count the cells, and then continued */
+            const uint NUM_TIME_STEPS = 500;
+            const uint NUM_SEGMENTS = 6;
+            const uint INTERVAL = REGRID_INTERVAL ? REGRID_INTERVAL : 10;
+            for (uint regridded = 0; regridded < 2; regridded++) {
+                fvoctree* tree = new fvoctree(0, 0);
+                watersystem system;
+                system.set_regrid_interval(regridded ? INTERVAL : 0);
+                system.define_water(tree);
+                benchmark_run run = {&system, 0};
+                system.set_state_updated_callback(count_time_step, &run);
+                double time = 0;
+                for (uint segment = 0; segment < NUM_SEGMENTS; segment++) {
+                    run.num_time_steps_left = NUM_TIME_STEPS;
+                    double start = threadpool::get_seconds();
+                    system.run_simulation(SIMULATION_TIME_STEP);
+                    time += threadpool::get_seconds() - start;
+                    tree->update_leaf_store();
+                    cout << (regridded ? "Regridded:     " : "Not regridded: ") << "time " << system.get_time() << " s, "
+                         << tree->leaves.size() << " leaf cells";
+                    if (regridded) {
+                        cout << ", " << system.get_regrid_stats().num_surface_cells << " surface cells";
+                    }
+                    cout << endl;
+                }
+                double water_volume = 0;
+                for (uint idx = 0; idx < tree->leaves.size(); idx++) {
+                    water_volume += tree->leaves.water_vol_coeff[idx] * tree->leaves.get_cube_volume(idx);
+                }
+                const watersystem::regrid_stats& stats = system.get_regrid_stats();
+                cout << (regridded ? "Regridded:     " : "Not regridded: ") << system.get_number_of_cell_updates() << " cell updates in " << time << " s, "
+                     << stats.num_regriddings << " regriddings in " << stats.time << " s, "
+                     << stats.num_refined_cells << " cells refined, " << stats.num_coarsened_cells << " cells coarsened, "
+                     << "water volume " << water_volume << endl;
+                delete tree;
+            }
+        }
+        return 0;
+#endif
+
+#if  BENCHMARK_LOCAL_TIME_STEPPING
+        {
+            /* Every call of the solver takes 2^levels time steps of the finest cells, so the runs take fewer calls for more levels */
+            const uint NUM_TIME_STEPS = 800;
+            const uint MAX_LEVELS = 3;
+            for (uint levels = 0; levels <= MAX_LEVELS; levels++) {
+                fvoctree* tree = new fvoctree(0, 0);
+                watersystem system;
+                system.set_time_step_levels(levels);
+                system.define_water(tree);
+                benchmark_run run = {&system, NUM_TIME_STEPS >> levels};
+                system.set_state_updated_callback(count_time_step, &run);
+                double start = threadpool::get_seconds();
+                system.run_simulation(SIMULATION_TIME_STEP);
+                double time = threadpool::get_seconds() - start;
+                tree->update_leaf_store();
+                double water_volume = 0;
+                for (uint idx = 0; idx < tree->leaves.size(); idx++) {
+                    water_volume += tree->leaves.water_vol_coeff[idx] * tree->leaves.get_cube_volume(idx);
+                }
+                double simulated_time = system.get_time();
+                cout << "Time step levels " << levels << ": " << system.get_number_of_cell_updates() << " cell updates in " << time << " s, "
+                     << "time " << simulated_time << " s, "
+                     << system.get_number_of_cell_updates() / simulated_time << " cell updates per simulated second, "
+                     << "water volume " << water_volume << endl;
+                delete tree;
+            }
+        }
+        return 0;
+#endif
+
+#if  BENCHMARK_PRESSURE_SOLVER
+        {
+            /* The time steps the pressure projection can take are much longer, but every one of them solves for the pressures */
+            const double SIMULATED_TIME = .3; // [s]
+            fvoctree* tree = new fvoctree(0, 0);
+            watersystem system;
+            system.define_water(tree);
+            benchmark_timed_run run = {&system, SIMULATED_TIME};
+            system.set_state_updated_callback(check_simulated_time, &run);
+            double start = threadpool::get_seconds();
+            system.run_simulation(SIMULATION_TIME_STEP);
+            double time = threadpool::get_seconds() - start;
+            tree->update_leaf_store();
+            double water_volume = 0;
+            for (uint idx = 0; idx < tree->leaves.size(); idx++) {
+                water_volume += tree->leaves.water_vol_coeff[idx] * tree->leaves.get_cube_volume(idx);
+            }
+            double simulated_time = system.get_time();
+            cout << (USE_ARTIFICIAL_COMPRESSIBILITY ? "Artificial compressibility: " : "Pressure projection: ")
+                 << "time " << simulated_time << " s in " << time << " s, "
+                 << simulated_time / time << " simulated seconds per second, "
+                 << system.get_number_of_cell_updates() << " cell updates, "
+                 << "water volume " << water_volume << endl;
+#if  !USE_ARTIFICIAL_COMPRESSIBILITY
+            const pressuresolver::solve_stats& stats = system.get_pressure_solver_stats();
+            cout << "Pressure solver: " << stats.num_solves << " solves, " << stats.num_iterations << " iterations in " << stats.time << " s, "
+                 << stats.num_unconverged_solves << " not converged, "
+                 << "mean convergence rate " << (stats.num_iterations ? exp(stats.log_rate_sum / stats.num_iterations) : 0) << " per iteration";
+#if  PRESSURE_SOLVER_MULTIGRID_CYCLE
+            cout << " with " << (PRESSURE_SOLVER_MULTIGRID_CYCLE == 1 ? "V" : "W") << "-cycles over " << stats.num_levels << " levels";
+#endif
+            cout << endl << "Convergence rates of the last solve:";
+            for (uint i = 0; i < stats.last_rates.size(); i++) {
+                cout << " " << stats.last_rates[i];
+            }
+            cout << endl;
+#endif
+            delete tree;
+        }
+        return 0;
+#endif
+
+        /* Init glut */
+        //glutInit(&argc, argv);
+
+        // Init application
+        QApplication app(argc, argv);
+        mainwin win;
+        win.showMaximized();
+        win.show();
+
+#if  0
+        {
+            dllist<int> l;
+            dllnode<int>* e1 = l.add_existing_element(1);
+            dllnode<int>* e2 = l.add_new_element();
+            e2->v = 2;
+            dllnode<int>* e3 = l.add_existing_element(3);
+            l.add_existing_element(4);
+            l.add_existing_element(5);
+            dllnode<int>* e6 = l.add_existing_element(6);
+            e6->remove_from_list_and_delete();
+            l.add_existing_element(7);
+            dllnode<int>* e8 = l.add_existing_element(8);
+            dllnode<int>* e9 = l.add_existing_element(9);
+            dllnode<int>* e10 = l.add_existing_element(10);
+
+            e2->remove_from_list_and_delete();
+            e1->remove_from_list_and_delete();
+            e3->remove_from_list_and_delete();
+            e9->remove_from_list_and_delete();
+            e10->remove_from_list_and_delete();
+            e8->remove_from_list_and_delete();
+
+            for (dllnode<int>* e = l.get_first_element(); e; e = e->get_next_node()) {
+                cout << e->v << endl;
+            }
+        }
+        return 0;
+#endif
+
+        // "Start" application
+        return app.exec();
+    }
+    catch (std::exception &e) {
+        message_handler::inform_about_exception("main()", e, true);
+    }
+
+    // Will never reach this line
+    return 1;
+}
@@ -0,0 +1,99 @@
+#ifndef  MORTON_H
+#define  MORTON_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+/* Own include files */
+#include "definitions.h"
+
+/*
+ * Morton keys (locational codes) of the cells in the tree. The key of the root
+ * is 1 and the key of a child is the key of its parent followed by the
+ * NUM_DIMENSIONS bits of the child index, so that bit dim of each group is the
+ * position in dimension dim. The leading 1 tells the level of the cell. Sorting
+ * the leaf cells by their left-aligned keys gives the Z order used by the
+ * depth-first traversals.
+ */
+namespace morton {
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////
+
+const uint64 ROOT_KEY = 1;
+
+inline
+uint64 child_key(uint64 key, uint child_idx)
+{
+    return (key << NUM_DIMENSIONS) | child_idx;
+}
+
+inline
+uint64 parent_key(uint64 key)
+{
+    return key >> NUM_DIMENSIONS;
+}
+
+/*
+ * The key of the cell at target_level that contains the cell with the given key and
+ * level, or if the cell is above target_level, of its first descendant there. The
+ * keys of the leaf cells taken to one level are ordered as the leaf cells themselves.
+ */
+inline
+uint64 key_at_level(uint64 key, uint level, uint target_level)
+{
+    if (level >= target_level) {
+        return key >> (NUM_DIMENSIONS * (level - target_level));
+    }
+    return key << (NUM_DIMENSIONS * (target_level - level));
+}
+
+/* The child index of the cell within its parent */
+inline
+uint child_index(uint64 key)
+{
+    return uint(key & ((1 << NUM_DIMENSIONS) - 1));
+}
+
+/* The bits of a key holding the position in dimension dim (as a dilated integer) */
+inline
+uint64 dimension_mask(uint dim)
+{
+#if    NUM_DIMENSIONS == 2
+    return uint64(0x5555555555555555ULL) << dim;
+#elif  NUM_DIMENSIONS == 3
+    return uint64(0x1249249249249249ULL) << dim;
+#endif
+}
+
+/*
+ * Gets the key of the cell at the same level next to the cell with the given key and
+ * level. Returns false if that cell would be outside of the root cell.
+ */
+inline
+bool neighbor_key(uint64 key, uint level, uint dim, bool pos_dir, uint64 &neighbor)
+{
+    uint64 marker = uint64(1) << (NUM_DIMENSIONS * level);
+    uint64 mask = dimension_mask(dim) & (marker - 1);
+    uint64 pos = key & mask; // Position in dimension dim
+    if (pos_dir) {
+        if (pos == mask) {
+            return false;
+        }
+        pos = ((pos | ~mask) + 1) & mask;
+    }
+    else {
+        if (!pos) {
+            return false;
+        }
+        pos = (pos - 1) & mask;
+    }
+    neighbor = (key & ~mask) | pos;
+    return true;
+}
+
+} // namespace morton
+
+#endif  /* MORTON_H */
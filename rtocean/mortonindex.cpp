@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::logic_error;
+
+// Own includes
+#include "mortonindex.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+mortonindex::mortonindex()
+{
+    const uint INITIAL_SIZE_LOG2 = 10;
+    slot empty = {0, 0};
+    table.assign(1 << INITIAL_SIZE_LOG2, empty);
+    num_keys = 0;
+    shift = 64 - INITIAL_SIZE_LOG2;
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+void mortonindex::insert(uint64 key, octcell* cell)
+{
+#if  DEBUG
+    if (!key) {
+        throw logic_error("Trying to insert an invalid Morton key in the index");
+    }
+#endif
+    if (2 * (num_keys + 1) > table.size()) {
+        /* Keep the load factor below one half */
+        grow();
+    }
+    uint mask = table.size() - 1;
+    uint i = home(key);
+    for (; table[i].key; i = (i + 1) & mask) {
+        if (table[i].key == key) {
+#if  DEBUG
+            throw logic_error("Trying to insert a Morton key that is already in the index");
+#endif
+            table[i].cell = cell;
+            return;
+        }
+    }
+    table[i].key = key;
+    table[i].cell = cell;
+    num_keys++;
+}
+
+void mortonindex::erase(uint64 key)
+{
+    uint mask = table.size() - 1;
+    uint i = home(key);
+    for (; table[i].key != key; i = (i + 1) & mask) {
+        if (!table[i].key) {
+#if  DEBUG
+            throw logic_error("Trying to erase a Morton key that is not in the index");
+#endif
+            return;
+        }
+    }
+    /* Move later entries of the same probe sequence back into the hole, so that no tombstones are needed */
+    uint j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!table[j].key) {
+            break;
+        }
+        uint k = home(table[j].key);
+        /* Move the entry if its home slot is not cyclically in (i, j] */
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
+        }
+        table[i] = table[j];
+        i = j;
+    }
+    table[i].key = 0;
+    table[i].cell = 0;
+    num_keys--;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+void mortonindex::grow()
+{
+    std::vector<slot> old_slots;
+    old_slots.swap(table);
+    slot empty = {0, 0};
+    table.assign(2 * old_slots.size(), empty);
+    shift--;
+    num_keys = 0;
+    for (uint i = 0; i < old_slots.size(); i++) {
+        if (old_slots[i].key) {
+            insert(old_slots[i].key, old_slots[i].cell);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef MORTONINDEX_H
+#define MORTONINDEX_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "definitions.h"
+
+////////////////////////////////////////////////////////////////
+// PREDECLARATIONS
+////////////////////////////////////////////////////////////////
+
+class octcell;
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * A hash table from Morton keys (see morton.h) to cells, using open addressing
+ * with linear probing. Key 0 is never a valid Morton key and marks empty slots.
+ */
+class mortonindex
+{
+public:
+    mortonindex();
+
+public:
+    /* Public methods */
+    void     insert(uint64 key, octcell* cell);
+    void     erase(uint64 key);
+    octcell* find(uint64 key) const;
+    uint     size() const;
+
+private:
+    /* Private types */
+    struct slot {
+        uint64   key;
+        octcell* cell;
+    };
+
+private:
+    /* Private member variables */
+    std::vector<slot> table; /* The table, its size is a power of two */
+    uint              num_keys; /* The number of keys in the table */
+    uint              shift; /* 64 - log2(number of slots) */
+
+private:
+    /* Private methods */
+    uint home(uint64 key) const;
+    void grow();
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    mortonindex(mortonindex&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+octcell* mortonindex::find(uint64 key) const
+{
+    uint mask = table.size() - 1;
+    for (uint i = home(key); table[i].key; i = (i + 1) & mask) {
+        if (table[i].key == key) {
+            return table[i].cell;
+        }
+    }
+    return 0;
+}
+
+inline
+uint mortonindex::size() const
+{
+    return num_keys;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+/* Fibonacci hashing */
+inline
+uint mortonindex::home(uint64 key) const
+{
+    return uint((key * 0x9E3779B97F4A7C15ULL) >> shift);
+}
+
+#endif // MORTONINDEX_H
@@ -0,0 +1,333 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "multigrid.h"
+
+////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS
+////////////////////////////////////////////////////////////////
+
+namespace {
+
+const pftype SMOOTHING_WEIGHT = .8; /* Of the Jacobi sweeps, below 1 so that the short wavelengths are damped */
+const uint   COARSEST_SMOOTHING_STEPS = 20;
+const pftype NEGLIGIBLE_DIAGONAL = 1e-9; /* [1] Of the summed diagonals; what is left of a node that covers all the cells that are coupled to each other is rounding */
+
+} // namespace
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+multigrid::multigrid()
+{
+    lf = 0;
+    lf_generation = 0;
+    first_cell = 0;
+    end_cell = 0;
+    current = 0;
+    coarser = 0;
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*
+ * Sets up the levels for the equations of the leaf cells from first to end, given by
+ * the diagonal per cell and the coefficient per neighbor entry of the leaf store. The
+ * levels themselves are only built again when the leaf store has been rebuilt.
+ */
+void multigrid::set_up(threadpool& workers, const leafstore& lf, uint first, uint end, const std::vector<pftype>& diagonal, const std::vector<pftype>& coefficient)
+{
+    if (this->lf != &lf || lf_generation != lf.get_generation() || first_cell != first || end_cell != end) {
+        this->lf = &lf;
+        lf_generation = lf.get_generation();
+        first_cell = first;
+        end_cell = end;
+        build_finest_level(lf);
+        while (build_coarser_level(levels.size() - 1)) {
+        }
+    }
+
+    level& finest = levels[0];
+    for (uint node = 0; node < finest.diagonal.size(); node++) {
+        finest.diagonal[node] = diagonal[first_cell + node];
+    }
+    for (uint e = 0; e < leaf_entry.size(); e++) {
+        finest.coefficient[e] = coefficient[leaf_entry[e]];
+    }
+    for (uint k = 0; k + 1 < levels.size(); k++) {
+        current = &levels[k];
+        coarser = &levels[k + 1];
+        run_pass<&multigrid::sum_equations_to_node>(workers, coarser->diagonal.size());
+    }
+}
+
+/*
+ * Runs one cycle from zero for the residual of the leaf cells, and writes the result to
+ * the correction of the cells. The cycle index is the number of times each coarser level
+ * is visited per visit of the finer one: 1 for a V-cycle and 2 for a W-cycle.
+ */
+void multigrid::run_cycle(threadpool& workers, uint cycle_index, const std::vector<pftype>& residual, std::vector<pftype>& correction)
+{
+    level& finest = levels[0];
+    uint num_nodes = finest.diagonal.size();
+    for (uint node = 0; node < num_nodes; node++) {
+        finest.rhs[node] = residual[first_cell + node];
+    }
+    cycle_level(workers, 0, cycle_index, true);
+    for (uint node = 0; node < num_nodes; node++) {
+        correction[first_cell + node] = finest.x[node];
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+/* The leaf cells, with the entries of the neighbors that are not in the halo */
+void multigrid::build_finest_level(const leafstore& lf)
+{
+    levels.clear();
+    levels.resize(1);
+    level& l = levels[0];
+    uint num_nodes = end_cell - first_cell;
+    l.cell.resize(num_nodes);
+    l.first_entry.resize(num_nodes + 1);
+    leaf_entry.clear();
+    for (uint node = 0; node < num_nodes; node++) {
+        uint idx = first_cell + node;
+        l.cell[node] = lf.cell[idx];
+        l.first_entry[node] = leaf_entry.size();
+        for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+            uint ni = lf.neighbor[i];
+            if (ni >= first_cell && ni < end_cell) {
+                l.entry_node.push_back(ni - first_cell);
+                leaf_entry.push_back(i);
+            }
+        }
+    }
+    l.first_entry[num_nodes] = leaf_entry.size();
+    l.coefficient.resize(leaf_entry.size());
+    l.diagonal   .resize(num_nodes);
+    l.rhs        .resize(num_nodes);
+    l.x          .resize(num_nodes);
+    l.next_x     .resize(num_nodes);
+    l.residual   .resize(num_nodes);
+}
+
+/*
+ * Builds the level after level k, in which the cells of the finest tree level of level k
+ * are replaced by their parents. Returns false if level k is the coarsest level.
+ */
+bool multigrid::build_coarser_level(uint k)
+{
+    uint num_fine_nodes = levels[k].cell.size();
+    uint finest_level = 0;
+    for (uint node = 0; node < num_fine_nodes; node++) {
+        finest_level = MAX(finest_level, levels[k].cell[node]->lvl);
+    }
+    if (num_fine_nodes <= 1 || !finest_level) {
+        return false;
+    }
+    levels.resize(k + 2);
+    level& f = levels[k];
+    level& c = levels[k + 1];
+
+    /* The nodes */
+    f.coarse_node.resize(num_fine_nodes);
+    const octcell* last_cell = 0;
+    for (uint node = 0; node < num_fine_nodes; node++) {
+        const octcell* cell = f.cell[node];
+        if (cell->lvl == finest_level) {
+            cell = cell->get_parent();
+        }
+        if (cell != last_cell) {
+            c.cell.push_back(cell);
+            c.first_fine_node.push_back(node);
+            last_cell = cell;
+        }
+        f.coarse_node[node] = c.cell.size() - 1;
+    }
+    uint num_nodes = c.cell.size();
+    c.first_fine_node.push_back(num_fine_nodes);
+
+    /* The entries, one per coarser node that any of the finer nodes has an entry to */
+    f.coarse_entry.resize(f.entry_node.size());
+    c.first_entry.resize(num_nodes + 1);
+    for (uint node = 0; node < num_nodes; node++) {
+        c.first_entry[node] = c.entry_node.size();
+        for (uint fine_node = c.first_fine_node[node]; fine_node < c.first_fine_node[node + 1]; fine_node++) {
+            for (uint e = f.first_entry[fine_node]; e < f.first_entry[fine_node + 1]; e++) {
+                uint neighbor_node = f.coarse_node[f.entry_node[e]];
+                if (neighbor_node == node) {
+                    f.coarse_entry[e] = NO_ENTRY;
+                    continue;
+                }
+                uint ce = c.first_entry[node];
+                while (ce < c.entry_node.size() && c.entry_node[ce] != neighbor_node) {
+                    ce++;
+                }
+                if (ce == c.entry_node.size()) {
+                    c.entry_node.push_back(neighbor_node);
+                }
+                f.coarse_entry[e] = ce;
+            }
+        }
+    }
+    c.first_entry[num_nodes] = c.entry_node.size();
+    c.coefficient.resize(c.entry_node.size());
+    c.diagonal   .resize(num_nodes);
+    c.rhs        .resize(num_nodes);
+    c.x          .resize(num_nodes);
+    c.next_x     .resize(num_nodes);
+    c.residual   .resize(num_nodes);
+    return true;
+}
+
+/* Level k for the right-hand side in its rhs, from the solution in its x or from zero */
+void multigrid::cycle_level(threadpool& workers, uint k, uint cycle_index, bool from_zero)
+{
+    if (k + 1 == levels.size()) {
+        sweep(workers, k, COARSEST_SMOOTHING_STEPS, from_zero);
+        return;
+    }
+    sweep(workers, k, PRESSURE_SOLVER_SMOOTHING_STEPS, from_zero);
+
+    /* The residual to the parents */
+    level& l = levels[k];
+    level& c = levels[k + 1];
+    current = &l;
+    run_pass<&multigrid::calculate_residual_of_node>(workers, l.diagonal.size());
+    coarser = &c;
+    run_pass<&multigrid::restrict_to_node>(workers, c.diagonal.size());
+    for (uint i = 0; i < cycle_index; i++) {
+        cycle_level(workers, k + 1, cycle_index, !i);
+    }
+
+    /* The correction back from the parents */
+    current = &l;
+    coarser = &c;
+    run_pass<&multigrid::prolong_to_node>(workers, l.diagonal.size());
+    sweep(workers, k, PRESSURE_SOLVER_SMOOTHING_STEPS, false);
+}
+
+void multigrid::sweep(threadpool& workers, uint k, uint num_sweeps, bool from_zero)
+{
+    current = &levels[k];
+    for (uint s = 0; s < num_sweeps; s++) {
+        if (from_zero && !s) {
+            /* Only the right-hand side is left of the first sweep */
+            run_pass<&multigrid::sweep_node_from_zero>(workers, current->diagonal.size());
+            continue;
+        }
+        run_pass<&multigrid::sweep_node>(workers, current->diagonal.size());
+        current->x.swap(current->next_x);
+    }
+}
+
+/* A damped Jacobi step of the node of the current level */
+void multigrid::sweep_node(uint node)
+{
+    level& l = *current;
+    if (!l.diagonal[node]) {
+        l.next_x[node] = 0;
+        return;
+    }
+    pftype r = l.rhs[node] - l.diagonal[node] * l.x[node];
+    for (uint e = l.first_entry[node]; e < l.first_entry[node + 1]; e++) {
+        r += l.coefficient[e] * l.x[l.entry_node[e]];
+    }
+    l.next_x[node] = l.x[node] + SMOOTHING_WEIGHT * r / l.diagonal[node];
+}
+
+void multigrid::sweep_node_from_zero(uint node)
+{
+    level& l = *current;
+    l.x[node] = l.diagonal[node] ? pftype(SMOOTHING_WEIGHT * l.rhs[node] / l.diagonal[node]) : pftype(0);
+}
+
+void multigrid::calculate_residual_of_node(uint node)
+{
+    level& l = *current;
+    pftype r = l.rhs[node] - l.diagonal[node] * l.x[node];
+    for (uint e = l.first_entry[node]; e < l.first_entry[node + 1]; e++) {
+        r += l.coefficient[e] * l.x[l.entry_node[e]];
+    }
+    l.residual[node] = r;
+}
+
+/* The node of the coarser level gets the residual of its nodes of the current level */
+void multigrid::restrict_to_node(uint node)
+{
+    const level& l = *current;
+    level& c = *coarser;
+    pftype sum = 0;
+    for (uint fine_node = c.first_fine_node[node]; fine_node < c.first_fine_node[node + 1]; fine_node++) {
+        sum += l.residual[fine_node];
+    }
+    c.rhs[node] = sum;
+}
+
+/* The node of the current level gets the correction of its node of the coarser level */
+void multigrid::prolong_to_node(uint node)
+{
+    level& l = *current;
+    l.x[node] += coarser->x[l.coarse_node[node]];
+}
+
+/* The equation of the node of the coarser level is the sum of the ones of its nodes of the current level */
+void multigrid::sum_equations_to_node(uint node)
+{
+    const level& l = *current;
+    level& c = *coarser;
+    for (uint ce = c.first_entry[node]; ce < c.first_entry[node + 1]; ce++) {
+        c.coefficient[ce] = 0;
+    }
+    pftype diagonal = 0;
+    pftype sum_of_diagonals = 0;
+    for (uint fine_node = c.first_fine_node[node]; fine_node < c.first_fine_node[node + 1]; fine_node++) {
+        diagonal += l.diagonal[fine_node];
+        sum_of_diagonals += l.diagonal[fine_node];
+        for (uint e = l.first_entry[fine_node]; e < l.first_entry[fine_node + 1]; e++) {
+            if (l.coarse_entry[e] == NO_ENTRY) {
+                /* The face is inside the node, and the pressure difference over it is not seen */
+                diagonal -= l.coefficient[e];
+            }
+            else {
+                c.coefficient[l.coarse_entry[e]] += l.coefficient[e];
+            }
+        }
+    }
+    c.diagonal[node] = diagonal > NEGLIGIBLE_DIAGONAL * sum_of_diagonals ? diagonal : pftype(0);
+}
+
+/* Runs a node pass over the nodes of the current level, on the calling thread alone for the small levels, which take less time than handing them out */
+template<void (multigrid::*pass)(uint)>
+void multigrid::run_pass(threadpool& workers, uint num_nodes)
+{
+    if (num_nodes <= SOLVER_GRAIN_SIZE) {
+        run_node_pass<pass>(this, 0, 0, num_nodes);
+    }
+    else {
+        workers.run_range(&multigrid::run_node_pass<pass>, this, 0, num_nodes, SOLVER_GRAIN_SIZE);
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Runs a node pass of the current level over a range of nodes (see threadpool) */
+template<void (multigrid::*pass)(uint)>
+void multigrid::run_node_pass(void* multigrid_object, uint part, uint first, uint end)
+{
+    multigrid* mg = static_cast<multigrid*>(multigrid_object);
+    for (uint node = first; node < end; node++) {
+        (mg->*pass)(node);
+    }
+    part = part;
+}
@@ -0,0 +1,122 @@
+#ifndef MULTIGRID_H
+#define MULTIGRID_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "leafstore.h"
+#include "threadpool.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * A geometric multigrid cycle for the pressure equation (see pressuresolver.h), over the
+ * levels that the parents of the leaf cells give. The finest level holds the leaf cells,
+ * and every coarser level replaces the cells of the finest tree level that is left by
+ * their parent (_par), so the leaf cells that are already coarse are kept until the
+ * levels have caught up with them. The cells replaced by one parent are consecutive in
+ * leaf order, and so are the nodes of every level.
+ *
+ * A residual is restricted to the parent by summing it over the children, and the
+ * correction of the parent is prolonged back by adding it to each child, and the
+ * equations of the coarser level are the ones of the finer level summed in the same way
+ * (Galerkin), so the faces between two cells of a parent drop out and the faces between
+ * two parents add up. Each level is smoothed by damped Jacobi sweeps, the same number
+ * before and after the coarser level, and the coarsest one by more sweeps, which keeps
+ * the cycle symmetric, so that it can precondition the conjugate gradients. A V-cycle
+ * visits each coarser level once, and a W-cycle twice.
+ *
+ * The cells of one process are cycled on their own, as if the faces to the halo were
+ * closed apart from the diagonal, and the cycle does not depend on the number of threads.
+ */
+class multigrid
+{
+public:
+    /* Constructors and destructor */
+    multigrid();
+
+public:
+    /* Public methods */
+    void   set_up(threadpool& workers, const leafstore& lf, uint first, uint end, const std::vector<pftype>& diagonal, const std::vector<pftype>& coefficient);
+    void   run_cycle(threadpool& workers, uint cycle_index, const std::vector<pftype>& residual, std::vector<pftype>& correction);
+    uint   get_number_of_levels() const;
+
+private:
+    /* Types */
+    struct level {
+        /* The equations of the nodes */
+        std::vector<const octcell*> cell; /* The cell of each node, whose leaf cells are the ones of the node */
+        std::vector<uint>   first_entry; /* Index of the first entry of each node, plus the total number of entries last */
+        std::vector<uint>   entry_node; /* The other node of the entry */
+        std::vector<pftype> coefficient; /* Per entry */
+        std::vector<pftype> diagonal;
+        /* The solution of the cycle */
+        std::vector<pftype> rhs;
+        std::vector<pftype> x;
+        std::vector<pftype> next_x; /* Written by a Jacobi sweep while x is read */
+        std::vector<pftype> residual;
+        /* Towards the coarser level */
+        std::vector<uint>   coarse_node; /* Per node */
+        std::vector<uint>   coarse_entry; /* Per entry, the entry of the coarser level it is summed into, or NO_ENTRY if both nodes have the same coarser node */
+        /* Towards the finer level */
+        std::vector<uint>   first_fine_node; /* Index of the first node of the finer level of each node, plus the number of nodes of the finer level last */
+    };
+
+    /* Constants */
+    static const uint NO_ENTRY = ~0u;
+
+private:
+    /* Private member variables */
+    std::vector<level> levels; /* Finest first */
+    std::vector<uint> leaf_entry; /* Per entry of the finest level, the neighbor entry of the leaf store */
+    const leafstore* lf; /* The leaf store and the cells that the levels were built for */
+    uint   lf_generation;
+    uint   first_cell;
+    uint   end_cell;
+    level* current; /* The level of the running pass */
+    level* coarser;
+
+private:
+    /* Private methods */
+    void   build_finest_level(const leafstore& lf);
+    bool   build_coarser_level(uint k);
+    void   cycle_level(threadpool& workers, uint k, uint cycle_index, bool from_zero);
+    void   sweep(threadpool& workers, uint k, uint num_sweeps, bool from_zero);
+    void   sweep_node(uint node);
+    void   sweep_node_from_zero(uint node);
+    void   calculate_residual_of_node(uint node);
+    void   restrict_to_node(uint node);
+    void   prolong_to_node(uint node);
+    void   sum_equations_to_node(uint node);
+    template<void (multigrid::*pass)(uint)>
+    void   run_pass(threadpool& workers, uint num_nodes);
+
+    /* Private static methods */
+    template<void (multigrid::*pass)(uint)>
+    static void run_node_pass(void* multigrid_object, uint part, uint first, uint end);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    multigrid(multigrid&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+uint multigrid::get_number_of_levels() const
+{
+    return levels.size();
+}
+
+#endif // MULTIGRID_H
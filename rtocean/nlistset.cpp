@@ -1,3 +1,3 @@
-#include "nlset.h"
-
-
+#include "nlset.h"
+
+
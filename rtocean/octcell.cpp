@@ -1,736 +1,1094 @@
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-// Own includes
-#include "octcell.h"
-
-////////////////////////////////////////////////////////////////
-// CONSTRUCTORS AND DESTRUCTOR
-////////////////////////////////////////////////////////////////
-
-octcell::octcell(octcell *parent, pftype size, pfvec pos, uint level, uint internal_layer_advancement)
-{
-    _par = parent;
-    s = size;
-    r = pos;
-    lvl = level;
-    //ila = internal_layer_advancement;
-    internal_layer_advancement = internal_layer_advancement;
-    _c = 0;
-}
-
-octcell::~octcell()
-{
-    /* Remove all neighbor connections */
-    break_all_neighbor_connections();
-
-    /* Delete potential children */
-    if (has_child_array()) {
-        for (uint i = 0; i < MAX_NUM_CHILDREN; i++) {
-            if (has_child(i)) {
-                delete get_child(i);
-            }
-        }
-        delete _c;
-    }
-}
-
-////////////////////////////////////////////////////////////////
-// PUBLIC NON-STATIC METHODS
-////////////////////////////////////////////////////////////////
-
-/**************
- * Simulation *
- **************/
-
-void octcell::set_volume_coefficients(pftype water_volume_coefficient, pftype total_volume_coefficient)
-{
-#if  DEBUG
-#if  0
-    cout << endl;
-    cout << "Cell: Old water volume coefficient: " << water_vol_coeff << endl;
-    cout << "Cell: Old total volume coefficient: " << total_vol_coeff << endl;
-    cout << "Cell: Additional water volume coefficient: " << water_volume_coefficient-water_vol_coeff << endl;
-    cout << "Cell: Additional total volume coefficient: " << total_volume_coefficient-total_vol_coeff << endl;
-    cout << "Cell: New water volume coefficient: " << water_volume_coefficient << endl;
-    cout << "Cell: New total volume coefficient: " << total_volume_coefficient << endl;
-#endif
-    if (IS_NAN(water_volume_coefficient)) {
-        throw logic_error("Trying to set a NaN water_volume_coefficient in cell");
-    }
-    if (IS_NAN(total_volume_coefficient)) {
-        throw logic_error("Trying to set a NaN total_volume_coefficient in cell");
-    }
-    if (water_volume_coefficient < 0) {
-        throw logic_error("Trying to set a negative water_volume_coefficient in cell");
-    }
-    if (total_volume_coefficient < 0) {
-        throw logic_error("Trying to set a negative total_volume_coefficient in cell");
-    }
-    if (water_volume_coefficient > total_volume_coefficient) {
-        throw logic_error("Trying to set a higher water_volume_coefficient than total_volume_coefficient in cell");
-    }
-#endif
-    water_vol_coeff = water_volume_coefficient;
-    total_vol_coeff = total_volume_coefficient;
-    calculate_pressure();
-}
-
-void octcell::calculate_pressure()
-{
-#if  USE_ARTIFICIAL_COMPRESSIBILITY
-#if  NO_ATMOSPHERE
-#if  VACUUM_HAS_PRESSURE
-    p = (total_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
-#else
-    p = (water_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
-    if (p < 0) {
-#if  ALLOW_NEGATIVE_PRESSURES
-#if INTERPOLATE_SURFACE_PRESSURE
-        /* Loop through neighbors */
-        nlset lists;
-        lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
-        lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-        lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
-        for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-            pftype num_terms = 0;
-            pftype average_pressure_below = 0;
-            pftype average_distance_down = 0;
-            if (node->v.dim == VERTICAL_DIMENSION && !node->v.pos_dir) {
-                /* Have found a node beneath, get pressure */
-                average_pressure_below += node->v.n->p;
-                average_distance_down -= node->v.n->get_edge_length()/2;
-                num_terms++;
-            }
-            pftype pressure_gradient;
-            if (num_terms) {
-                average_pressure_below /= num_terms;
-                average_distance_down /= num_terms;
-                average_distance_down += get_alpha()*get_edge_length();
-                pressure_gradient = (average_pressure_below - NORMAL_AIR_PRESSURE)/average_distance_down;
-            }
-            else {
-                pressure_gradient = P_G * P_WATER_DENSITY;
-            }
-            p = NORMAL_AIR_PRESSURE + (get_alpha()-0.5)*get_edge_length()*pressure_gradient;
-        }
-#else
-        // Prevent too low pressures at the boundary
-        p = (total_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
-        if (p > 0) {
-            p = 0; // Vacuum partly fills the cell
-        }
-#endif
-#else
-        p = 0;
-#endif // ALLOW_NEGATIVE_PRESSURES
-    }
-#endif // VACUUM_HAS_PRESSURE
-#else // NO_ATMOSPHERE
-    if (has_no_air()) {
-        /* Cell consists only of water */
-        p = (water_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
-        if (p < 0) {
-#if  ALLOW_NEGATIVE_PRESSURES
-            // Prevent too low pressures at the boundary
-            p = (total_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
-            if (p > 0) {
-                p = 0; // Vacuum partly fills the cell
-            }
-#else
-            p = 0;
-#endif // ALLOW_NEGATIVE_PRESSURES
-        }
-    }
-    else if (has_no_water()) {
-        /* Cell consists only of air */
-        p = total_vol_coeff * NORMAL_AIR_PRESSURE;
-    }
-    else {
-        /* Calculate pressure for a mixed cell */
-        // Optimize
-        pftype k = ARTIFICIAL_COMPRESSIBILITY_FACTOR;
-        pftype q = NORMAL_AIR_PRESSURE;
-        pftype a = get_air_volume_coefficient();
-        pftype w = water_vol_coeff;
-        pftype d = q*a/k;
-        //"Don't know if this formula is correct"
-        p = k/2*(sqrt(SQUARE(d + 1 - w) + 4*d*w) + d + w - 1);
-#if  DEBUG
-        if (IS_NAN(p)) {
-            throw logic_error("Pressure became NaN");
-        }
-#endif
-    }
-#endif //NO_ATMOSPHERE
-#else  //USE_ARTIFICIAL_COMPRESSIBILITY
-    "don't know what to do now"
-#endif  //USE_ARTIFICIAL_COMPRESSIBILITY
-}
-
-/*******************
- * Level of detail *
- *******************/
-
-/**********
- * Family *
- **********/
-
-octcell* octcell::get_child(uint idx) const
-{
-#if  DEBUG
-    if (!has_child(idx)) {
-        NO_OP();
-        //throw logic_error("Trying to get a child cell that does not exist");
-    }
-#endif
-    return _c[idx];
-}
-
-void octcell::make_parent()
-{
-    create_new_empty_child_array();
-
-    /*
-     * This cell is no longer a parent cell, update other end of the connections to
-     * the neighbor cells at the same level and at the higher level
-     */
-
-    /* Update the neighbor cells' connections on the same level */
-    nlset same_level_set;
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
-    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
-        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF);
-    }
-
-    /* Update the neighbor cells' connections on the higher level */
-    nlnode* node = neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node();
-    nlnode* next_node;
-    for (; node; node = next_node) {
-        next_node = node->get_next_node();
-        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF);
-    }
-
-    /*
-     * The lower level neighbors do not need to be updated, because they have only
-     * one list for cells at this level anyway
-     */
-}
-
-void octcell::make_leaf()
-{
-#if  DEBUG
-    if (is_leaf()) {
-        throw logic_error("Trying to make a leaf cell a leaf");
-    }
-    for (uint i = 0; i < MAX_NUM_CHILDREN; i++) {
-        if (has_child(i)) {
-            throw logic_error("Trying to make a cell with at least one child a leaf cell");
-        }
-    }
-#endif
-    delete[] _c;
-    _c = 0;
-
-    /*
-     * This cell is no longer a leaf cell, update other end of the connections to
-     * the neighbor cells at the same level and at the higher level
-     */
-
-    /* Update the neighbor cells' connections on the same level */
-    nlset same_level_set;
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
-    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
-        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_LEAF);
-    }
-
-    /* Update the neighbor cells' connections on the higher level */
-    nlnode* node = neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node();
-    nlnode* next_node;
-    for (; node; node = next_node) {
-        next_node = node->get_next_node();
-        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_LOWER_LEVEL_OF_DETAIL_LEAF);
-    }
-
-    /*
-     * The lower level neighbors do not need to be updated, because they have only
-     * one list for cells at this level anyway
-     */
-}
-
-void octcell::refine()
-{
-    _create_new_random_child_array();
-
-    // Create new values for children
-    pftype s_2 = 0.5*s;
-    pfvec corners[2];
-    corners[0] = r;
-    corners[1] = get_cell_center();
-    uint   new_level = lvl + 1;
-
-    // Create children with new values
-    pfvec new_r;
-    for (uint i = 0; i < MAX_NUM_CHILDREN; i++) {
-        for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-            new_r[dim] = corners[(i >> dim) & 1][dim];
-        }
-        set_child(i, new octcell(this, s_2, new_r, new_level));
-    }
-
-    /*****************************
-     * +-----------------------+ *
-     * |                       | *
-     * |  AHEAD: MOUNT CODE 1  | *
-     * |                       | *
-     * +-----------------------+ *
-     *****************************/
-
-    /* Find neighbors on this and the children's and the children's children's level */
-    nlset same_level_set;
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
-    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
-        octcell* n = node->v.n; // Neighbor
-        uint dim = node->v.dim;
-        bool pos_dir = node->v.pos_dir;
-        for (uint cidx = 0; cidx < MAX_NUM_CHILDREN; cidx++) { // Child index in this cell
-            if (positive_direction_of_child(cidx, dim) == pos_dir) {
-                /* Child index is in the right half */
-                if (has_child(cidx)) {
-                    /* Child exists, make neighbor */
-                    octcell* c = get_child(cidx); // Child
-                    if (n->has_child_array()) {
-                        make_neighbors(c, n, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
-                        /* Cell has children, see if there is a neighbor at the child level */
-                        uint ncidx = child_index_flip_direction(cidx, dim); // Neighbor child index
-                        if (n->has_child(ncidx)) {
-                            /* Neighbor cell on child level exists too, make neighbors */
-                            octcell* nc = n->get_child(ncidx); // Neighbor child
-                            if (nc->has_child_array()) {
-                                make_neighbors(c, nc, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
-                                /* Child cell has children too, see if any of these are neighbors */
-                                for (uint nccidx = 0; nccidx < MAX_NUM_CHILDREN; nccidx++) { // Neighbor child child index
-                                    if (positive_direction_of_child(nccidx, dim) != pos_dir) {
-                                        // Potential neighbor child child is in righ half, make neighbor
-                                        if (nc->has_child(nccidx)) {
-                                            // Cell exists, make neighbor
-                                            octcell* ncc = nc->get_child(nccidx);
-                                            make_neighbors(c, ncc, NL_HIGHER_LEVEL_OF_DETAIL, NL_LOWER_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
-                                        }
-                                    }
-                                } // for nccidx
-                            } // if nc->has_child_array()
-                            else {
-                                make_neighbors(c, nc, NL_SAME_LEVEL_OF_DETAIL_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
-                            }
-                        }
-
-                    } // if n->has_child_array()
-                    else {
-                        make_neighbors(c, n, NL_LOWER_LEVEL_OF_DETAIL_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
-                    }
-                } // if c
-            } // if child index is in right half
-        } // cidx
-        /* This cell is no longer a leaf cell, update other end of neighbor connection */
-        n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF);
-    } // node
-
-    /*
-     * This cell is no longer a leaf cell, update other end of the connections to
-     * the higher level
-     */
-    nlnode* node = neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node();
-    nlnode* next_node;
-    for (; node; node = next_node) {
-        next_node = node->get_next_node();
-        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF);
-    }
-
-    /*
-     * The higher level neighbors have already been updated in the code mountain
-     */
-
-    /*
-     * The lower level neighbors do not need to be updated, because they have only
-     * one list for cells at this level anyway
-     */
-
-    // Create all neighbor connections internally between the child cells
-    // Optimize
-    for (uint idx1 = 0; idx1 < MAX_NUM_CHILDREN; idx1++) {
-        for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-            uint idx2 = idx1 | child_index_offset(dim);
-            if (idx2 > idx1) {
-                make_neighbors(get_child(idx1), get_child(idx2), NL_SAME_LEVEL_OF_DETAIL_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, true);
-            }
-        }
-    }
-}
-
-void octcell::coarsen()
-{
-#if  DEBUG
-    /* This function will make the cell a leaf cell */
-    if (is_leaf()) {
-        throw logic_error("Trying to coarsen a leaf cell");
-    }
-#endif
-
-    water_vol_coeff = 0;
-    total_vol_coeff = 0;
-    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
-        if (has_child(idx)) {
-            /* Child exists, remove it */
-            octcell* c = get_child(idx);
-            if (c->has_child_array()) {
-                /* Coarsen it to get updated properties */
-                c->coarsen();
-            }
-            water_vol_coeff += c->water_vol_coeff;
-            total_vol_coeff += c->total_vol_coeff;
-            remove_child(idx);
-        }
-    }
-    water_vol_coeff *= (pftype(1)/MAX_NUM_CHILDREN);
-    total_vol_coeff *= (pftype(1)/MAX_NUM_CHILDREN);
-    make_leaf();
-}
-
-octcell* octcell::create_new_air_child(uint child_idx)
-{
-#if  DEBUG
-    if (!has_child_array()) {
-        throw logic_error("Trying to create a new air child in a cell without a child array");
-    }
-    if (child_idx < 0 || child_idx >= MAX_NUM_CHILDREN) {
-        throw out_of_range("Trying to create an air child with index out of bound");
-    }
-    if (has_child(child_idx)) {
-        throw logic_error("Trying to create a new air child that already exists");
-    }
-#endif
-    // Create new values for child
-    pftype s_2 = 0.5*s;
-    pfvec new_r;
-    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-        new_r[dim] = r[dim] + ((child_idx >> dim) & 1) * s_2;
-    }
-    // Create child with new values
-    octcell *child = new octcell(this, s_2, new_r, lvl + 1);
-    child->set_volume_coefficients(0, 1);
-    set_child(child_idx, child);
-
-    /* Create neighbor connections for new child */
-
-    /*****************************
-     * +-----------------------+ *
-     * |                       | *
-     * |  AHEAD: MOUNT CODE 2  | *
-     * |                       | *
-     * +-----------------------+ *
-     *****************************/
-
-    /* Find neighbors on this and the child's and the child's children's level */
-    nlset same_level_set;
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
-    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
-        octcell* n = node->v.n; // Neighbor
-        uint dim = node->v.dim;
-        bool pos_dir = node->v.pos_dir;
-        if (positive_direction_of_child(child_idx, dim) == pos_dir) {
-            /* Child index is in the right half */
-            if (n->has_child_array()) {
-                make_neighbors(child, n, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
-                /* Cell has children, see if there is a neighbor at the child level */
-                uint ncidx = child_index_flip_direction(child_idx, dim); // Neighbor child index
-                if (n->has_child(ncidx)) {
-                    /* Neighbor cell on child level exists too, make neighbors */
-                    octcell* nc = n->get_child(ncidx); // Neighbor child
-                    if (nc->has_child_array()) {
-                        make_neighbors(child, nc, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
-                        /* Child cell has children too, see if any of these are neighbors */
-                        for (uint nccidx = 0; nccidx < MAX_NUM_CHILDREN; nccidx++) { // Neighbor child child index
-                            if (positive_direction_of_child(nccidx, dim) != pos_dir) {
-                                // Potential neighbor child child is in righ half, make neighbor
-                                if (nc->has_child(nccidx)) {
-                                    // Cell exists, make neighbor
-                                    octcell* ncc = nc->get_child(nccidx);
-                                    make_neighbors(child, ncc, NL_HIGHER_LEVEL_OF_DETAIL, NL_LOWER_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
-                                }
-                            }
-                        } // for nccidx
-                    } // if nc->has_child_array()
-                    else {
-                        make_neighbors(child, nc, NL_SAME_LEVEL_OF_DETAIL_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
-                    }
-                }
-
-            } // if n->has_child_array()
-            else {
-                make_neighbors(child, n, NL_LOWER_LEVEL_OF_DETAIL_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
-            }
-        } // if child index is in right half
-        /* This cell is no longer a leaf cell, update other end of neighbor connection */
-        n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF);
-    } // node
-
-    // Create all neighbor connections internally between this child cell and other child cells that may exist
-    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-        /* Get other child in this dimension */
-        uint other_child_idx = child_idx ^ child_index_offset(dim);
-        if (has_child(other_child_idx)) {
-            /* Child exists, make neighbors */
-            octcell *other_child = get_child(other_child_idx);
-            make_neighbors(child, other_child,
-                           other_child->has_child_array() ? NL_SAME_LEVEL_OF_DETAIL_NON_LEAF : NL_SAME_LEVEL_OF_DETAIL_LEAF,
-                           NL_SAME_LEVEL_OF_DETAIL_LEAF,
-                           dim, other_child_idx > child_idx);
-        }
-    }
-
-    return child;
-}
-
-void octcell::move_neighbor_connection_to_other_list(nlnode *node, uint new_list_index)
-{
-#if  DEBUG
-    if (new_list_index >= NUM_NEIGHBOR_LISTS) {
-        throw out_of_range("Trying to move node to list with invalid index");
-    }
-#endif
-    node->remove_from_list_and_keep();
-    neighbor_lists[new_list_index].add_existing_node(node);
-}
-
-void octcell::break_all_neighbor_connections()
-{
-    for (uint i = 0; i < NUM_NEIGHBOR_LISTS; i++) {
-        nlnode* current_node;
-        nlnode* next_node;
-        for (current_node = neighbor_lists[i].get_first_node(); current_node; current_node = next_node) {
-            next_node = current_node->get_next_node();
-            un_neighbor(current_node);
-        }
-    }
-}
-
-/* Flow */
-
-pftype octcell::get_velocity_divergence() const
-{
-    pftype div = 0;
-    /* Loop through neighbors */
-    nlset lists;
-    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
-    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        div += node->v.vel_out * node->v.cf_area;
-    }
-    div /= get_cube_volume();
-    return div;
-}
-
-pftype octcell::get_water_flow_divergence() const
-{
-    pftype div = 0;
-    /* Loop through neighbors */
-    nlset lists;
-    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
-    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        div += node->v.vel_out * node->v.water_vol_coeff * node->v.cf_area;
-    }
-    div /= get_cube_volume();
-    return div;
-}
-
-void octcell::prepare_for_water()
-{
-    /*
-     * This function takes care of:
-     *   1. Walls to cells with no water in them
-     *   2. Missing neighbors (create new ones)
-     */
-
-    /* Calculate average velocity vector */
-    pfvec mean_vel;
-    pfvec area[2];
-    /* Loop though neighbors */
-    nlset lists;
-    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
-    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.n->has_water()) {
-            /* This velocity is relevant, use it to calculate mean velocity vector */
-            area[node->v.pos_dir].e[node->v.dim] += node->v.cf_area;
-            mean_vel.e[node->v.dim] += node->v.cf_area * node->v.get_signed_dir() * node->v.vel_out;
-        }
-    }
-    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-        pftype dim_area = area[0].e[dim] + area[1].e[dim];
-        if (dim_area) {
-            mean_vel.e[dim] /= dim_area;
-        }
-        else {
-            /* Don't know the velocity in this direction */
-            // TODO: Find out the velocity in some other way
-            //mean_vel[dim] = 0; This componentis already 0
-        }
-        for (uint pos_dir = 0; pos_dir < 2; pos_dir++) {
-            if (area[pos_dir].e[dim] < (7.0/8) * get_side_area()) {
-                /* Needs new neighbors at this side */
-                /* Not guaranteed though that neighbors will be created; this may be a wall */
-                pfvec neighbor_center = get_cell_center();
-                neighbor_center.e[dim] += (2*int(pos_dir) - 1) * get_edge_length();
-                create_new_air_neighbors(neighbor_center, dim, pos_dir, lvl);
-                //TODO:: Set velocities in faces to newly created cells
-            }
-        }
-    }
-
-    /* Set velocities on faces to empty cells */
-    /* Loop though neighbors */
-    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
-    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
-    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.n->has_no_water()) {
-            /* The velocity out for this neighbor connection currently contains humbug, initialize it */
-            node->v.set_velocity_out(mean_vel[node->v.dim]*node->v.get_signed_dir());
-        }
-    }
-}
-
-void octcell::create_new_air_neighbors(pfvec neighbor_center, uint dim, bool pos_dir, uint source_level)
-{
-#if 0
-    static int count = 0;
-    count++;
-    if (count == 16200) {
-        NO_OP();
-    }
-    cout << count << endl;
-#endif
-    if (inside_of_cell(neighbor_center)) {
-        /* Neighbor is in this cell */
-        if (is_fine_enough()) {
-            // All neighbors created
-            return;
-        }
-        /* Cell is not fine enough */
-        if (is_leaf()) {
-            make_parent();
-        }
-        if (lvl < source_level) {
-            /* The cell who wants the nieghbors is at a higher level, find the one neighboring child */
-            uint child_idx = get_child_index_from_position(neighbor_center);
-            if (!has_child(child_idx)) {
-                create_new_air_child(child_idx);
-            }
-            get_child(child_idx)->create_new_air_neighbors(neighbor_center, dim, pos_dir, source_level);
-        }
-        else {
-            /* The cell who wants the neighbors is not at a higher level and therefore neighbor to half of this cell's children */
-            for (uint child_idx = 0; child_idx < MAX_NUM_CHILDREN; child_idx++) {
-                if (positive_direction_of_child(child_idx, dim) != pos_dir) {
-                    /* Child cell is in the right half */
-                    octcell *child;
-                    if (!has_child(child_idx)) {
-                        child = create_new_air_child(child_idx);
-                    }
-                    else {
-                        child = get_child(child_idx);
-                    }
-                    //child->create_new_air_neighbors(child->get_cell_center(), dim, pos_dir, source_level);
-                }
-            }
-        }
-    }
-    else if (has_parent()) {
-        /* Neighbor is outside of this cell */
-        /* Must step up one level to get to position */
-        get_parent()->create_new_air_neighbors(neighbor_center, dim, pos_dir, source_level);
-    }
-    else {
-        /* Neighbor is outside of root cell (this cell) */
-        // TODO: Create water outside of root cell
-    }
-}
-
-void octcell::add_leaf_neighbor_lists_to_list_set(nlset &lists)
-{
-    lists.add_neighbor_list(&(neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]));
-    lists.add_neighbor_list(&(neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]));
-    lists.add_neighbor_list(&(neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]));
-}
-
-////////////////////////////////////////////////////////////////
-// PUBLIC STATIC METHODS
-////////////////////////////////////////////////////////////////
-
-void octcell::make_neighbors(octcell* cell1, octcell* cell2, uint cell1_neighbor_list_idx, uint cell2_neighbor_list_idx, uint dimension, bool pos_dir)
-{
-#if  DEBUG
-    if (!(cell1 && cell2)) {
-        throw logic_error("Trying to make a cell neighbor using a null pointer");
-    }
-    if (cell1 == cell2) {
-        throw logic_error("Trying to make a cell neighbor with itself");
-    }
-    if (cell1_neighbor_list_idx >= NUM_NEIGHBOR_LISTS || cell2_neighbor_list_idx >= NUM_NEIGHBOR_LISTS) {
-        throw out_of_range("Neighbor list index doesn't exist");
-    }
-    if ((cell1_neighbor_list_idx == NL_HIGHER_LEVEL_OF_DETAIL) && (cell2_neighbor_list_idx == NL_HIGHER_LEVEL_OF_DETAIL)) {
-        throw logic_error("Error when making neighbors: Both cells are claimed to be on the higher level");
-    }
-    if (((cell1_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_LEAF) ||
-         (cell1_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_NON_LEAF)) !=
-        ((cell2_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_LEAF) ||
-         (cell2_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_NON_LEAF)) ) {
-        throw logic_error("Error when making neighbors: One cell is at the same level as the other cell but the other cell is not at the same level as the first cell");
-    }
-    if (((cell1_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_LEAF) ||
-         (cell1_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF)) &&
-        ((cell2_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_LEAF) ||
-         (cell2_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF)) ) {
-        throw logic_error("Error when making neighbors: Both cells are claimed to be on the lower level");
-    }
-#endif
-    /* Create elements to work with */
-    nlnode* node1 = cell1->neighbor_lists[cell1_neighbor_list_idx].add_new_element();
-    nlnode* node2 = cell2->neighbor_lists[cell2_neighbor_list_idx].add_new_element();
-    /* Calculate properties */
-    pfvec dist = cell2->get_cell_center() - cell1->get_cell_center();
-    pftype dist_abs = dist.length();
-    pftype min_s = MIN(cell1->s, cell2->s);
-    pftype area = cube_side_area(min_s);
-    /* Set properties */
-    node1->v.set(cell2, node2, dimension,  pos_dir, 0, 0, 0,  dist, dist_abs, area);
-    node2->v.set(cell1, node1, dimension, !pos_dir, 0, 0, 0, -dist, dist_abs, area);
-}
-
-////////////////////////////////////////////////////////////////
-// PRIVATE STATIC METHODS
-////////////////////////////////////////////////////////////////
-
-/* The size of a leaf cell should be at the maximum the value of this function applied to its cell center */
-pftype octcell::size_accuracy(pfvec r)
-{
-    if (r.e[VERTICAL_DIMENSION] < SURFACE_HEIGHT) {
-        /* Cell is under the surface */
-        return SURFACE_ACCURACY + (SURFACE_HEIGHT - r.e[VERTICAL_DIMENSION])
-                * (1/(MIN_LOD_LAYER_THICKNESS + 0.5));
-    }
-    else {
-        return SURFACE_ACCURACY;
-    }
-}
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <new>
+
+// Own includes
+#include "octcell.h"
+#include "fvoctree.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+octcell::octcell(fvoctree *tree, octcell *parent, ivec position, uint level, uint internal_layer_advancement)
+{
+    _par = parent;
+    _tree = tree;
+    ri = position;
+    lvl = level;
+    //ila = internal_layer_advancement;
+    internal_layer_advancement = internal_layer_advancement;
+    key = morton::ROOT_KEY;
+    _c = 0;
+    _cm = 0;
+    li = 0;
+    leaf_neighbors_cached = false;
+#if  !USE_ARTIFICIAL_COMPRESSIBILITY
+    /* The pressures are solved for (see pressuresolver.h), starting from the ones the cells had */
+    p = parent ? pftype(parent->p) : pftype(NORMAL_AIR_PRESSURE);
+#endif
+}
+
+octcell::~octcell()
+{
+    /* Remove all neighbor connections */
+    if (_tree && _tree->is_being_destroyed()) {
+        /* The neighbors are deleted too, just forget about them */
+        for (uint i = 0; i < NUM_NEIGHBOR_LISTS; i++) {
+            neighbor_lists[i].detach_all_nodes();
+        }
+    }
+    else {
+        break_all_neighbor_connections();
+    }
+
+    /* Delete potential children */
+    if (has_child_array()) {
+        for (uint i = 0; i < MAX_NUM_CHILDREN; i++) {
+            if (has_child(i)) {
+                delete_child(i);
+            }
+        }
+        if (!(_tree && _tree->is_being_destroyed())) {
+            delete_child_array();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC NON-STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/************
+ * Geometry *
+ ************/
+
+/* The accuracy is set per tree, see fvoctree::size_accuracy */
+bool octcell::is_fine_enough() const
+{
+    return get_edge_length() <= _tree->size_accuracy(get_cell_center());
+}
+
+/**************
+ * Simulation *
+ **************/
+
+/* A cell in the leaf store may leave the pressure to be calculated later, see leafstore::set_volume_coefficients */
+void octcell::set_volume_coefficients(pftype water_volume_coefficient, pftype total_volume_coefficient, bool update_pressure)
+{
+#if  DEBUG
+#if  0
+    cout << endl;
+    cout << "Cell: Old water volume coefficient: " << water_vol_coeff << endl;
+    cout << "Cell: Old total volume coefficient: " << total_vol_coeff << endl;
+    cout << "Cell: Additional water volume coefficient: " << water_volume_coefficient-water_vol_coeff << endl;
+    cout << "Cell: Additional total volume coefficient: " << total_volume_coefficient-total_vol_coeff << endl;
+    cout << "Cell: New water volume coefficient: " << water_volume_coefficient << endl;
+    cout << "Cell: New total volume coefficient: " << total_volume_coefficient << endl;
+#endif
+    if (IS_NAN(water_volume_coefficient)) {
+        throw logic_error("Trying to set a NaN water_volume_coefficient in cell");
+    }
+    if (IS_NAN(total_volume_coefficient)) {
+        throw logic_error("Trying to set a NaN total_volume_coefficient in cell");
+    }
+    if (water_volume_coefficient < 0) {
+        throw logic_error("Trying to set a negative water_volume_coefficient in cell");
+    }
+    if (total_volume_coefficient < 0) {
+        throw logic_error("Trying to set a negative total_volume_coefficient in cell");
+    }
+    if (water_volume_coefficient > total_volume_coefficient) {
+        throw logic_error("Trying to set a higher water_volume_coefficient than total_volume_coefficient in cell");
+    }
+#endif
+    water_vol_coeff = water_volume_coefficient;
+    total_vol_coeff = total_volume_coefficient;
+    if (update_pressure) {
+        calculate_pressure();
+    }
+}
+
+void octcell::calculate_pressure()
+{
+#if  USE_ARTIFICIAL_COMPRESSIBILITY
+#if  NO_ATMOSPHERE
+#if  VACUUM_HAS_PRESSURE
+    p = (total_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
+#else
+    p = (water_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
+    if (p < 0) {
+#if  ALLOW_NEGATIVE_PRESSURES
+#if INTERPOLATE_SURFACE_PRESSURE
+        /* Loop through neighbors */
+        nlset lists;
+        lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
+        lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+        lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
+        for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+            pftype num_terms = 0;
+            pftype average_pressure_below = 0;
+            pftype average_distance_down = 0;
+            if (node->v.dim == VERTICAL_DIMENSION && !node->v.pos_dir) {
+                /* Have found a node beneath, get pressure */
+                average_pressure_below += node->v.n->p;
+                average_distance_down -= node->v.n->get_edge_length()/2;
+                num_terms++;
+            }
+            pftype pressure_gradient;
+            if (num_terms) {
+                average_pressure_below /= num_terms;
+                average_distance_down /= num_terms;
+                average_distance_down += get_alpha()*get_edge_length();
+                pressure_gradient = (average_pressure_below - NORMAL_AIR_PRESSURE)/average_distance_down;
+            }
+            else {
+                pressure_gradient = P_G * P_WATER_DENSITY;
+            }
+            p = NORMAL_AIR_PRESSURE + (get_alpha()-0.5)*get_edge_length()*pressure_gradient;
+        }
+#else
+        // Prevent too low pressures at the boundary
+        p = (total_vol_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
+        if (p > 0) {
+            p = 0; // Vacuum partly fills the cell
+        }
+#endif
+#else
+        p = 0;
+#endif // ALLOW_NEGATIVE_PRESSURES
+    }
+#endif // VACUUM_HAS_PRESSURE
+#else // NO_ATMOSPHERE
+    p = physics::vol_coeffs_to_pressure(water_vol_coeff, total_vol_coeff);
+#if  DEBUG
+    if (IS_NAN(p)) {
+        throw logic_error("Pressure became NaN");
+    }
+#endif
+#endif //NO_ATMOSPHERE
+#else  //USE_ARTIFICIAL_COMPRESSIBILITY
+    /* The pressures of all the leaf cells are solved for together, see pressuresolver.h */
+#endif  //USE_ARTIFICIAL_COMPRESSIBILITY
+}
+
+/*******************
+ * Level of detail *
+ *******************/
+
+/**********
+ * Family *
+ **********/
+
+octcell* octcell::get_child(uint idx) const
+{
+#if  DEBUG
+    if (!has_child(idx)) {
+        NO_OP();
+        //throw logic_error("Trying to get a child cell that does not exist");
+    }
+#endif
+    return has_child(idx) ? &_c[idx] : 0;
+}
+
+void octcell::make_parent()
+{
+    create_new_empty_child_array();
+    topology_changed();
+
+    /*
+     * This cell is no longer a parent cell, update other end of the connections to
+     * the neighbor cells at the same level and at the higher level
+     */
+
+    /* Update the neighbor cells' connections on the same level */
+    nlset same_level_set;
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
+    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
+        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF);
+    }
+
+    /* Update the neighbor cells' connections on the higher level */
+    nlnode* node = neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node();
+    nlnode* next_node;
+    for (; node; node = next_node) {
+        next_node = node->get_next_node();
+        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF);
+    }
+
+    /*
+     * The lower level neighbors do not need to be updated, because they have only
+     * one list for cells at this level anyway
+     */
+}
+
+void octcell::make_leaf()
+{
+#if  DEBUG
+    if (is_leaf()) {
+        throw logic_error("Trying to make a leaf cell a leaf");
+    }
+    for (uint i = 0; i < MAX_NUM_CHILDREN; i++) {
+        if (has_child(i)) {
+            throw logic_error("Trying to make a cell with at least one child a leaf cell");
+        }
+    }
+#endif
+    delete_child_array();
+    topology_changed();
+
+    /*
+     * This cell is no longer a leaf cell, update other end of the connections to
+     * the neighbor cells at the same level and at the higher level
+     */
+
+    /* Update the neighbor cells' connections on the same level */
+    nlset same_level_set;
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
+    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
+        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_LEAF);
+    }
+
+    /* Update the neighbor cells' connections on the higher level */
+    nlnode* node = neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node();
+    nlnode* next_node;
+    for (; node; node = next_node) {
+        next_node = node->get_next_node();
+        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_LOWER_LEVEL_OF_DETAIL_LEAF);
+    }
+
+    /*
+     * The lower level neighbors do not need to be updated, because they have only
+     * one list for cells at this level anyway
+     */
+}
+
+void octcell::refine()
+{
+    create_new_empty_child_array();
+    topology_changed();
+
+    // Create children
+    for (uint i = 0; i < MAX_NUM_CHILDREN; i++) {
+        create_child(i);
+    }
+
+    /*****************************
+     * +-----------------------+ *
+     * |                       | *
+     * |  AHEAD: MOUNT CODE 1  | *
+     * |                       | *
+     * +-----------------------+ *
+     *****************************/
+
+    /* Find neighbors on this and the children's and the children's children's level */
+    nlset same_level_set;
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
+    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
+        octcell* n = node->v.n; // Neighbor
+        uint dim = node->v.dim;
+        bool pos_dir = node->v.pos_dir;
+        for (uint cidx = 0; cidx < MAX_NUM_CHILDREN; cidx++) { // Child index in this cell
+            if (positive_direction_of_child(cidx, dim) == pos_dir) {
+                /* Child index is in the right half */
+                if (has_child(cidx)) {
+                    /* Child exists, make neighbor */
+                    octcell* c = get_child(cidx); // Child
+                    if (n->has_child_array()) {
+                        make_neighbors(c, n, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
+                        /* Cell has children, see if there is a neighbor at the child level */
+                        uint ncidx = child_index_flip_direction(cidx, dim); // Neighbor child index
+                        if (n->has_child(ncidx)) {
+                            /* Neighbor cell on child level exists too, make neighbors */
+                            octcell* nc = n->get_child(ncidx); // Neighbor child
+                            if (nc->has_child_array()) {
+                                make_neighbors(c, nc, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
+                                /* Child cell has children too, see if any of these are neighbors */
+                                for (uint nccidx = 0; nccidx < MAX_NUM_CHILDREN; nccidx++) { // Neighbor child child index
+                                    if (positive_direction_of_child(nccidx, dim) != pos_dir) {
+                                        // Potential neighbor child child is in righ half, make neighbor
+                                        if (nc->has_child(nccidx)) {
+                                            // Cell exists, make neighbor
+                                            octcell* ncc = nc->get_child(nccidx);
+                                            make_neighbors(c, ncc, NL_HIGHER_LEVEL_OF_DETAIL, NL_LOWER_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
+                                        }
+                                    }
+                                } // for nccidx
+                            } // if nc->has_child_array()
+                            else {
+                                make_neighbors(c, nc, NL_SAME_LEVEL_OF_DETAIL_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
+                            }
+                        }
+
+                    } // if n->has_child_array()
+                    else {
+                        make_neighbors(c, n, NL_LOWER_LEVEL_OF_DETAIL_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
+                    }
+                } // if c
+            } // if child index is in right half
+        } // cidx
+        /* This cell is no longer a leaf cell, update other end of neighbor connection */
+        n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF);
+    } // node
+
+    /*
+     * This cell is no longer a leaf cell, update other end of the connections to
+     * the higher level
+     */
+    nlnode* node = neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node();
+    nlnode* next_node;
+    for (; node; node = next_node) {
+        next_node = node->get_next_node();
+        node->v.n->move_neighbor_connection_to_other_list(node->v.cnle, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF);
+    }
+
+    /*
+     * The higher level neighbors have already been updated in the code mountain
+     */
+
+    /*
+     * The lower level neighbors do not need to be updated, because they have only
+     * one list for cells at this level anyway
+     */
+
+    // Create all neighbor connections internally between the child cells
+    // Optimize
+    for (uint idx1 = 0; idx1 < MAX_NUM_CHILDREN; idx1++) {
+        for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+            uint idx2 = idx1 | child_index_offset(dim);
+            if (idx2 > idx1) {
+                make_neighbors(get_child(idx1), get_child(idx2), NL_SAME_LEVEL_OF_DETAIL_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, true);
+            }
+        }
+    }
+}
+
+void octcell::coarsen()
+{
+#if  DEBUG
+    /* This function will make the cell a leaf cell */
+    if (is_leaf()) {
+        throw logic_error("Trying to coarsen a leaf cell");
+    }
+#endif
+
+    water_vol_coeff = 0;
+    total_vol_coeff = 0;
+    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
+        if (has_child(idx)) {
+            /* Child exists, remove it */
+            octcell* c = get_child(idx);
+            if (c->has_child_array()) {
+                /* Coarsen it to get updated properties */
+                c->coarsen();
+            }
+            water_vol_coeff += c->water_vol_coeff;
+            total_vol_coeff += c->total_vol_coeff;
+            remove_child(idx);
+        }
+    }
+    water_vol_coeff *= (pftype(1)/MAX_NUM_CHILDREN);
+    total_vol_coeff *= (pftype(1)/MAX_NUM_CHILDREN);
+    make_leaf();
+}
+
+/*
+ * Whether the cell can be coarsened without getting leaf neighbors more than one
+ * level finer than itself: all of its children exist and are leaf cells, none of
+ * them has finer neighbors, and the neighbors at the level of the children are
+ * leaf cells.
+ */
+bool octcell::can_be_coarsened() const
+{
+    if (!has_child_array()) {
+        return false;
+    }
+    for (nlnode* node = neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node(); node; node = node->get_next_node()) {
+        if (!node->v.n->is_leaf()) {
+            return false;
+        }
+    }
+    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
+        if (!has_child(idx)) {
+            return false;
+        }
+        const octcell* c = get_child(idx);
+        if (!c->is_leaf() || c->neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL].get_first_node()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Refines a leaf cell while the water is being simulated. The coarser leaf neighbors
+ * are refined first (see refine_coarser_leaf_neighbors). The children get the volume
+ * coefficients and the cell-center velocity of the cell, so the water volume stays
+ * the same. A face of a child to a neighbor gets the
+ * velocity of the face of the cell it is part of, which keeps the volume fluxes, and a
+ * face between two children gets the mean of the velocities on the two sides of the
+ * cell. Returns the number of cells refined.
+ */
+uint octcell::refine_and_interpolate()
+{
+#if  DEBUG
+    if (!is_leaf()) {
+        throw logic_error("Trying to refine and interpolate a cell that is not a leaf cell");
+    }
+#endif
+    uint num_refined = 1 + refine_coarser_leaf_neighbors();
+
+    /* The mean velocity through each side of the cell */
+    pftype side_flow[NUM_DIMENSIONS][2];
+    pftype side_area[NUM_DIMENSIONS][2];
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        for (uint pos_dir = 0; pos_dir < 2; pos_dir++) {
+            side_flow[dim][pos_dir] = 0;
+            side_area[dim][pos_dir] = 0;
+        }
+    }
+    nlset lists;
+    add_leaf_neighbor_lists_to_list_set(lists);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        side_flow[node->v.dim][node->v.pos_dir] += node->v.f->vel * node->v.f->cf_area;
+        side_area[node->v.dim][node->v.pos_dir] += node->v.f->cf_area;
+    }
+    pftype side_vel[NUM_DIMENSIONS][2];
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        for (uint pos_dir = 0; pos_dir < 2; pos_dir++) {
+            /* No neighbor means a wall */
+            side_vel[dim][pos_dir] = 0;
+            if (side_area[dim][pos_dir]) {
+                side_vel[dim][pos_dir] = side_flow[dim][pos_dir] / side_area[dim][pos_dir];
+            }
+        }
+    }
+
+    refine();
+    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
+        octcell* c = get_child(idx);
+        c->set_volume_coefficients(water_vol_coeff, total_vol_coeff);
+        c->ccv = ccv;
+        c->momentum_to_distribute = pfvec();
+        nlset child_lists;
+        c->add_leaf_neighbor_lists_to_list_set(child_lists);
+        for (nlnode* cnode = child_lists.get_first_node(); cnode; cnode = child_lists.get_next_node()) {
+            octcell* n = cnode->v.n;
+            uint dim = cnode->v.dim;
+            bool pos_dir = cnode->v.pos_dir;
+            if (n->get_parent() == this) {
+                /* Between two children */
+                cnode->v.f->vel = (side_vel[dim][0] + side_vel[dim][1]) * 0.5;
+                continue;
+            }
+            cnode->v.f->vel = side_vel[dim][pos_dir];
+            for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+                if (node->v.dim == dim && node->v.pos_dir == pos_dir && (node->v.n == n || node->v.n == n->get_parent())) {
+                    cnode->v.f->vel = node->v.f->vel;
+                    break;
+                }
+            }
+        }
+    }
+    return num_refined;
+}
+
+/*
+ * Coarsens a cell whose children can be removed (see can_be_coarsened) while the water
+ * is being simulated. The cell gets the mean volume coefficients and cell-center velocity
+ * of the children, and a face of the cell to a neighbor gets the mean velocity of the
+ * faces of the children that it covers, weighted by their areas, which keeps the volume
+ * fluxes.
+ */
+void octcell::coarsen_and_average()
+{
+#if  DEBUG
+    if (!can_be_coarsened()) {
+        throw logic_error("Trying to coarsen and average a cell that can not be coarsened");
+    }
+#endif
+    pfvec mean_ccv;
+    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
+        mean_ccv += get_child(idx)->ccv;
+    }
+
+    /* The leaf neighbors of the cell once it is a leaf cell */
+    nlset lists;
+    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
+    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        pftype flow = 0;
+        pftype area = 0;
+        for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
+            nlset child_lists;
+            get_child(idx)->add_leaf_neighbor_lists_to_list_set(child_lists);
+            for (nlnode* cnode = child_lists.get_first_node(); cnode; cnode = child_lists.get_next_node()) {
+                if (cnode->v.n == node->v.n) {
+                    flow += cnode->v.f->vel * cnode->v.f->cf_area;
+                    area += cnode->v.f->cf_area;
+                }
+            }
+        }
+        if (area) {
+            node->v.f->vel = flow / area;
+        }
+    }
+#if  !USE_ARTIFICIAL_COMPRESSIBILITY
+    pftype mean_p = 0;
+    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
+        mean_p += get_child(idx)->p;
+    }
+#endif
+
+    coarsen();
+#if  USE_ARTIFICIAL_COMPRESSIBILITY
+    calculate_pressure();
+#else
+    p = mean_p * (pftype(1)/MAX_NUM_CHILDREN);
+#endif
+    ccv = mean_ccv * (pftype(1)/MAX_NUM_CHILDREN);
+    momentum_to_distribute = pfvec();
+}
+
+octcell* octcell::create_new_air_child(uint child_idx)
+{
+#if  DEBUG
+    if (!has_child_array()) {
+        throw logic_error("Trying to create a new air child in a cell without a child array");
+    }
+    if (child_idx < 0 || child_idx >= MAX_NUM_CHILDREN) {
+        throw out_of_range("Trying to create an air child with index out of bound");
+    }
+    if (has_child(child_idx)) {
+        throw logic_error("Trying to create a new air child that already exists");
+    }
+#endif
+    // Create child
+    octcell *child = create_child(child_idx);
+    child->set_volume_coefficients(0, 1);
+    topology_changed();
+
+    /* Create neighbor connections for new child */
+
+    /*****************************
+     * +-----------------------+ *
+     * |                       | *
+     * |  AHEAD: MOUNT CODE 2  | *
+     * |                       | *
+     * +-----------------------+ *
+     *****************************/
+
+    /* Find neighbors on this and the child's and the child's children's level */
+    nlset same_level_set;
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    same_level_set.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_NON_LEAF]);
+    for (nlnode* node = same_level_set.get_first_node(); node; node = same_level_set.get_next_node()) {
+        octcell* n = node->v.n; // Neighbor
+        uint dim = node->v.dim;
+        bool pos_dir = node->v.pos_dir;
+        if (positive_direction_of_child(child_idx, dim) == pos_dir) {
+            /* Child index is in the right half */
+            if (n->has_child_array()) {
+                make_neighbors(child, n, NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
+                /* Cell has children, see if there is a neighbor at the child level */
+                uint ncidx = child_index_flip_direction(child_idx, dim); // Neighbor child index
+                if (n->has_child(ncidx)) {
+                    /* Neighbor cell on child level exists too, make neighbors */
+                    octcell* nc = n->get_child(ncidx); // Neighbor child
+                    if (nc->has_child_array()) {
+                        make_neighbors(child, nc, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
+                        /* Child cell has children too, see if any of these are neighbors */
+                        for (uint nccidx = 0; nccidx < MAX_NUM_CHILDREN; nccidx++) { // Neighbor child child index
+                            if (positive_direction_of_child(nccidx, dim) != pos_dir) {
+                                // Potential neighbor child child is in righ half, make neighbor
+                                if (nc->has_child(nccidx)) {
+                                    // Cell exists, make neighbor
+                                    octcell* ncc = nc->get_child(nccidx);
+                                    make_neighbors(child, ncc, NL_HIGHER_LEVEL_OF_DETAIL, NL_LOWER_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
+                                }
+                            }
+                        } // for nccidx
+                    } // if nc->has_child_array()
+                    else {
+                        make_neighbors(child, nc, NL_SAME_LEVEL_OF_DETAIL_LEAF, NL_SAME_LEVEL_OF_DETAIL_LEAF, dim, pos_dir);
+                    }
+                }
+
+            } // if n->has_child_array()
+            else {
+                make_neighbors(child, n, NL_LOWER_LEVEL_OF_DETAIL_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, pos_dir);
+            }
+        } // if child index is in right half
+        /* This cell is no longer a leaf cell, update other end of neighbor connection */
+        n->move_neighbor_connection_to_other_list(node->v.cnle, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF);
+    } // node
+
+    // Create all neighbor connections internally between this child cell and other child cells that may exist
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        /* Get other child in this dimension */
+        uint other_child_idx = child_idx ^ child_index_offset(dim);
+        if (has_child(other_child_idx)) {
+            /* Child exists, make neighbors */
+            octcell *other_child = get_child(other_child_idx);
+            make_neighbors(child, other_child,
+                           other_child->has_child_array() ? NL_SAME_LEVEL_OF_DETAIL_NON_LEAF : NL_SAME_LEVEL_OF_DETAIL_LEAF,
+                           NL_SAME_LEVEL_OF_DETAIL_LEAF,
+                           dim, other_child_idx > child_idx);
+        }
+    }
+
+    return child;
+}
+
+void octcell::move_neighbor_connection_to_other_list(nlnode *node, uint new_list_index)
+{
+#if  DEBUG
+    if (new_list_index >= NUM_NEIGHBOR_LISTS) {
+        throw out_of_range("Trying to move node to list with invalid index");
+    }
+#endif
+    node->remove_from_list_and_keep();
+    neighbor_lists[new_list_index].add_existing_node(node);
+    leaf_neighbors_cached = false;
+}
+
+void octcell::break_all_neighbor_connections()
+{
+    for (uint i = 0; i < NUM_NEIGHBOR_LISTS; i++) {
+        nlnode* current_node;
+        nlnode* next_node;
+        for (current_node = neighbor_lists[i].get_first_node(); current_node; current_node = next_node) {
+            next_node = current_node->get_next_node();
+            un_neighbor(current_node);
+        }
+    }
+}
+
+/* Breaks the connections to the neighbors at the same level, but keeps those to the other levels */
+void octcell::break_same_level_neighbor_connections()
+{
+    const uint lists[2] = {NL_SAME_LEVEL_OF_DETAIL_LEAF, NL_SAME_LEVEL_OF_DETAIL_NON_LEAF};
+    for (uint i = 0; i < 2; i++) {
+        nlnode* current_node;
+        nlnode* next_node;
+        for (current_node = neighbor_lists[lists[i]].get_first_node(); current_node; current_node = next_node) {
+            next_node = current_node->get_next_node();
+            un_neighbor(current_node);
+        }
+    }
+}
+
+/*
+ * Connects the cell with a neighbor at the same level on its positive side, and all
+ * the cells below them that are neighbors across the face between them. This gives
+ * the same connections as if the cells had been refined while connected, so the
+ * cells below them can be built apart from each other first (see
+ * fvoctree::build_subtrees), though the connections do not come in the same order
+ * in the neighbor lists.
+ */
+void octcell::stitch_neighbors(octcell* neighbor, uint dim)
+{
+    bool parent  = has_child_array();
+    bool nparent = neighbor->has_child_array();
+    make_neighbors(this, neighbor,
+                   nparent ? NL_SAME_LEVEL_OF_DETAIL_NON_LEAF : NL_SAME_LEVEL_OF_DETAIL_LEAF,
+                   parent  ? NL_SAME_LEVEL_OF_DETAIL_NON_LEAF : NL_SAME_LEVEL_OF_DETAIL_LEAF,
+                   dim, true);
+    for (uint cidx = 0; cidx < MAX_NUM_CHILDREN; cidx++) { // Child index in this cell
+        if (!positive_direction_of_child(cidx, dim)) {
+            continue;
+        }
+        uint ncidx = child_index_flip_direction(cidx, dim); // Neighbor child index
+        octcell* c  = parent  && has_child(cidx)            ? get_child(cidx)            : 0;
+        octcell* nc = nparent && neighbor->has_child(ncidx) ? neighbor->get_child(ncidx) : 0;
+        if (c) {
+            make_neighbors(c, neighbor, nparent ? NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF : NL_LOWER_LEVEL_OF_DETAIL_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, true);
+        }
+        if (nc) {
+            make_neighbors(nc, this, parent ? NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF : NL_LOWER_LEVEL_OF_DETAIL_LEAF, NL_HIGHER_LEVEL_OF_DETAIL, dim, false);
+        }
+        if (c && nc) {
+            c->stitch_neighbors(nc, dim);
+        }
+    }
+}
+
+/* Flow */
+
+pftype octcell::get_velocity_divergence() const
+{
+    pftype div = 0;
+    /* Loop through neighbors */
+    nlset lists;
+    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
+    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        div += node->v.get_vel_out() * node->v.f->cf_area;
+    }
+    div /= get_cube_volume();
+    return div;
+}
+
+pftype octcell::get_water_flow_divergence() const
+{
+    pftype div = 0;
+    /* Loop through neighbors */
+    nlset lists;
+    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
+    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        div += node->v.get_vel_out() * node->v.f->water_vol_coeff * node->v.f->cf_area;
+    }
+    div /= get_cube_volume();
+    return div;
+}
+
+void octcell::prepare_for_water()
+{
+    /*
+     * This function takes care of:
+     *   1. Walls to cells with no water in them
+     *   2. Missing neighbors (create new ones)
+     */
+    pfvec mean_vel;
+    uint sides = get_sides_without_water(mean_vel);
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        for (uint pos_dir = 0; pos_dir < 2; pos_dir++) {
+            if (sides & (1 << (2*dim + pos_dir))) {
+                /* Needs new neighbors at this side */
+                /* Not guaranteed though that neighbors will be created; this may be a wall */
+                create_new_air_neighbors(dim, pos_dir);
+                //TODO:: Set velocities in faces to newly created cells
+            }
+        }
+    }
+    set_velocities_to_cells_without_water(mean_vel);
+}
+
+/*
+ * Calculates the mean velocity of the water around the cell, and returns the sides
+ * (bit 2*dim + pos_dir) that are not mostly covered by neighbors with water. Only
+ * reads the cell and its neighbors.
+ */
+uint octcell::get_sides_without_water(pfvec& mean_vel) const
+{
+    /* Calculate average velocity vector */
+    mean_vel = pfvec();
+    pfvec area[2];
+    uint sides = 0;
+    /* Loop though neighbors */
+    nlset lists;
+    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
+    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        if (node->v.n->has_water()) {
+            /* This velocity is relevant, use it to calculate mean velocity vector */
+            area[node->v.pos_dir].e[node->v.dim] += node->v.f->cf_area;
+            mean_vel.e[node->v.dim] += node->v.f->cf_area * node->v.get_signed_dir() * node->v.get_vel_out();
+        }
+    }
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        pftype dim_area = area[0].e[dim] + area[1].e[dim];
+        if (dim_area) {
+            mean_vel.e[dim] /= dim_area;
+        }
+        else {
+            /* Don't know the velocity in this direction */
+            // TODO: Find out the velocity in some other way
+            //mean_vel[dim] = 0; This componentis already 0
+        }
+        for (uint pos_dir = 0; pos_dir < 2; pos_dir++) {
+            if (area[pos_dir].e[dim] < (7.0/8) * get_side_area()) {
+                sides |= 1 << (2*dim + pos_dir);
+            }
+        }
+    }
+    return sides;
+}
+
+/* Creates the missing air cells next to the given side of the cell, down to the level of the cell */
+void octcell::create_new_air_neighbors(uint dim, bool pos_dir)
+{
+    pfvec neighbor_center = get_cell_center();
+    neighbor_center.e[dim] += (2*int(pos_dir) - 1) * get_edge_length();
+    create_new_air_neighbors(neighbor_center, dim, pos_dir, lvl);
+}
+
+/* Sets the velocities out of the cell through the faces to the neighbors without water */
+void octcell::set_velocities_to_cells_without_water(pfvec mean_vel)
+{
+    /* Set velocities on faces to empty cells */
+    /* Loop though neighbors */
+    nlset lists;
+    lists.add_neighbor_list(&neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]);
+    lists.add_neighbor_list(&neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]);
+    lists.add_neighbor_list(&neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        if (node->v.n->has_no_water()) {
+            /* The velocity out for this neighbor connection currently contains humbug, initialize it */
+            node->v.set_velocity_out(mean_vel[node->v.dim]*node->v.get_signed_dir());
+        }
+    }
+}
+
+/* new_cell tells that the cell has just been created on the way down to the neighbor, and has nothing in it to keep */
+void octcell::create_new_air_neighbors(pfvec neighbor_center, uint dim, bool pos_dir, uint source_level, bool new_cell)
+{
+#if 0
+    static int count = 0;
+    count++;
+    if (count == 16200) {
+        NO_OP();
+    }
+    cout << count << endl;
+#endif
+    if (inside_of_cell(neighbor_center)) {
+        /* Neighbor is in this cell */
+        if (is_fine_enough()) {
+            // All neighbors created
+            return;
+        }
+        /* Cell is not fine enough */
+        if (is_leaf()) {
+            if (new_cell) {
+                refine_coarser_leaf_neighbors();
+                make_parent();
+            }
+            else {
+                /* A cell that has been coarsened (see watersystem::regrid), whose water and air must stay in its children */
+                refine_and_interpolate();
+            }
+        }
+        if (lvl < source_level) {
+            /* The cell who wants the nieghbors is at a higher level, find the one neighboring child */
+            uint child_idx = get_child_index_from_position(neighbor_center);
+            bool new_child = !has_child(child_idx);
+            if (new_child) {
+                create_new_air_child(child_idx);
+            }
+            get_child(child_idx)->create_new_air_neighbors(neighbor_center, dim, pos_dir, source_level, new_child);
+        }
+        else {
+            /* The cell who wants the neighbors is not at a higher level and therefore neighbor to half of this cell's children */
+            for (uint child_idx = 0; child_idx < MAX_NUM_CHILDREN; child_idx++) {
+                if (positive_direction_of_child(child_idx, dim) != pos_dir) {
+                    /* Child cell is in the right half */
+                    octcell *child;
+                    if (!has_child(child_idx)) {
+                        child = create_new_air_child(child_idx);
+                    }
+                    else {
+                        child = get_child(child_idx);
+                    }
+                    //child->create_new_air_neighbors(child->get_cell_center(), dim, pos_dir, source_level);
+                }
+            }
+        }
+    }
+#if  OCTREE_BACKEND == LINEAR_OCTREE
+    else {
+        /* Neighbor is outside of this cell, look up the smallest cell containing it instead of walking up */
+#if  DEBUG
+        if (lvl != source_level) {
+            throw logic_error("Trying to create new air neighbors for another cell through the Morton index");
+        }
+#endif
+        octcell* n = _tree->find_neighbor(this, dim, pos_dir);
+        if (n) {
+            n->create_new_air_neighbors(neighbor_center, dim, pos_dir, source_level);
+        }
+        else {
+            /* Neighbor is outside of root cell */
+            // TODO: Create water outside of root cell
+        }
+    }
+#else
+    else if (has_parent()) {
+        /* Neighbor is outside of this cell */
+        /* Must step up one level to get to position */
+        get_parent()->create_new_air_neighbors(neighbor_center, dim, pos_dir, source_level);
+    }
+    else {
+        /* Neighbor is outside of root cell (this cell) */
+        // TODO: Create water outside of root cell
+    }
+#endif
+}
+
+void octcell::add_leaf_neighbor_lists_to_list_set(nlset &lists)
+{
+    lists.add_neighbor_list(&(neighbor_lists[NL_HIGHER_LEVEL_OF_DETAIL]));
+    lists.add_neighbor_list(&(neighbor_lists[NL_SAME_LEVEL_OF_DETAIL_LEAF]));
+    lists.add_neighbor_list(&(neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF]));
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+void octcell::make_neighbors(octcell* cell1, octcell* cell2, uint cell1_neighbor_list_idx, uint cell2_neighbor_list_idx, uint dimension, bool pos_dir)
+{
+#if  DEBUG
+    if (!(cell1 && cell2)) {
+        throw logic_error("Trying to make a cell neighbor using a null pointer");
+    }
+    if (cell1 == cell2) {
+        throw logic_error("Trying to make a cell neighbor with itself");
+    }
+    if (cell1_neighbor_list_idx >= NUM_NEIGHBOR_LISTS || cell2_neighbor_list_idx >= NUM_NEIGHBOR_LISTS) {
+        throw out_of_range("Neighbor list index doesn't exist");
+    }
+    if ((cell1_neighbor_list_idx == NL_HIGHER_LEVEL_OF_DETAIL) && (cell2_neighbor_list_idx == NL_HIGHER_LEVEL_OF_DETAIL)) {
+        throw logic_error("Error when making neighbors: Both cells are claimed to be on the higher level");
+    }
+    if (((cell1_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_LEAF) ||
+         (cell1_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_NON_LEAF)) !=
+        ((cell2_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_LEAF) ||
+         (cell2_neighbor_list_idx == NL_SAME_LEVEL_OF_DETAIL_NON_LEAF)) ) {
+        throw logic_error("Error when making neighbors: One cell is at the same level as the other cell but the other cell is not at the same level as the first cell");
+    }
+    if (((cell1_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_LEAF) ||
+         (cell1_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF)) &&
+        ((cell2_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_LEAF) ||
+         (cell2_neighbor_list_idx == NL_LOWER_LEVEL_OF_DETAIL_NON_LEAF)) ) {
+        throw logic_error("Error when making neighbors: Both cells are claimed to be on the lower level");
+    }
+#endif
+    /* Create elements to work with */
+    nlpool& pool = cell1->_tree->neighbor_nodes;
+    nlnode* node1 = cell1->neighbor_lists[cell1_neighbor_list_idx].add_existing_node(pool.create());
+    nlnode* node2 = cell2->neighbor_lists[cell2_neighbor_list_idx].add_existing_node(pool.create());
+    /* Calculate properties */
+    pfvec dist = cell2->get_cell_center() - cell1->get_cell_center();
+    if (!pos_dir) {
+        dist = -dist;
+    }
+    pftype dist_abs = dist.length();
+    pftype area = levelgeometry::side_area(MAX(cell1->lvl, cell2->lvl));
+    /* The distance between the cell centers along the face normal */
+    pftype normal_dist = levelgeometry::half_edge_length(cell1->lvl) + levelgeometry::half_edge_length(cell2->lvl);
+    /* Create the shared face, seen from the cell on its negative side */
+    octface* f = cell1->_tree->faces.create();
+    f->set(dimension, normal_dist, dist[VERTICAL_DIMENSION]/dist_abs * P_G, area);
+    /* Set properties */
+    node1->v.set(cell2, node2, dimension,  pos_dir, f);
+    node2->v.set(cell1, node1, dimension, !pos_dir, f);
+    cell1->leaf_neighbors_cached = false;
+    cell2->leaf_neighbors_cached = false;
+}
+
+/* Gives the cell a sibling block without any children in it */
+void octcell::create_new_empty_child_array()
+{
+#if  DEBUG
+    if (has_child_array()) {
+        throw logic_error("Trying to create child array for a cell that already has one");
+    }
+#endif
+    _c = _tree->cells.create_block();
+    _cm = 0;
+}
+
+void octcell::delete_child_array()
+{
+    _tree->cells.release_block(_c);
+    _c = 0;
+    _cm = 0;
+    /* The cell has not been a leaf in the leaf store since it last became a parent */
+    leaf_neighbors_cached = false;
+}
+
+/* Constructs a child in its place in the sibling block */
+octcell* octcell::create_child(uint idx)
+{
+#if  DEBUG
+    if (is_leaf()) {
+        throw logic_error("Trying to create a child for a leaf cell");
+    }
+    if (idx >= MAX_NUM_CHILDREN) {
+        throw out_of_range("Trying to create a child with an index that is too high");
+    }
+#endif
+    ivec child_ri;
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        child_ri[dim] = 2*ri[dim] + int((idx >> dim) & 1);
+    }
+    octcell* child = new (&_c[idx]) octcell(_tree, this, child_ri, lvl + 1);
+    child->key = morton::child_key(key, idx);
+    _cm |= 1 << idx;
+#if  OCTREE_BACKEND == LINEAR_OCTREE
+    _tree->index.insert(child->key, child);
+#endif
+    return child;
+}
+
+void octcell::delete_child(uint idx)
+{
+#if  OCTREE_BACKEND == LINEAR_OCTREE
+    if (!_tree->is_being_destroyed()) {
+        _tree->index.erase(_c[idx].key);
+    }
+#endif
+    _c[idx].~octcell();
+    _cm &= ~(1 << idx);
+}
+
+/*
+ * Lets the tree know that cells or neighbor connections have been added or removed,
+ * so that flat views of the leaf cells are rebuilt before they are used again
+ */
+void octcell::topology_changed()
+{
+    if (_tree) {
+        _tree->topology_changed();
+    }
+}
+
+/*
+ * Refines the coarser leaf neighbors of a leaf cell that is about to get children, since the
+ * neighbor lists only hold cells within one level of each other. A tree built to the size
+ * accuracy has none, but the cells that have been coarsened may be such neighbors (see
+ * watersystem::regrid). Returns the number of cells refined.
+ */
+uint octcell::refine_coarser_leaf_neighbors()
+{
+    octcell* coarser[2*NUM_DIMENSIONS];
+    uint num_coarser = 0;
+    for (nlnode* node = neighbor_lists[NL_LOWER_LEVEL_OF_DETAIL_LEAF].get_first_node(); node; node = node->get_next_node()) {
+        coarser[num_coarser++] = node->v.n;
+    }
+    uint num_refined = 0;
+    for (uint i = 0; i < num_coarser; i++) {
+        if (coarser[i]->is_leaf()) {
+            num_refined += coarser[i]->refine_and_interpolate();
+        }
+    }
+    return num_refined;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*************
+ * Neighbors *
+ *************/
+
+void octcell::un_neighbor(nlnode* list_entry)
+{
+    fvoctree* tree = list_entry->v.n->_tree;
+    list_entry->v.n->leaf_neighbors_cached = false;
+    list_entry->v.cnle->v.n->leaf_neighbors_cached = false;
+    tree->faces.release(list_entry->v.f);
+    tree->neighbor_nodes.release(list_entry->v.cnle->remove_from_list_and_keep());
+    tree->neighbor_nodes.release(list_entry->remove_from_list_and_keep());
+}
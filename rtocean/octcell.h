@@ -1,577 +1,558 @@
-#ifndef OCTCELL_H
-#define OCTCELL_H
-
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-// Standard includes
-#include <stdexcept>
-using std::exception;
-using std::logic_error;
-using std::out_of_range;
-
-// Own includes
-#include "definitions.h"
-#include "nlset.h"
-#include "physics.h"
-
-////////////////////////////////////////////////////////////////
-// CLASS DEFINITION
-////////////////////////////////////////////////////////////////
-
-/*
- * The indexes of the children cells (if existing) are calculated
- * as 1*ix + 2*iy + 4*iz, where ix, iy and iz are either 0 or 1
- * depending on the relative (to the parent cell) x, y and z
- * positions respectivelly.
- */
-class octcell
-{
-public:
-    static const uint MAX_NUM_CHILDREN = 1 << NUM_DIMENSIONS;
-    //static const uint MAX_NUM_NEIGHBORS_ON_ONE_SIDE = MAX_NUM_CHILDREN/2;
-public:
-    /*******************************
-     * Constructors and destructor *
-     *******************************/
-    octcell(octcell *parent, pftype size, pfvec pos, uint level, uint internal_layer_advancement = 0);
-    ~octcell();
-
-public:
-    /***************************
-     * Public member variables *
-     ***************************/
-
-    /* Family */
-#if  DEBUG && CHECK_INITIALIZATION_OF_FLOATS
-    mustinit<octcell*> _par; /* Parent cell*/
-    mustinit<mustinit<octcell*>*> _c; /* The possible children */
-#else
-    octcell* _par; /* Parent cell*/
-    octcell** _c; /* The possible children */
-#endif
-
-    /* Geometry */
-    // The cell is a cube with size s and the first corner in r
-    pftype s; /* Size of the cell (the length of an edge) */
-    pfvec  r; /* Position of the first corner */
-
-    /* Navier-Stokes */
-    pftype p; /* Reduced pressure = pressure/density */
-    pfvec  ccv; /* [m/s] Cell-center velocity */
-    pfvec  momentum_to_distribute; /* [kg*m/s] Net in momentum flux */
-    /*Since the velocities are located in the cell faces, they are stored in the octneighbors */
-
-    /* Volume of fluid */
-    pftype water_vol_coeff; /* [1] The volume the water in this cell would occupy at NORMAL_AIR_PRESSURE divided by the volume of the cell */
-    pftype total_vol_coeff; /* [1] The volume the water and the air in this cell would occupy at NORMAL_AIR_PRESSURE divided by the volume of the cell (should stay relatively close to 1) */
-
-    /* Advection of momentum */
-
-    /* Level of detail */
-    uint lvl; /* The level of the cell, 0 = root */
-    //uint ila; /* Internal layer advancement, the advancement of the cell in the layer in terms of cells: 1, 2, ..., t_n (0 = unknown) */
-    //bool changed; /* Whether the ila has changed since last update or not */
-
-    /* Neighbors */
-    //nlist leaf_neighbor_list; /* Lists all leaf neighbors. This list is empty if this is a parent cell. */
-    //nlist coarse_neighbor_list; /* These connections are between cells on the same level and involves at least one non-leaf cell. */
-    /*
-     * This array contains neighbor lists that together contain all neighbors, leaf cell and parent cells,
-     * that differ no more than one level of detail from this cell
-     */
-    nlist neighbor_lists[NUM_NEIGHBOR_LISTS];
-
-public:
-    /*****************************
-     * Public non-static methods *
-     *****************************/
-
-    /* Geometry */
-    pfvec  get_cell_center() const;
-    pfvec  get_opposite_corner() const;
-    pftype get_edge_length() const;
-    pftype get_side_area() const;
-    pftype get_cube_volume() const;
-    pftype get_density() const;
-    uint   get_child_index_from_position(pfvec pos) const;
-    bool   outside_of_cell(pfvec pos) const;
-    bool   inside_of_cell(pfvec pos) const;
-    bool   is_fine_enough() const;
-
-    /* Simulation */
-    bool has_no_air() const;
-    bool has_air() const;
-    bool has_no_water() const;
-    bool has_water() const;
-    bool has_no_fluid() const;
-    bool has_fluid() const;
-    bool is_mixed_cell() const;
-    pftype get_air_volume_coefficient() const;
-    pftype get_alpha() const;
-    pftype get_safe_alpha() const;
-    pftype get_water_volume() const;
-    pftype get_total_fluid_volume() const;
-    void set_volume_coefficients(pftype water_volume_coefficient, pftype total_volume_coefficient);
-    void calculate_pressure();
-    void prepare_for_water();
-    void create_new_air_neighbors(pfvec neighbor_center, uint dim, bool pos_dir, uint source_level);
-    void add_leaf_neighbor_lists_to_list_set(nlset &lists);
-
-    /* Differentiation */
-    pftype get_velocity_divergence() const;
-    pftype get_water_flow_divergence() const;
-
-    /* Level of detail */
-
-    /* Family */
-    bool has_parent() const;
-    bool is_root() const;
-    bool has_child_array() const;
-    bool is_leaf() const;
-    bool has_child(uint idx) const;
-    void make_parent();
-    void make_leaf();
-    octcell* get_parent() const;
-    octcell* get_child(uint idx) const;
-    octcell* set_child(uint idx, octcell *child);
-    uint get_number_of_children() const;
-    void refine(); // Creates a new full child array
-    void coarsen(); // Decreases the level of detail to this level by removing the children and the child array
-    octcell *create_new_air_child(uint child_idx);
-    void remove_child(uint child_idx);
-
-    /* Neighbors */
-    void move_neighbor_connection_to_other_list(nlnode *node, uint new_list_index);
-    void break_all_neighbor_connections();
-
-public:
-    /*************************
-     * Public static methods *
-     *************************/
-    /* Neighbors */
-
-    /* Indexes */
-#if  NUM_DIMENSIONS == 2
-    static uint child_index(uint dim0, uint dim1);
-    static uint child_index_xy(uint x, uint y);
-#elif  NUM_DIMENSIONS == 3
-    static uint child_index(uint dim0, uint dim1, uint dim2);
-    static uint child_index_xyz(uint x, uint y, uint z);
-#endif
-    static uint child_index_offset(uint dim);
-    static bool positive_direction_of_child(uint child_index, uint dim);
-    static uint child_index_flip_direction(uint child_index, uint dim);
-    static pftype cube_side_area(pftype side_length);
-    static pftype cube_volume(pftype side_length);
-
-private:
-    /******************************
-     * Private non-static methods *
-     ******************************/
-void make_neighbors(octcell* cell1, octcell* cell2, uint cell1_neighbor_list_idx, uint cell2_neighbor_list_idx, uint dimension, bool pos_dir);
-void _create_new_random_child_array();
-void create_new_empty_child_array();
-
-private:
-    /**************************
-     * Private static methods *
-     **************************/
-static void un_neighbor(nlnode* list_entry);
-static pftype size_accuracy(pfvec r);
-
-private:
-    /*************************
-     * Disabled constructors *
-     *************************/
-    octcell(); // Default constructor prevented from all use
-    octcell(octcell&); // Copy constructor prevented from all use
-};
-
-////////////////////////////////////////////////////////////////
-// INLINE NON-STATIC MEMBER FUNCTIONS
-////////////////////////////////////////////////////////////////
-
-/************
- * Geometry *
- ************/
-
-inline
-pfvec octcell::get_cell_center() const
-{
-    pftype s_2 = 0.5 * s;
-    pfvec center = r;
-    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-        center[dim] += s_2;
-    }
-    return center;
-}
-
-inline
-pfvec octcell::get_opposite_corner() const
-{
-    pfvec corner = r;
-    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-        corner[dim] += s;
-    }
-    return corner;
-}
-
-inline
-pftype octcell::get_edge_length() const
-{
-    return s;
-}
-
-inline
-pftype octcell::get_side_area() const
-{
-    return cube_side_area(s);
-}
-
-inline
-pftype octcell::get_cube_volume() const
-{
-    return cube_volume(s);
-}
-
-inline
-pftype octcell::get_density() const
-{
-    return physics::vol_coeffs_to_density(water_vol_coeff, total_vol_coeff);
-}
-
-inline
-uint octcell::get_child_index_from_position(pfvec pos) const
-{
-#if  DEBUG
-    if (outside_of_cell(pos)) {
-        // Note that all positions are float values and just roughly correct; they should not lie close to cell sides
-        throw logic_error("Trying to get child index from a position that is outside of cell");
-    }
-#endif
-    uint idx = 0;
-    pftype s_2 = s/2;
-    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-        if (pos[dim] > r[dim] + s_2) {
-            idx += (1 << dim);
-        }
-    }
-    return idx;
-}
-
-inline
-bool octcell::outside_of_cell(pfvec pos) const
-{
-    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-        if (pos[dim] < r[dim] || pos[dim] >= r[dim] + s) {
-            return true;
-        }
-    }
-    return false;
-}
-
-inline
-bool octcell::inside_of_cell(pfvec pos) const
-{
-    return !outside_of_cell(pos);
-}
-
-inline
-bool octcell::is_fine_enough() const
-{
-    return s <= size_accuracy(get_cell_center());
-}
-
-/**************
- * Simulation *
- **************/
-
-inline
-bool octcell::has_no_air() const
-{
-    return water_vol_coeff >= total_vol_coeff;
-}
-
-inline
-bool octcell::has_air() const
-{
-    return water_vol_coeff < total_vol_coeff;
-}
-
-inline
-bool octcell::has_no_water() const
-{
-    return water_vol_coeff <= 0;
-}
-
-inline
-bool octcell::has_water() const
-{
-    return water_vol_coeff > 0;
-}
-
-inline
-bool octcell::has_no_fluid() const
-{
-    return total_vol_coeff <= 0;
-}
-
-inline
-bool octcell::has_fluid() const
-{
-    return total_vol_coeff > 0;
-}
-
-inline
-bool octcell::is_mixed_cell() const
-{
-    return has_air() && has_water();
-}
-
-inline
-pftype octcell::get_air_volume_coefficient() const
-{
-    return total_vol_coeff - water_vol_coeff;
-}
-
-inline
-pftype octcell::get_alpha() const
-{
-    return water_vol_coeff/total_vol_coeff;
-}
-
-inline
-pftype octcell::get_safe_alpha() const
-{
-    if (total_vol_coeff) {
-        return water_vol_coeff/total_vol_coeff;
-    }
-    else {
-        return 0;
-    }
-}
-
-inline
-pftype octcell::get_water_volume() const
-{
-    return water_vol_coeff * get_cube_volume();
-}
-
-inline
-pftype octcell::get_total_fluid_volume() const
-{
-    return total_vol_coeff * get_cube_volume();
-}
-
-/************
- * Children *
- ************/
-
-inline
-bool octcell::has_parent() const
-{
-    return _par;
-}
-
-inline
-bool octcell::is_root() const
-{
-    return !has_parent();
-}
-
-inline
-bool octcell::has_child_array() const
-{
-    return _c;
-}
-
-inline
-bool octcell::is_leaf() const
-{
-    return !has_child_array();
-}
-
-inline
-bool octcell::has_child(uint idx) const
-{
-#if  DEBUG
-    if (is_leaf()) {
-        throw logic_error("Trying to check if a leaf cell has a child by looking up an index");
-    }
-    if (idx >= MAX_NUM_CHILDREN) {
-        throw out_of_range("Trying to check if a cell has a child by looking up an index that is too high");
-    }
-#endif
-    return _c[idx];
-}
-
-inline
-void octcell::_create_new_random_child_array()
-{
-#if  DEBUG
-    if (has_child_array()) {
-        throw logic_error("Trying to create child array for a cell that already has one");
-    }
-#endif
-    // Create child array
-#if  DEBUG && CHECK_INITIALIZATION_OF_FLOATS
-    _c = new mustinit<octcell*>[MAX_NUM_CHILDREN];
-#else
-    _c = new octcell*[MAX_NUM_CHILDREN];
-#endif
-}
-
-inline
-void octcell::create_new_empty_child_array()
-{
-    _create_new_random_child_array();
-    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
-        set_child(idx, 0);
-    }
-}
-
-inline
-octcell* octcell::get_parent() const
-{
-#if  DEBUG
-    if (is_root()) {
-        throw logic_error("Trying to get parent from root cell");
-    }
-#endif
-    return _par;
-}
-
-inline
-octcell* octcell::set_child(uint idx, octcell *child)
-{
-#if  DEBUG
-    if (is_leaf()) {
-        throw logic_error("Trying to set a child for a leaf cell");
-    }
-    if (idx >= MAX_NUM_CHILDREN) {
-        throw out_of_range("Trying to get a child with an index that is too high");
-    }
-#endif
-    return _c[idx] = child;
-}
-
-inline
-uint octcell::get_number_of_children() const
-{
-#if  DEBUG
-    if (is_leaf()) {
-        throw logic_error("Trying to get number of children for a leaf cell");
-    }
-#endif
-    uint num = 0;
-    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
-        if (has_child(idx)) {
-            num++;
-        }
-    }
-    return num;
-}
-
-inline
-void octcell::remove_child(uint child_idx)
-{
-    octcell* c = get_child(child_idx);
-#if  DEBUG
-    if (is_leaf()) {
-        throw logic_error("Trying to remove a child cell from a leaf cell");
-    }
-    if (child_idx < 0 || child_idx >= MAX_NUM_CHILDREN) {
-        throw out_of_range("Trying to remove a child cell with index out of bound");
-    }
-    if (!c) {
-        throw logic_error("Trying to remove a child cell that does not exist");
-    }
-#endif
-
-    /* Remove child */
-    delete c;
-    set_child(child_idx, 0);
-}
-
-////////////////////////////////////////////////////////////////
-// INLINE STATIC MEMBER FUNCTIONS
-////////////////////////////////////////////////////////////////
-
-/*************
- * Neighbors *
- *************/
-
-inline
-void octcell::un_neighbor(nlnode* list_entry)
-{
-    list_entry->v.cnle->remove_from_list_and_delete();
-    list_entry->remove_from_list_and_delete();
-}
-
-/***********
- * Indexes *
- ***********/
-
-inline
-#if  NUM_DIMENSIONS == 2
-uint octcell::child_index(uint dim0, uint dim1)
-#elif  NUM_DIMENSIONS == 3
-uint octcell::child_index(uint dim0, uint dim1, uint dim2)
-#endif
-{
-#if    NUM_DIMENSIONS == 2
-    return (dim0 << 0) | (dim1 << 1);
-#elif  NUM_DIMENSIONS == 3
-    return (dim0 << 0) | (dim1 << 1) | (dim2 << 2);
-#endif
-}
-
-inline
-#if  NUM_DIMENSIONS == 2
-uint octcell::child_index_xy(uint x, uint y)
-#elif  NUM_DIMENSIONS == 3
-uint octcell::child_index_xyz(uint x, uint y, uint z)
-#endif
-{
-#if    NUM_DIMENSIONS == 2
-    return (x << DIM_X) | (y << DIM_Y);
-#elif  NUM_DIMENSIONS == 3
-    return (x << DIM_X) | (y << DIM_Y) | (z << DIM_Z);
-#endif
-}
-
-inline
-uint octcell::child_index_offset(uint dim)
-{
-    return 1 << dim;
-}
-
-inline
-bool octcell::positive_direction_of_child(uint child_index, uint dim)
-{
-    return (child_index >> dim) & 1;
-}
-
-inline
-uint octcell::child_index_flip_direction(uint child_index, uint dim)
-{
-    return child_index ^ (1 << dim);
-}
-
-/* Geometry */
-
-inline
-pftype octcell::cube_side_area(pftype side_length)
-{
-    return inline_int_pow(side_length, NUM_DIMENSIONS-1);
-}
-
-inline
-pftype octcell::cube_volume(pftype side_length)
-{
-    return inline_int_pow(side_length, NUM_DIMENSIONS);
-}
-
-#endif // OCTCELL_H
+#ifndef OCTCELL_H
+#define OCTCELL_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::exception;
+using std::logic_error;
+using std::out_of_range;
+
+// Own includes
+#include "definitions.h"
+#include "nlset.h"
+#include "physics.h"
+#include "morton.h"
+#include "levelgeometry.h"
+
+////////////////////////////////////////////////////////////////
+// PREDECLARATIONS
+////////////////////////////////////////////////////////////////
+
+class fvoctree;
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * The indexes of the children cells (if existing) are calculated
+ * as 1*ix + 2*iy + 4*iz, where ix, iy and iz are either 0 or 1
+ * depending on the relative (to the parent cell) x, y and z
+ * positions respectivelly.
+ */
+class octcell
+{
+public:
+    static const uint MAX_NUM_CHILDREN = 1 << NUM_DIMENSIONS;
+    //static const uint MAX_NUM_NEIGHBORS_ON_ONE_SIDE = MAX_NUM_CHILDREN/2;
+public:
+    /*******************************
+     * Constructors and destructor *
+     *******************************/
+    octcell(fvoctree *tree, octcell *parent, ivec position, uint level, uint internal_layer_advancement = 0);
+    ~octcell();
+
+public:
+    /***************************
+     * Public member variables *
+     ***************************/
+
+    /* Family */
+#if  DEBUG && CHECK_INITIALIZATION_OF_FLOATS
+    mustinit<octcell*> _par; /* Parent cell*/
+    mustinit<octcell*> _c; /* The sibling block with the possible children, allocated from the tree's cell arena */
+#else
+    octcell* _par; /* Parent cell*/
+    octcell* _c; /* The sibling block with the possible children, allocated from the tree's cell arena */
+#endif
+    uint8 _cm; /* Child mask, bit i is set if child i exists (the other cells in the sibling block are holes) */
+    fvoctree* _tree; /* The tree the cell belongs to */
+
+    /* Geometry */
+    // The cell is a cube with the edge length of its level and the first corner in ri times that length
+    ivec ri; /* Integer coordinates of the first corner on the lattice of the cell's level */
+
+    /* Navier-Stokes */
+    pftype p; /* Reduced pressure = pressure/density */
+    pfvec  ccv; /* [m/s] Cell-center velocity */
+    pfvec  momentum_to_distribute; /* [kg*m/s] Net in momentum flux */
+    /*Since the velocities are located in the cell faces, they are stored in the octfaces */
+
+    /* Volume of fluid */
+    pftype water_vol_coeff; /* [1] The volume the water in this cell would occupy at NORMAL_AIR_PRESSURE divided by the volume of the cell */
+    pftype total_vol_coeff; /* [1] The volume the water and the air in this cell would occupy at NORMAL_AIR_PRESSURE divided by the volume of the cell (should stay relatively close to 1) */
+
+    /* Advection of momentum */
+
+    /* Level of detail */
+    uint lvl; /* The level of the cell, 0 = root */
+    uint64 key; /* Morton key of the cell, see morton.h */
+
+    /* Leaf store */
+    uint li; /* Index of the cell in the tree's leaf store (only valid for leaf cells while the store is up to date) */
+    bool leaf_neighbors_cached; /* Whether the cell's span of leaf neighbors in the leaf store still matches its leaf neighbor lists */
+    //uint ila; /* Internal layer advancement, the advancement of the cell in the layer in terms of cells: 1, 2, ..., t_n (0 = unknown) */
+    //bool changed; /* Whether the ila has changed since last update or not */
+
+    /* Neighbors */
+    //nlist leaf_neighbor_list; /* Lists all leaf neighbors. This list is empty if this is a parent cell. */
+    //nlist coarse_neighbor_list; /* These connections are between cells on the same level and involves at least one non-leaf cell. */
+    /*
+     * This array contains neighbor lists that together contain all neighbors, leaf cell and parent cells,
+     * that differ no more than one level of detail from this cell
+     */
+    nlist neighbor_lists[NUM_NEIGHBOR_LISTS];
+
+public:
+    /*****************************
+     * Public non-static methods *
+     *****************************/
+
+    /* Geometry */
+    pfvec  get_corner() const;
+    pfvec  get_cell_center() const;
+    pfvec  get_opposite_corner() const;
+    pftype get_edge_length() const;
+    pftype get_side_area() const;
+    pftype get_cube_volume() const;
+    pftype get_density() const;
+    uint   get_child_index_from_position(pfvec pos) const;
+    bool   outside_of_cell(pfvec pos) const;
+    bool   inside_of_cell(pfvec pos) const;
+    bool   is_fine_enough() const;
+
+    /* Simulation */
+    bool has_no_air() const;
+    bool has_air() const;
+    bool has_no_water() const;
+    bool has_water() const;
+    bool has_no_fluid() const;
+    bool has_fluid() const;
+    bool is_mixed_cell() const;
+    pftype get_air_volume_coefficient() const;
+    pftype get_alpha() const;
+    pftype get_safe_alpha() const;
+    pftype get_water_volume() const;
+    pftype get_total_fluid_volume() const;
+    void set_volume_coefficients(pftype water_volume_coefficient, pftype total_volume_coefficient, bool update_pressure = true);
+    void calculate_pressure();
+    void prepare_for_water();
+    uint get_sides_without_water(pfvec& mean_vel) const;
+    void create_new_air_neighbors(uint dim, bool pos_dir);
+    void create_new_air_neighbors(pfvec neighbor_center, uint dim, bool pos_dir, uint source_level, bool new_cell = false);
+    void set_velocities_to_cells_without_water(pfvec mean_vel);
+    void add_leaf_neighbor_lists_to_list_set(nlset &lists);
+
+    /* Differentiation */
+    pftype get_velocity_divergence() const;
+    pftype get_water_flow_divergence() const;
+
+    /* Level of detail */
+
+    /* Family */
+    bool has_parent() const;
+    bool is_root() const;
+    bool has_child_array() const;
+    bool is_leaf() const;
+    bool has_child(uint idx) const;
+    void make_parent();
+    void make_leaf();
+    octcell* get_parent() const;
+    octcell* get_child(uint idx) const;
+    uint get_number_of_children() const;
+    void refine(); // Creates a new full child array
+    void coarsen(); // Decreases the level of detail to this level by removing the children and the child array
+    bool can_be_coarsened() const;
+    uint refine_and_interpolate(); // Refines a leaf cell of the simulated water, see octcell.cpp
+    void coarsen_and_average(); // Coarsens a cell of the simulated water, see octcell.cpp
+    octcell *create_new_air_child(uint child_idx);
+    void remove_child(uint child_idx);
+
+    /* Neighbors */
+    void move_neighbor_connection_to_other_list(nlnode *node, uint new_list_index);
+    void break_all_neighbor_connections();
+    void break_same_level_neighbor_connections();
+    void stitch_neighbors(octcell* neighbor, uint dim);
+
+public:
+    /*************************
+     * Public static methods *
+     *************************/
+    /* Neighbors */
+
+    /* Indexes */
+#if  NUM_DIMENSIONS == 2
+    static uint child_index(uint dim0, uint dim1);
+    static uint child_index_xy(uint x, uint y);
+#elif  NUM_DIMENSIONS == 3
+    static uint child_index(uint dim0, uint dim1, uint dim2);
+    static uint child_index_xyz(uint x, uint y, uint z);
+#endif
+    static uint child_index_offset(uint dim);
+    static bool positive_direction_of_child(uint child_index, uint dim);
+    static uint child_index_flip_direction(uint child_index, uint dim);
+    static pftype cube_side_area(pftype side_length);
+    static pftype cube_volume(pftype side_length);
+
+private:
+    /******************************
+     * Private non-static methods *
+     ******************************/
+void make_neighbors(octcell* cell1, octcell* cell2, uint cell1_neighbor_list_idx, uint cell2_neighbor_list_idx, uint dimension, bool pos_dir);
+void create_new_empty_child_array();
+void delete_child_array();
+octcell* create_child(uint idx);
+void delete_child(uint idx);
+void topology_changed();
+uint refine_coarser_leaf_neighbors();
+
+private:
+    /**************************
+     * Private static methods *
+     **************************/
+static void un_neighbor(nlnode* list_entry);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    octcell(); // Default constructor prevented from all use
+    octcell(octcell&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// INLINE NON-STATIC MEMBER FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+/************
+ * Geometry *
+ ************/
+
+/* The position of the first corner */
+inline
+pfvec octcell::get_corner() const
+{
+    return pfvec(ri) * levelgeometry::edge_length(lvl);
+}
+
+inline
+pfvec octcell::get_cell_center() const
+{
+    pftype s_2 = levelgeometry::half_edge_length(lvl);
+    pfvec center = get_corner();
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        center[dim] += s_2;
+    }
+    return center;
+}
+
+inline
+pfvec octcell::get_opposite_corner() const
+{
+    pftype s = levelgeometry::edge_length(lvl);
+    pfvec corner = get_corner();
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        corner[dim] += s;
+    }
+    return corner;
+}
+
+inline
+pftype octcell::get_edge_length() const
+{
+    return levelgeometry::edge_length(lvl);
+}
+
+inline
+pftype octcell::get_side_area() const
+{
+    return levelgeometry::side_area(lvl);
+}
+
+inline
+pftype octcell::get_cube_volume() const
+{
+    return levelgeometry::cube_volume(lvl);
+}
+
+inline
+pftype octcell::get_density() const
+{
+    return physics::vol_coeffs_to_density(water_vol_coeff, total_vol_coeff);
+}
+
+inline
+uint octcell::get_child_index_from_position(pfvec pos) const
+{
+#if  DEBUG
+    if (outside_of_cell(pos)) {
+        // Note that all positions are float values and just roughly correct; they should not lie close to cell sides
+        throw logic_error("Trying to get child index from a position that is outside of cell");
+    }
+#endif
+    /* Compare in lattice units, which only scales the position by a power of two */
+    uint idx = 0;
+    pftype inv_s = levelgeometry::inverse_edge_length(lvl);
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        if (pos[dim] * inv_s > pftype(ri[dim]) + pftype(0.5)) {
+            idx += (1 << dim);
+        }
+    }
+    return idx;
+}
+
+inline
+bool octcell::outside_of_cell(pfvec pos) const
+{
+    /* Compare in lattice units, which only scales the position by a power of two */
+    pftype inv_s = levelgeometry::inverse_edge_length(lvl);
+    for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+        pftype x = pos[dim] * inv_s;
+        if (x < pftype(ri[dim]) || x >= pftype(ri[dim] + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline
+bool octcell::inside_of_cell(pfvec pos) const
+{
+    return !outside_of_cell(pos);
+}
+
+/**************
+ * Simulation *
+ **************/
+
+inline
+bool octcell::has_no_air() const
+{
+    return water_vol_coeff >= total_vol_coeff;
+}
+
+inline
+bool octcell::has_air() const
+{
+    return water_vol_coeff < total_vol_coeff;
+}
+
+inline
+bool octcell::has_no_water() const
+{
+    return water_vol_coeff <= 0;
+}
+
+inline
+bool octcell::has_water() const
+{
+    return water_vol_coeff > 0;
+}
+
+inline
+bool octcell::has_no_fluid() const
+{
+    return total_vol_coeff <= 0;
+}
+
+inline
+bool octcell::has_fluid() const
+{
+    return total_vol_coeff > 0;
+}
+
+inline
+bool octcell::is_mixed_cell() const
+{
+    return has_air() && has_water();
+}
+
+inline
+pftype octcell::get_air_volume_coefficient() const
+{
+    return total_vol_coeff - water_vol_coeff;
+}
+
+inline
+pftype octcell::get_alpha() const
+{
+    return water_vol_coeff/total_vol_coeff;
+}
+
+inline
+pftype octcell::get_safe_alpha() const
+{
+    if (total_vol_coeff) {
+        return water_vol_coeff/total_vol_coeff;
+    }
+    else {
+        return 0;
+    }
+}
+
+inline
+pftype octcell::get_water_volume() const
+{
+    return water_vol_coeff * get_cube_volume();
+}
+
+inline
+pftype octcell::get_total_fluid_volume() const
+{
+    return total_vol_coeff * get_cube_volume();
+}
+
+/************
+ * Children *
+ ************/
+
+inline
+bool octcell::has_parent() const
+{
+    return _par;
+}
+
+inline
+bool octcell::is_root() const
+{
+    return !has_parent();
+}
+
+inline
+bool octcell::has_child_array() const
+{
+    return _c;
+}
+
+inline
+bool octcell::is_leaf() const
+{
+    return !has_child_array();
+}
+
+inline
+bool octcell::has_child(uint idx) const
+{
+#if  DEBUG
+    if (is_leaf()) {
+        throw logic_error("Trying to check if a leaf cell has a child by looking up an index");
+    }
+    if (idx >= MAX_NUM_CHILDREN) {
+        throw out_of_range("Trying to check if a cell has a child by looking up an index that is too high");
+    }
+#endif
+    return (_cm >> idx) & 1;
+}
+
+inline
+octcell* octcell::get_parent() const
+{
+#if  DEBUG
+    if (is_root()) {
+        throw logic_error("Trying to get parent from root cell");
+    }
+#endif
+    return _par;
+}
+
+inline
+uint octcell::get_number_of_children() const
+{
+#if  DEBUG
+    if (is_leaf()) {
+        throw logic_error("Trying to get number of children for a leaf cell");
+    }
+#endif
+    uint num = 0;
+    for (uint idx = 0; idx < MAX_NUM_CHILDREN; idx++) {
+        if (has_child(idx)) {
+            num++;
+        }
+    }
+    return num;
+}
+
+inline
+void octcell::remove_child(uint child_idx)
+{
+#if  DEBUG
+    octcell* c = get_child(child_idx);
+    if (is_leaf()) {
+        throw logic_error("Trying to remove a child cell from a leaf cell");
+    }
+    if (child_idx < 0 || child_idx >= MAX_NUM_CHILDREN) {
+        throw out_of_range("Trying to remove a child cell with index out of bound");
+    }
+    if (!c) {
+        throw logic_error("Trying to remove a child cell that does not exist");
+    }
+#endif
+
+    /* Remove child */
+    delete_child(child_idx);
+    topology_changed();
+}
+
+////////////////////////////////////////////////////////////////
+// INLINE STATIC MEMBER FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+/***********
+ * Indexes *
+ ***********/
+
+inline
+#if  NUM_DIMENSIONS == 2
+uint octcell::child_index(uint dim0, uint dim1)
+#elif  NUM_DIMENSIONS == 3
+uint octcell::child_index(uint dim0, uint dim1, uint dim2)
+#endif
+{
+#if    NUM_DIMENSIONS == 2
+    return (dim0 << 0) | (dim1 << 1);
+#elif  NUM_DIMENSIONS == 3
+    return (dim0 << 0) | (dim1 << 1) | (dim2 << 2);
+#endif
+}
+
+inline
+#if  NUM_DIMENSIONS == 2
+uint octcell::child_index_xy(uint x, uint y)
+#elif  NUM_DIMENSIONS == 3
+uint octcell::child_index_xyz(uint x, uint y, uint z)
+#endif
+{
+#if    NUM_DIMENSIONS == 2
+    return (x << DIM_X) | (y << DIM_Y);
+#elif  NUM_DIMENSIONS == 3
+    return (x << DIM_X) | (y << DIM_Y) | (z << DIM_Z);
+#endif
+}
+
+inline
+uint octcell::child_index_offset(uint dim)
+{
+    return 1 << dim;
+}
+
+inline
+bool octcell::positive_direction_of_child(uint child_index, uint dim)
+{
+    return (child_index >> dim) & 1;
+}
+
+inline
+uint octcell::child_index_flip_direction(uint child_index, uint dim)
+{
+    return child_index ^ (1 << dim);
+}
+
+/* Geometry */
+
+inline
+pftype octcell::cube_side_area(pftype side_length)
+{
+    return inline_int_pow(side_length, NUM_DIMENSIONS-1);
+}
+
+inline
+pftype octcell::cube_volume(pftype side_length)
+{
+    return inline_int_pow(side_length, NUM_DIMENSIONS);
+}
+
+#endif // OCTCELL_H
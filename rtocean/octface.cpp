@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::logic_error;
+
+// Own includes
+#include "octface.h"
+#include "physics.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+/* Default constructor */
+octface::octface()
+{
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Initializes a new face without any flow through it */
+void octface::set(uint dimension, pftype distance, pftype gravitational_acceleration, pftype cell_face_area)
+{
+    dim                   = dimension                 ;
+    water_vol_coeff       = 0                         ;
+    total_vol_coeff       = 0                         ;
+    quasi_momentum_vector = pfvec()                   ;
+    quasi_momentum        = 0                         ;
+    vel                   = 0                         ;
+    dist                  = distance                  ;
+    g                     = gravitational_acceleration;
+    cf_area               = cell_face_area            ;
+}
+
+void octface::set_volume_coefficients(pftype water_volume_coefficient, pftype total_volume_coefficient)
+{
+#if  DEBUG
+#if  0
+    cout << endl;
+    cout << "Cell wall: Old water volume coefficient: " << water_vol_coeff << endl;
+    cout << "Cell wall: Old total volume coefficient: " << total_vol_coeff << endl;
+    cout << "Cell wall: Additional water volume coefficient: " << water_volume_coefficient-water_vol_coeff << endl;
+    cout << "Cell wall: Additional total volume coefficient: " << total_volume_coefficient-total_vol_coeff << endl;
+    cout << "Cell wall: New water volume coefficient: " << water_volume_coefficient << endl;
+    cout << "Cell wall: New total volume coefficient: " << total_volume_coefficient << endl;
+#endif
+    if (IS_NAN(water_volume_coefficient)) {
+        throw logic_error("Trying to set a NaN water_volume_coefficient in cell wall");
+    }
+    if (IS_NAN(total_volume_coefficient)) {
+        throw logic_error("Trying to set a NaN total_volume_coefficient in cell wall");
+    }
+    if (water_volume_coefficient < 0) {
+        throw logic_error("Trying to set a negative water_volume_coefficient in cell wall");
+    }
+    if (total_volume_coefficient < 0) {
+        throw logic_error("Trying to set a negative total_volume_coefficient in cell wall");
+    }
+    if (water_volume_coefficient > total_volume_coefficient) {
+        throw logic_error("Trying to set a higher water_volume_coefficient than total_volume_coefficient in cell wall");
+    }
+#endif
+    water_vol_coeff = water_volume_coefficient;
+    total_vol_coeff = total_volume_coefficient;
+}
+
+pftype octface::get_cell_face_density()
+{
+    return physics::vol_coeffs_to_density(water_vol_coeff, total_vol_coeff);
+}
+
+/*
+ * Updates the velocity by the pressure gradient and gravity. Cell 1 is the cell on the negative
+ * side of the face and cell 2 is the cell on the positive side.
+ */
+void octface::update_velocity(pftype p1, pftype p2, pftype average_density, pftype dt)
+{
+    /* No advection term implemented */
+    //average_total_density = MIN(average_total_density, P_WATER_DENSITY); // Prevent nasty circulation behaviours in the water
+    //TODO: Prevevt circulation behaviour even in the air
+#if  NO_ATMOSPHERE
+    average_density = average_density;
+    vel += ((p1 - p2) / (dist * NORMAL_WATER_DENSITY) - g) * dt;
+#else
+    if (!average_density) {
+        // Nothing to accelerate
+        return;
+    }
+    //vel_out += ((p1 - p2) / (dist * average_density) - g * (average_density > NORMAL_WATER_DENSITY ? NORMAL_WATER_DENSITY/average_density : 1)) * dt;
+    vel += ((p1 - p2) / (dist * average_density) - g) * dt;
+#endif
+}
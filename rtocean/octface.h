@@ -0,0 +1,116 @@
+#ifndef OCTFACE_H
+#define OCTFACE_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "definitions.h"
+#include "dllnode.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINTION
+////////////////////////////////////////////////////////////////
+
+/*
+ * A cell face shared by two leaf cells. There is only one record per face; the
+ * two octneighbors of a neighbor connection both point to it. All directed
+ * properties are stored as seen from the cell on the negative side of the face,
+ * i.e. in the positive direction of the dimension dim.
+ *
+ * Ownership: the leaf cell passes handle the cells in parallel, so in each pass a
+ * face is written by one of its two cells only:
+ *   - The velocity is owned by the cell on the negative side, i.e. the cell that
+ *     has the face with pos_dir set (see owns_velocity).
+ *   - The advected values (the volume coefficients and the quasi-momentum vector)
+ *     are owned by the upwind cell, or by the cell on the negative side if there is
+ *     no flow through the face (see owns_advected_values).
+ * Changes of the topology are not covered by this and must be made serially.
+ */
+class octface
+{
+public:
+    octface();
+
+public:
+
+    /***********
+     * General *
+     ***********/
+
+    uint idx; /* Index of the face in the tree's face store */
+    uint dim; /* The dimension the face is perpendicular to */
+
+    /***************************
+     * Advection of properties *
+     ***************************/
+
+    /* Volume of fluid method */
+    pftype water_vol_coeff; /* [1] The volume of the water divided by the volujme of the cell (between 0 and total_vol_coeff) */
+    pftype total_vol_coeff; /* [1] The volume of the water and air divided by the volujme of the cell (should stay around 1) */
+
+    /* Advection of momentum */
+    pfvec  quasi_momentum_vector; /* [kg/(s*m^2)] The quasi-momentum vector to be advected */
+    pftype quasi_momentum; /* [kg/(s*m^2)] The quasi-momentum scalar in the positive direction, could be united with the velocity scalar */
+
+    /*****************
+     * Navier-Stokes *
+     *****************/
+
+    /* Water flow */
+    pftype vel; /* [m/s] Velocity of the water in the positive direction */
+
+    /* Geometric coefficients, fixed for the life time of the face */
+    pftype dist; /* [m] Distance between the cell centers along the face normal */
+    pftype g;    /* [m/s^2] The component of the gravitational acceleration along the line from the cell on the negative side to the cell on the positive side */
+
+    /* Surface */
+    pftype cf_area;  /* [m^2] Cell face area */
+
+public:
+    /* Public methods */
+    void   set(uint dimension, pftype distance, pftype gravitational_acceleration, pftype cell_face_area);
+    void   set_volume_coefficients(pftype water_volume_coefficient, pftype total_volume_coefficient);
+    pftype get_vel_out(bool pos_dir) const; /* [m/s] */
+    pftype get_cell_face_density(); /* [kg/m^3] */
+    bool   owns_advected_values(bool pos_dir) const;
+    static bool owns_velocity(bool pos_dir);
+
+    /* Simulation */
+    void update_velocity(pftype p1, pftype p2, pftype average_density, pftype dt);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    octface(octface&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* The velocity out from the cell that has its neighbor in the direction pos_dir */
+inline
+pftype octface::get_vel_out(bool pos_dir) const
+{
+    return pos_dir ? vel : pftype(-vel);
+}
+
+/* Whether the cell that has its neighbor in the direction pos_dir may write the advected values */
+inline
+bool octface::owns_advected_values(bool pos_dir) const
+{
+    pftype vel_out = get_vel_out(pos_dir);
+    return vel_out > 0 || (vel_out == 0 && pos_dir);
+}
+
+/* Whether the cell that has its neighbor in the direction pos_dir may write the velocity */
+inline
+bool octface::owns_velocity(bool pos_dir)
+{
+    return pos_dir;
+}
+
+#endif // OCTFACE_H
@@ -1,7 +1,7 @@
-
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-/* Own includes */
-#include "physics.h"
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+/* Own includes */
+#include "physics.h"
@@ -1,26 +1,79 @@
-#ifndef  PHYSICS_H
-#define  PHYSICS_H
-
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-/* Own include files */
-#include "definitions.h"
-
-namespace physics {
-
-////////////////////////////////////////////////////////////////
-// PUBLIC FUNCTION DEFINITIONS
-////////////////////////////////////////////////////////////////
-
-inline
-pftype vol_coeffs_to_density(pftype water_volume_coeff, pftype total_volume_coeff)
-{
-    return  water_volume_coeff * (NORMAL_WATER_DENSITY - NORMAL_AIR_DENSITY) +
-            total_volume_coeff * NORMAL_AIR_DENSITY                              ;
-}
-
-} // namespace physics
-
-#endif  /* PHYSICS_H */
+#ifndef  PHYSICS_H
+#define  PHYSICS_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+/* Own include files */
+#include "definitions.h"
+
+/*
+ * With an atmosphere the pressure of a cell only depends on its own volume coefficients
+ * (see vol_coeffs_to_pressure), so the pressures of all leaf cells can be calculated at
+ * once after they have been advected (see pressurekernel.h). Without one the pressure
+ * may depend on the neighbors, and is calculated by each cell (see octcell::calculate_pressure).
+ */
+#define  LOCAL_EQUATION_OF_STATE  (USE_ARTIFICIAL_COMPRESSIBILITY && !NO_ATMOSPHERE)
+
+namespace physics {
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////
+
+inline
+pftype vol_coeffs_to_density(pftype water_volume_coeff, pftype total_volume_coeff)
+{
+    return  water_volume_coeff * (NORMAL_WATER_DENSITY - NORMAL_AIR_DENSITY) +
+            total_volume_coeff * NORMAL_AIR_DENSITY                              ;
+}
+
+/* [Pa] The pressure of a cell with an atmosphere, which does not depend on the neighbors */
+inline
+pftype vol_coeffs_to_pressure(pftype water_volume_coeff, pftype total_volume_coeff)
+{
+    if (water_volume_coeff >= total_volume_coeff) {
+        /* Cell consists only of water */
+        pftype p = (water_volume_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
+        if (p < 0) {
+#if  ALLOW_NEGATIVE_PRESSURES
+            // Prevent too low pressures at the boundary
+            p = (total_volume_coeff - 1) * ARTIFICIAL_COMPRESSIBILITY_FACTOR;
+            if (p > 0) {
+                p = 0; // Vacuum partly fills the cell
+            }
+#else
+            p = 0;
+#endif // ALLOW_NEGATIVE_PRESSURES
+        }
+        return p;
+    }
+    else if (water_volume_coeff <= 0) {
+        /* Cell consists only of air */
+        return total_volume_coeff * NORMAL_AIR_PRESSURE;
+    }
+    else {
+        /* Calculate pressure for a mixed cell */
+        pftype k = ARTIFICIAL_COMPRESSIBILITY_FACTOR;
+        pftype q = NORMAL_AIR_PRESSURE;
+        pftype a = total_volume_coeff - water_volume_coeff;
+        pftype w = water_volume_coeff;
+        pftype d = q*a/k;
+        //"Don't know if this formula is correct"
+        return k/2*(sqrt(SQUARE(d + 1 - w) + 4*d*w) + d + w - 1);
+    }
+}
+
+#if  MIXED_PRECISION_FOR_PHYSICS
+inline
+patype vol_coeffs_to_density(patype water_volume_coeff, patype total_volume_coeff)
+{
+    return  water_volume_coeff * (NORMAL_WATER_DENSITY - NORMAL_AIR_DENSITY) +
+            total_volume_coeff * NORMAL_AIR_DENSITY                              ;
+}
+#endif
+
+} // namespace physics
+
+#endif  /* PHYSICS_H */
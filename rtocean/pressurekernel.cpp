@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::logic_error;
+using std::out_of_range;
+
+// Own includes
+#include "pressurekernel.h"
+#include "compile_time.h"
+
+#if  HAS_VECTOR_INSTRUCTIONS
+// Intrinsics (some of them warn about their own placeholder operand with some versions of GCC)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+
+/*
+ * The kernels must not fuse the multiplications and additions, since the scalar
+ * code, which is compiled without FMA, does not either
+ */
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+namespace pressurekernel {
+
+////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+namespace {
+
+void calculate_pressures_scalar(leafstore& lf, uint first, uint end)
+{
+    for (uint idx = first; idx < end; idx++) {
+        lf.p[idx] = physics::vol_coeffs_to_pressure(lf.water_vol_coeff[idx], lf.total_vol_coeff[idx]);
+    }
+}
+
+#if  HAS_VECTOR_INSTRUCTIONS
+
+STATIC_ASSERT(sizeof(pftype) == sizeof(double));
+
+const pftype K = ARTIFICIAL_COMPRESSIBILITY_FACTOR;
+const pftype Q = NORMAL_AIR_PRESSURE;
+
+__attribute__((target("avx2")))
+void calculate_pressures_avx2(leafstore& lf, uint first, uint end)
+{
+    const uint W = 4;
+    if (end - first < W) {
+        calculate_pressures_scalar(lf, first, end);
+        return;
+    }
+    const double* wc = reinterpret_cast<const double*>(&lf.water_vol_coeff[0]);
+    const double* tc = reinterpret_cast<const double*>(&lf.total_vol_coeff[0]);
+    double*       p  = reinterpret_cast<double*>      (&lf.p[0]);
+    const __m256d k      = _mm256_set1_pd(K);
+    const __m256d q      = _mm256_set1_pd(Q);
+    const __m256d half_k = _mm256_set1_pd(K/2);
+    const __m256d one    = _mm256_set1_pd(1);
+    const __m256d four   = _mm256_set1_pd(4);
+    const __m256d zero   = _mm256_setzero_pd();
+    uint idx = first;
+    for (; idx + W <= end; idx += W) {
+        __m256d w = _mm256_loadu_pd(wc + idx);
+        __m256d t = _mm256_loadu_pd(tc + idx);
+        /* Only water */
+        __m256d water_p = _mm256_mul_pd(_mm256_sub_pd(w, one), k);
+#if  ALLOW_NEGATIVE_PRESSURES
+        __m256d vacuum_p = _mm256_mul_pd(_mm256_sub_pd(t, one), k);
+        vacuum_p = _mm256_blendv_pd(vacuum_p, zero, _mm256_cmp_pd(vacuum_p, zero, _CMP_GT_OQ));
+        water_p = _mm256_blendv_pd(water_p, vacuum_p, _mm256_cmp_pd(water_p, zero, _CMP_LT_OQ));
+#else
+        water_p = _mm256_blendv_pd(water_p, zero, _mm256_cmp_pd(water_p, zero, _CMP_LT_OQ));
+#endif
+        /* Only air */
+        __m256d air_p = _mm256_mul_pd(t, q);
+        /* Pick one, in the same order as the scalar code */
+        __m256d no_air   = _mm256_cmp_pd(w, t, _CMP_GE_OQ);
+        __m256d no_water = _mm256_cmp_pd(w, zero, _CMP_LE_OQ);
+        __m256d result = _mm256_blendv_pd(air_p, water_p, no_air);
+        if (_mm256_movemask_pd(_mm256_or_pd(no_air, no_water)) != 0xF) {
+            /* Mixed, only where the surface is */
+            __m256d d = _mm256_div_pd(_mm256_mul_pd(q, _mm256_sub_pd(t, w)), k);
+            __m256d e = _mm256_sub_pd(_mm256_add_pd(d, one), w);
+            __m256d root = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(e, e), _mm256_mul_pd(_mm256_mul_pd(four, d), w)));
+            __m256d mixed_p = _mm256_mul_pd(half_k, _mm256_sub_pd(_mm256_add_pd(_mm256_add_pd(root, d), w), one));
+            result = _mm256_blendv_pd(mixed_p, result, _mm256_or_pd(no_air, no_water));
+        }
+        _mm256_storeu_pd(p + idx, result);
+    }
+    calculate_pressures_scalar(lf, idx, end);
+}
+
+__attribute__((target("avx512f")))
+void calculate_pressures_avx512(leafstore& lf, uint first, uint end)
+{
+    const uint W = 8;
+    if (end - first < W) {
+        calculate_pressures_scalar(lf, first, end);
+        return;
+    }
+    const double* wc = reinterpret_cast<const double*>(&lf.water_vol_coeff[0]);
+    const double* tc = reinterpret_cast<const double*>(&lf.total_vol_coeff[0]);
+    double*       p  = reinterpret_cast<double*>      (&lf.p[0]);
+    const __m512d k      = _mm512_set1_pd(K);
+    const __m512d q      = _mm512_set1_pd(Q);
+    const __m512d half_k = _mm512_set1_pd(K/2);
+    const __m512d one    = _mm512_set1_pd(1);
+    const __m512d four   = _mm512_set1_pd(4);
+    const __m512d zero   = _mm512_setzero_pd();
+    uint idx = first;
+    for (; idx + W <= end; idx += W) {
+        __m512d w = _mm512_loadu_pd(wc + idx);
+        __m512d t = _mm512_loadu_pd(tc + idx);
+        /* Only water */
+        __m512d water_p = _mm512_mul_pd(_mm512_sub_pd(w, one), k);
+#if  ALLOW_NEGATIVE_PRESSURES
+        __m512d vacuum_p = _mm512_mul_pd(_mm512_sub_pd(t, one), k);
+        vacuum_p = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(vacuum_p, zero, _CMP_GT_OQ), vacuum_p, zero);
+        water_p = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(water_p, zero, _CMP_LT_OQ), water_p, vacuum_p);
+#else
+        water_p = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(water_p, zero, _CMP_LT_OQ), water_p, zero);
+#endif
+        /* Only air */
+        __m512d air_p = _mm512_mul_pd(t, q);
+        /* Pick one, in the same order as the scalar code */
+        __mmask8 no_air   = _mm512_cmp_pd_mask(w, t, _CMP_GE_OQ);
+        __mmask8 no_water = _mm512_cmp_pd_mask(w, zero, _CMP_LE_OQ);
+        __m512d result = _mm512_mask_blend_pd(no_air, air_p, water_p);
+        __mmask8 mixed = ~(no_air | no_water);
+        if (mixed) {
+            /* Mixed, only where the surface is */
+            __m512d d = _mm512_div_pd(_mm512_mul_pd(q, _mm512_sub_pd(t, w)), k);
+            __m512d e = _mm512_sub_pd(_mm512_add_pd(d, one), w);
+            __m512d root = _mm512_sqrt_pd(_mm512_add_pd(_mm512_mul_pd(e, e), _mm512_mul_pd(_mm512_mul_pd(four, d), w)));
+            __m512d mixed_p = _mm512_mul_pd(half_k, _mm512_sub_pd(_mm512_add_pd(_mm512_add_pd(root, d), w), one));
+            result = _mm512_mask_blend_pd(mixed, result, mixed_p);
+        }
+        _mm512_storeu_pd(p + idx, result);
+    }
+    calculate_pressures_scalar(lf, idx, end);
+}
+
+#endif // HAS_VECTOR_INSTRUCTIONS
+
+} // namespace
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+/* Calculates the pressures of the leaf cells first up to end of the leaf store from their volume coefficients */
+void calculate_pressures(INSTRUCTION_SET instruction_set, leafstore& lf, uint first, uint end)
+{
+#if  DEBUG
+    if (first > end || end > lf.size()) {
+        throw out_of_range("Trying to calculate the pressures of cells that are not in the leaf store");
+    }
+    if (!instructionset::is_supported(instruction_set)) {
+        throw out_of_range("Trying to calculate pressures with an instruction set that is not supported");
+    }
+#endif
+    switch (instruction_set) {
+#if  HAS_VECTOR_INSTRUCTIONS
+    case IS_AVX2:
+        calculate_pressures_avx2(lf, first, end);
+        break;
+    case IS_AVX512:
+        calculate_pressures_avx512(lf, first, end);
+        break;
+#endif
+    default:
+        calculate_pressures_scalar(lf, first, end);
+        break;
+    }
+#if  DEBUG
+    for (uint idx = first; idx < end; idx++) {
+        if (IS_NAN(lf.p[idx])) {
+            throw logic_error("Pressure became NaN");
+        }
+    }
+#endif
+}
+
+} // namespace pressurekernel
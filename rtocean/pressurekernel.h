@@ -0,0 +1,36 @@
+#ifndef PRESSUREKERNEL_H
+#define PRESSUREKERNEL_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "leafstore.h"
+#include "instructionset.h"
+
+/*
+ * The equation of state (see physics::vol_coeffs_to_pressure), run as one kernel
+ * over a range of the leaf cells of a leaf store once they have all been advected,
+ * instead of by each cell as its volume coefficients are set. The result is written
+ * to the pressure array of the store only.
+ *
+ * The vector kernels have no branches per cell: the pressures of a water cell, an
+ * air cell and a mixed cell are calculated for a whole vector of cells, and the
+ * right one is picked by masks. The square root of the mixed cells is skipped for
+ * the vectors that have none, which are most of them, since the mixed cells only
+ * make up the surface. Each pressure is calculated with the same operations in the
+ * same order as the scalar code, so every instruction set gives the same result to
+ * the last bit.
+ */
+namespace pressurekernel {
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////
+
+void calculate_pressures(INSTRUCTION_SET instruction_set, leafstore& lf, uint first, uint end);
+
+} // namespace pressurekernel
+
+#endif // PRESSUREKERNEL_H
@@ -0,0 +1,390 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <cmath>
+#include <limits>
+
+// Own includes
+#include "pressuresolver.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+pressuresolver::pressuresolver()
+{
+    lf = 0;
+    domain = 0;
+    first_cell = 0;
+    end_cell = 0;
+    dt = 0;
+    correction_time = 0;
+    alpha = 0;
+    beta = 0;
+    mean_rhs = 0;
+    reset_stats();
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*
+ * Solves for the pressures of the leaf cells from first to end, which are written to the
+ * store and the cells, for the face velocities as they are before the velocity update of
+ * a time step of dt. The pressures of the halo must be up to date, and are made so again.
+ */
+void pressuresolver::solve(threadpool& workers, leafstore& lf, subdomain* domain, uint first, uint end, pftype dt)
+{
+    double start = threadpool::get_seconds();
+    this->lf = &lf;
+    this->domain = domain;
+    first_cell = first;
+    end_cell = end;
+    this->dt = dt;
+    correction_time = MAX(dt, pftype(SIMULATION_TIME_STEP));
+    uint num_cells = lf.size();
+    coefficient   .resize(lf.neighbor.size());
+    diagonal      .resize(num_cells);
+    rhs           .resize(num_cells);
+    residual      .resize(num_cells);
+    preconditioned.resize(num_cells);
+    direction     .resize(num_cells);
+    product       .resize(num_cells);
+    uint num_blocks = get_number_of_blocks();
+    block_sum  .resize(num_blocks);
+    block_count.resize(num_blocks);
+    block_max  .resize(num_blocks);
+
+    /* The system, with the mean of the right-hand side taken away */
+    workers.run(&pressuresolver::run_set_up_pass, this, num_blocks);
+    double sum = sum_blocks(block_sum);
+    double count = sum_blocks(block_count);
+    mean_rhs = count ? sum / count : 0;
+#if  PRESSURE_SOLVER_MULTIGRID_CYCLE
+    multigrid_levels.set_up(workers, lf, first, end, diagonal, coefficient);
+    stats.num_levels = multigrid_levels.get_number_of_levels();
+#endif
+
+    /* Conjugate gradients */
+    stats.last_rates.clear();
+    workers.run(&pressuresolver::run_start_pass, this, num_blocks);
+    double max_residual = get_max_residual();
+    double rz = 0;
+    if (max_residual > PRESSURE_SOLVER_TOLERANCE) {
+        rz = precondition(workers);
+        direction = preconditioned;
+    }
+    uint iteration = 0;
+    while (max_residual > PRESSURE_SOLVER_TOLERANCE && iteration < PRESSURE_SOLVER_MAX_ITERATIONS) {
+        if (domain) {
+            domain->exchange_cell_values(direction);
+        }
+        workers.run(&pressuresolver::run_multiply_pass, this, num_blocks);
+        double dq = sum_blocks(block_sum);
+        if (!dq) {
+            /* Nothing left to solve for along the direction */
+            break;
+        }
+        alpha = rz / dq;
+        double last_max_residual = max_residual;
+        workers.run(&pressuresolver::run_step_pass, this, num_blocks);
+        max_residual = get_max_residual();
+        iteration++;
+        double rate = max_residual / last_max_residual;
+        stats.last_rates.push_back(rate);
+        if (rate) {
+            stats.log_rate_sum += log(rate);
+        }
+        if (max_residual > PRESSURE_SOLVER_TOLERANCE) {
+            double new_rz = precondition(workers);
+            beta = new_rz / rz;
+            workers.run(&pressuresolver::run_direction_pass, this, num_blocks);
+            rz = new_rz;
+        }
+    }
+
+    /* The lowest pressure is the one of the air */
+    double lowest = std::numeric_limits<double>::max();
+    for (uint idx = first_cell; idx < end_cell; idx++) {
+        if (diagonal[idx]) {
+            lowest = MIN(lowest, double(lf.p[idx]));
+        }
+    }
+    if (domain) {
+        lowest = -domain->get_global_max(-lowest);
+    }
+    if (lowest < std::numeric_limits<double>::max()) {
+        pftype shift = pftype(NORMAL_AIR_PRESSURE - lowest);
+        for (uint idx = first_cell; idx < end_cell; idx++) {
+            if (diagonal[idx]) {
+                lf.p[idx] += shift;
+                lf.copy_pressure_to_cell(idx);
+            }
+        }
+    }
+    if (domain) {
+        domain->exchange_cell_properties(lf);
+    }
+
+    stats.num_solves++;
+    stats.num_iterations += iteration;
+    if (max_residual > PRESSURE_SOLVER_TOLERANCE) {
+        stats.num_unconverged_solves++;
+    }
+    stats.last_num_iterations = iteration;
+    stats.last_residual = max_residual;
+    stats.time += threadpool::get_seconds() - start;
+}
+
+void pressuresolver::reset_stats()
+{
+    stats.num_solves = 0;
+    stats.num_iterations = 0;
+    stats.num_unconverged_solves = 0;
+    stats.last_num_iterations = 0;
+    stats.last_residual = 0;
+    stats.last_rates.clear();
+    stats.log_rate_sum = 0;
+    stats.num_levels = 0;
+    stats.time = 0;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+uint pressuresolver::get_number_of_blocks() const
+{
+    return (end_cell - first_cell + SOLVER_BLOCK_SIZE - 1) / SOLVER_BLOCK_SIZE;
+}
+
+void pressuresolver::get_block(uint block, uint& first, uint& end) const
+{
+    first = first_cell + block * SOLVER_BLOCK_SIZE;
+    end = MIN(first + SOLVER_BLOCK_SIZE, end_cell);
+}
+
+/* The sum of the blocks, in order, and of all processes */
+double pressuresolver::sum_blocks(const std::vector<double>& sums)
+{
+    double sum = 0;
+    for (uint block = 0; block < sums.size(); block++) {
+        sum += sums[block];
+    }
+    return domain ? domain->get_global_sum(sum) : sum;
+}
+
+double pressuresolver::get_max_residual()
+{
+    double max_residual = 0;
+    for (uint block = 0; block < block_max.size(); block++) {
+        max_residual = MAX(max_residual, block_max[block]);
+    }
+    return domain ? domain->get_global_max(max_residual) : max_residual;
+}
+
+/* The preconditioned residual, and its dot product with the residual */
+double pressuresolver::precondition(threadpool& workers)
+{
+#if  PRESSURE_SOLVER_MULTIGRID_CYCLE
+    multigrid_levels.run_cycle(workers, PRESSURE_SOLVER_MULTIGRID_CYCLE, residual, preconditioned);
+    workers.run(&pressuresolver::run_dot_pass, this, get_number_of_blocks());
+#else
+    workers.run(&pressuresolver::run_diagonal_pass, this, get_number_of_blocks());
+#endif
+    return sum_blocks(block_sum);
+}
+
+/* The row of the cell, with the density of each face as in the velocity kernel */
+void pressuresolver::set_up_cell(uint idx)
+{
+    const leafstore& l = *lf;
+    pftype own_mass_per_unit_area = l.get_density(idx)*l.s[idx]; // [kg/m^2]
+    pftype sum = 0;
+    pftype flux_out = (l.total_vol_coeff[idx] - 1) * l.get_cube_volume(idx) / correction_time; // [m^3/s] Needed
+    for (uint i = l.first_neighbor[idx]; i < l.first_neighbor[idx + 1]; i++) {
+        octface* f = l.neighbor_face[i];
+        uint ni = l.neighbor[i];
+#if  NO_ATMOSPHERE
+        pftype average_density = NORMAL_WATER_DENSITY; // [kg/m^3]
+#else
+        pftype average_density = (l.get_density(ni)*l.s[ni] + own_mass_per_unit_area)/(l.s[ni] + l.s[idx]); // [kg/m^3]
+#endif
+        bool pos_dir = l.neighbor_pos_dir[i];
+        pftype vel_out = f->get_vel_out(pos_dir); // [m/s] After the update without the pressures
+        pftype a = 0; // [m^4*s/kg]
+        if (average_density) {
+            pftype sign = pos_dir ? 1 : -1;
+            vel_out -= sign * f->g * dt;
+            a = f->cf_area * dt / (f->dist * average_density);
+        }
+        flux_out -= vel_out * f->cf_area;
+        coefficient[i] = a;
+        sum += a;
+    }
+    diagonal[idx] = sum;
+    rhs[idx] = flux_out;
+}
+
+void pressuresolver::start_cell(uint idx, double& max_residual)
+{
+    if (!diagonal[idx]) {
+        residual[idx] = 0;
+        return;
+    }
+    const leafstore& l = *lf;
+    rhs[idx] -= pftype(mean_rhs);
+    pftype r = rhs[idx] - diagonal[idx] * l.p[idx];
+    for (uint i = l.first_neighbor[idx]; i < l.first_neighbor[idx + 1]; i++) {
+        r += coefficient[i] * l.p[l.neighbor[i]];
+    }
+    residual[idx] = r;
+    max_residual = MAX(max_residual, get_scaled_residual(idx));
+}
+
+void pressuresolver::multiply_cell(uint idx, double& dq)
+{
+    const leafstore& l = *lf;
+    pftype q = diagonal[idx] * direction[idx];
+    for (uint i = l.first_neighbor[idx]; i < l.first_neighbor[idx + 1]; i++) {
+        q -= coefficient[i] * direction[l.neighbor[i]];
+    }
+    product[idx] = q;
+    dq += double(direction[idx]) * double(q);
+}
+
+void pressuresolver::step_cell(uint idx, double& max_residual)
+{
+    if (!diagonal[idx]) {
+        return;
+    }
+    lf->p[idx] += pftype(alpha) * direction[idx];
+    residual[idx] -= pftype(alpha) * product[idx];
+    max_residual = MAX(max_residual, get_scaled_residual(idx));
+}
+
+/* [1] The change of the total volume coefficient that the residual of the cell gives in the correction time */
+double pressuresolver::get_scaled_residual(uint idx) const
+{
+    return ABS(double(residual[idx])) * correction_time * lf->get_inverse_cube_volume(idx);
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* The passes run over ranges of blocks (see threadpool), and leave their sums per block */
+
+void pressuresolver::run_set_up_pass(void* solver_object, uint part, uint first_block, uint end_block)
+{
+    pressuresolver* s = static_cast<pressuresolver*>(solver_object);
+    for (uint block = first_block; block < end_block; block++) {
+        uint first, end;
+        s->get_block(block, first, end);
+        double sum = 0;
+        double count = 0;
+        for (uint idx = first; idx < end; idx++) {
+            s->set_up_cell(idx);
+            if (s->diagonal[idx]) {
+                sum += s->rhs[idx];
+                count++;
+            }
+        }
+        s->block_sum[block] = sum;
+        s->block_count[block] = count;
+    }
+    part = part;
+}
+
+void pressuresolver::run_start_pass(void* solver_object, uint part, uint first_block, uint end_block)
+{
+    pressuresolver* s = static_cast<pressuresolver*>(solver_object);
+    for (uint block = first_block; block < end_block; block++) {
+        uint first, end;
+        s->get_block(block, first, end);
+        double max_residual = 0;
+        for (uint idx = first; idx < end; idx++) {
+            s->start_cell(idx, max_residual);
+        }
+        s->block_max[block] = max_residual;
+    }
+    part = part;
+}
+
+void pressuresolver::run_multiply_pass(void* solver_object, uint part, uint first_block, uint end_block)
+{
+    pressuresolver* s = static_cast<pressuresolver*>(solver_object);
+    for (uint block = first_block; block < end_block; block++) {
+        uint first, end;
+        s->get_block(block, first, end);
+        double dq = 0;
+        for (uint idx = first; idx < end; idx++) {
+            s->multiply_cell(idx, dq);
+        }
+        s->block_sum[block] = dq;
+    }
+    part = part;
+}
+
+void pressuresolver::run_step_pass(void* solver_object, uint part, uint first_block, uint end_block)
+{
+    pressuresolver* s = static_cast<pressuresolver*>(solver_object);
+    for (uint block = first_block; block < end_block; block++) {
+        uint first, end;
+        s->get_block(block, first, end);
+        double max_residual = 0;
+        for (uint idx = first; idx < end; idx++) {
+            s->step_cell(idx, max_residual);
+        }
+        s->block_max[block] = max_residual;
+    }
+    part = part;
+}
+
+void pressuresolver::run_diagonal_pass(void* solver_object, uint part, uint first_block, uint end_block)
+{
+    pressuresolver* s = static_cast<pressuresolver*>(solver_object);
+    for (uint block = first_block; block < end_block; block++) {
+        uint first, end;
+        s->get_block(block, first, end);
+        double rz = 0;
+        for (uint idx = first; idx < end; idx++) {
+            s->preconditioned[idx] = s->diagonal[idx] ? pftype(s->residual[idx] / s->diagonal[idx]) : pftype(0);
+            rz += double(s->residual[idx]) * double(s->preconditioned[idx]);
+        }
+        s->block_sum[block] = rz;
+    }
+    part = part;
+}
+
+void pressuresolver::run_dot_pass(void* solver_object, uint part, uint first_block, uint end_block)
+{
+    pressuresolver* s = static_cast<pressuresolver*>(solver_object);
+    for (uint block = first_block; block < end_block; block++) {
+        uint first, end;
+        s->get_block(block, first, end);
+        double rz = 0;
+        for (uint idx = first; idx < end; idx++) {
+            rz += double(s->residual[idx]) * double(s->preconditioned[idx]);
+        }
+        s->block_sum[block] = rz;
+    }
+    part = part;
+}
+
+void pressuresolver::run_direction_pass(void* solver_object, uint part, uint first_block, uint end_block)
+{
+    pressuresolver* s = static_cast<pressuresolver*>(solver_object);
+    pftype beta = pftype(s->beta);
+    for (uint block = first_block; block < end_block; block++) {
+        uint first, end;
+        s->get_block(block, first, end);
+        for (uint idx = first; idx < end; idx++) {
+            s->direction[idx] = s->preconditioned[idx] + beta * s->direction[idx];
+        }
+    }
+    part = part;
+}
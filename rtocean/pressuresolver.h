@@ -0,0 +1,149 @@
+#ifndef PRESSURESOLVER_H
+#define PRESSURESOLVER_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "leafstore.h"
+#include "multigrid.h"
+#include "subdomain.h"
+#include "threadpool.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * The pressures of the pressure projection (USE_ARTIFICIAL_COMPRESSIBILITY 0): the
+ * pressures of the leaf cells that make the face velocities divergence free once they
+ * have been updated by the pressure gradients and gravity (see octface::update_velocity).
+ * The volume flux out of a cell after the update is linear in the pressures, which gives
+ * a Poisson equation with one row per cell,
+ *
+ *   sum over the faces of a * (p - p of the neighbor) = flux out needed - flux out without the pressures
+ *
+ * where a = area * dt / (dist * density of the face), with the density of the face taken
+ * as in the velocity kernel, and the flux out needed brings the total volume coefficient
+ * of the cell back to 1 in one time step, so that the errors do not add up. The short time
+ * steps that end on a print screen time would make that flux huge, so it is never asked
+ * for in less than SIMULATION_TIME_STEP. No face leads
+ * out of the cells, so the pressures are only given up to a constant, which is chosen so
+ * that the lowest pressure is the one of the air (NORMAL_AIR_PRESSURE), and the mean of
+ * the right-hand side is taken away, since the volume fluid has to fill is only 1 on
+ * average.
+ *
+ * The system is symmetric and positive semidefinite, and is solved by conjugate
+ * gradients, preconditioned by one multigrid cycle over the parents of the leaf cells per
+ * iteration (see multigrid.h), or by the diagonal with PRESSURE_SOLVER_MULTIGRID_CYCLE 0.
+ * Relaxation alone only evens out the pressures over a few cells per iteration, while
+ * the coarser levels carry the long wavelengths over the whole water. The iterations
+ * start from the pressures of the last time step, and go on until the remaining
+ * divergence would change no total volume coefficient by more than
+ * PRESSURE_SOLVER_TOLERANCE in that time. The cells are swept in blocks of
+ * SOLVER_BLOCK_SIZE, and the sums of the blocks are added up in order, so the result
+ * does not depend on the number of threads. With more processes, each one solves for
+ * the cells of its subdomain, and the halo and the sums are exchanged in every iteration.
+ * The sums of the processes are added up, so the result only agrees with the one of a
+ * single process to within rounding.
+ */
+class pressuresolver
+{
+public:
+    /* Types */
+    struct solve_stats {
+        uint   num_solves;
+        uint   num_iterations; /* In all the solves */
+        uint   num_unconverged_solves; /* Stopped by PRESSURE_SOLVER_MAX_ITERATIONS */
+        uint   last_num_iterations;
+        double last_residual; /* [1] The largest change of a total volume coefficient in a time step that the divergence left by the last solve gives */
+        std::vector<double> last_rates; /* [1] The convergence rate of each iteration of the last solve: the factor it reduced the largest change of a total volume coefficient by */
+        double log_rate_sum; /* The natural logarithms of the convergence rates of all the iterations, so exp(log_rate_sum / num_iterations) is their mean */
+        uint   num_levels; /* Of the last multigrid cycle */
+        double time; /* [s] Spent solving */
+    };
+
+public:
+    /* Constructors and destructor */
+    pressuresolver();
+
+public:
+    /* Public methods */
+    void   solve(threadpool& workers, leafstore& lf, subdomain* domain, uint first, uint end, pftype dt);
+    const solve_stats& get_stats() const;
+    void   reset_stats();
+
+private:
+    /* Private member variables */
+    /* The current solve */
+    leafstore* lf;
+    subdomain* domain;
+    uint   first_cell; /* The leaf cells solved for */
+    uint   end_cell;
+    pftype dt;
+    pftype correction_time; /* [s] The volume errors are taken away over, and the remaining divergence is measured over, at least SIMULATION_TIME_STEP */
+    double alpha; /* The step along the search direction */
+    double beta; /* The part of the last search direction that is kept */
+    double mean_rhs;
+    /* Per neighbor entry of the leaf store */
+    std::vector<pftype> coefficient;
+    /* Per leaf cell */
+    std::vector<pftype> diagonal; /* Zero for a cell without faces that the pressure acts through */
+    std::vector<pftype> rhs;
+    std::vector<pftype> residual;
+    std::vector<pftype> preconditioned; /* The residual after the multigrid cycle, or divided by the diagonal */
+    std::vector<pftype> direction;
+    std::vector<pftype> product; /* The matrix times the search direction */
+    /* Per block */
+    std::vector<double> block_sum;
+    std::vector<double> block_count;
+    std::vector<double> block_max;
+#if  PRESSURE_SOLVER_MULTIGRID_CYCLE
+    multigrid multigrid_levels;
+#endif
+    solve_stats stats;
+
+private:
+    /* Private methods */
+    uint   get_number_of_blocks() const;
+    void   get_block(uint block, uint& first, uint& end) const;
+    double sum_blocks(const std::vector<double>& sums);
+    double get_max_residual();
+    double precondition(threadpool& workers);
+    void   set_up_cell(uint idx);
+    void   start_cell(uint idx, double& max_residual);
+    void   multiply_cell(uint idx, double& dq);
+    void   step_cell(uint idx, double& max_residual);
+    double get_scaled_residual(uint idx) const;
+
+    /* Private static methods */
+    static void run_set_up_pass(void* solver_object, uint part, uint first_block, uint end_block);
+    static void run_start_pass(void* solver_object, uint part, uint first_block, uint end_block);
+    static void run_multiply_pass(void* solver_object, uint part, uint first_block, uint end_block);
+    static void run_step_pass(void* solver_object, uint part, uint first_block, uint end_block);
+    static void run_diagonal_pass(void* solver_object, uint part, uint first_block, uint end_block);
+    static void run_dot_pass(void* solver_object, uint part, uint first_block, uint end_block);
+    static void run_direction_pass(void* solver_object, uint part, uint first_block, uint end_block);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    pressuresolver(pressuresolver&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+const pressuresolver::solve_stats& pressuresolver::get_stats() const
+{
+    return stats;
+}
+
+#endif // PRESSURESOLVER_H
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <cstring>
+#include <stdexcept>
+using std::runtime_error;
+using std::logic_error;
+using std::out_of_range;
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+// Own includes
+#include "shmtransport.h"
+
+////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+namespace {
+
+/* Lets the other processes run while waiting for them, which matters when there are fewer processors than processes */
+void yield_processor()
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+shmtransport::shmtransport(uint number_of_processes, size_t ring_buffer_size)
+{
+    num_processes = number_of_processes ? number_of_processes : 1;
+    rank = 0;
+    capacity = ring_buffer_size;
+    ring_stride = sizeof(ring_header) + (capacity + sizeof(ring_header) - 1) / sizeof(ring_header) * sizeof(ring_header);
+    segment_size = num_processes * num_processes * ring_stride;
+#ifdef _WIN32
+    segment = 0;
+    if (num_processes > 1) {
+        throw runtime_error("Shared-memory ring buffers between processes are not supported on this platform");
+    }
+#else
+    /* Anonymous memory is zero-filled, so all the rings start out empty */
+    void* memory = mmap(0, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw runtime_error("Could not map the shared memory of the ring buffers");
+    }
+    segment = static_cast<char*>(memory);
+#endif
+}
+
+shmtransport::~shmtransport()
+{
+#ifndef _WIN32
+    stop_processes();
+    munmap(segment, segment_size);
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Forks the other processes; each of them returns from here with its own rank */
+void shmtransport::start_processes()
+{
+#if  DEBUG && !defined(_WIN32)
+    if (rank || !children.empty()) {
+        throw logic_error("Trying to start processes that have already been started");
+    }
+#endif
+#ifndef _WIN32
+    for (uint r = 1; r < num_processes; r++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            throw runtime_error("Could not fork a process");
+        }
+        if (!pid) {
+            rank = r;
+            children.clear();
+            return;
+        }
+        children.push_back(pid);
+    }
+#endif
+}
+
+/* Ends the forked processes, which do not return from here, and lets the first one wait for them */
+void shmtransport::stop_processes()
+{
+#ifndef _WIN32
+    if (rank) {
+        _exit(0);
+    }
+    for (uint i = 0; i < children.size(); i++) {
+        int status;
+        waitpid(children[i], &status, 0);
+    }
+    children.clear();
+#endif
+}
+
+void shmtransport::send(uint to, const void* data, size_t size)
+{
+#if  DEBUG
+    if (to >= num_processes || to == rank) {
+        throw out_of_range("Trying to send a message to a process that does not exist");
+    }
+#endif
+    ring_header* ring = get_ring(rank, to);
+    char* buffer = reinterpret_cast<char*>(ring + 1);
+    const char* bytes = static_cast<const char*>(data);
+    while (size) {
+        uint64 head = ring->head;
+        uint64 free_bytes = capacity - (head - ring->tail);
+        if (!free_bytes) {
+            /* Wait for the receiver to make room */
+            yield_processor();
+            continue;
+        }
+        size_t offset = size_t(head % capacity);
+        size_t n = MIN(size, MIN(size_t(free_bytes), capacity - offset));
+        memcpy(buffer + offset, bytes, n);
+        /* The data must be in place before the receiver sees the new head */
+        __sync_synchronize();
+        ring->head = head + n;
+        bytes += n;
+        size -= n;
+    }
+}
+
+void shmtransport::receive(uint from, void* data, size_t size)
+{
+#if  DEBUG
+    if (from >= num_processes || from == rank) {
+        throw out_of_range("Trying to receive a message from a process that does not exist");
+    }
+#endif
+    ring_header* ring = get_ring(from, rank);
+    const char* buffer = reinterpret_cast<const char*>(ring + 1);
+    char* bytes = static_cast<char*>(data);
+    while (size) {
+        uint64 tail = ring->tail;
+        uint64 available_bytes = ring->head - tail;
+        if (!available_bytes) {
+            /* Wait for the sender */
+            yield_processor();
+            continue;
+        }
+        /* The data must not be read before the head that announced it */
+        __sync_synchronize();
+        size_t offset = size_t(tail % capacity);
+        size_t n = MIN(size, MIN(size_t(available_bytes), capacity - offset));
+        memcpy(bytes, buffer + offset, n);
+        /* The data must have been read before the sender may overwrite it */
+        __sync_synchronize();
+        ring->tail = tail + n;
+        bytes += n;
+        size -= n;
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+shmtransport::ring_header* shmtransport::get_ring(uint from, uint to) const
+{
+    return reinterpret_cast<ring_header*>(segment + (from * num_processes + to) * ring_stride);
+}
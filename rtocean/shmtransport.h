@@ -0,0 +1,100 @@
+#ifndef SHMTRANSPORT_H
+#define SHMTRANSPORT_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+// Own includes
+#include "halotransport.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * Processes on one machine that send their messages through ring buffers in
+ * shared memory, a local stand-in for the interconnect of a cluster. There is one
+ * ring buffer per ordered pair of processes, written only by the sending process
+ * and read only by the receiving one, so no locks are needed: the sender moves
+ * the head and the receiver the tail, and each waits for the other while the
+ * buffer is full or empty.
+ *
+ * The shared memory is mapped by the constructor, and start_processes forks the
+ * other processes, which inherit it. The forked processes are copies of the
+ * calling one, so whatever has been built before, such as the tree, is the same
+ * in all of them. No other threads must run when they are forked. The forked
+ * processes leave through stop_processes (or the destructor), which the first
+ * process waits in until they all have.
+ */
+class shmtransport : public halotransport
+{
+public:
+    /* Constructors and destructor */
+    shmtransport(uint number_of_processes, size_t ring_buffer_size = HALO_RING_BUFFER_SIZE);
+    ~shmtransport();
+
+public:
+    /* Public methods */
+    void start_processes();
+    void stop_processes();
+    uint get_rank() const;
+    uint get_number_of_processes() const;
+    void send(uint to, const void* data, size_t size);
+    void receive(uint from, void* data, size_t size);
+
+private:
+    /* Private types */
+    struct ring_header {
+        volatile uint64 head; /* [Bytes] Written so far, moved by the sending process */
+        char            head_padding[64 - sizeof(uint64)]; /* Keeps the head and the tail in different cache lines */
+        volatile uint64 tail; /* [Bytes] Read so far, moved by the receiving process */
+        char            tail_padding[64 - sizeof(uint64)];
+    };
+
+private:
+    /* Private methods */
+    ring_header* get_ring(uint from, uint to) const;
+
+private:
+    /* Private member variables */
+    uint   num_processes;
+    uint   rank;
+    size_t capacity; /* [Bytes] Of each ring buffer */
+    size_t ring_stride; /* [Bytes] The header and the data of a ring buffer */
+    size_t segment_size;
+    char*  segment; /* The shared memory, holding the ring buffers */
+#ifndef _WIN32
+    std::vector<pid_t> children; /* The forked processes, in the first process */
+#endif
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    shmtransport(shmtransport&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+uint shmtransport::get_rank() const
+{
+    return rank;
+}
+
+inline
+uint shmtransport::get_number_of_processes() const
+{
+    return num_processes;
+}
+
+#endif // SHMTRANSPORT_H
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "snapshotbuffer.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+snapshotbuffer::snapshotbuffer()
+{
+    back  = 0;
+    ready = 1;
+    front = 2;
+    fresh = false;
+    published = false;
+#ifdef _WIN32
+    InitializeCriticalSection(&mutex);
+#else
+    pthread_mutex_init(&mutex, 0);
+#endif
+}
+
+snapshotbuffer::~snapshotbuffer()
+{
+#ifdef _WIN32
+    DeleteCriticalSection(&mutex);
+#else
+    pthread_mutex_destroy(&mutex);
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Makes the back buffer the latest snapshot and hands the writer a new back buffer */
+void snapshotbuffer::publish()
+{
+    lock();
+    uint old_ready = ready;
+    ready = back;
+    back = old_ready;
+    fresh = true;
+    published = true;
+    unlock();
+}
+
+/*
+ * The latest published snapshot, or zero if nothing has been published yet. The
+ * snapshot stays valid and unchanged until the next call.
+ */
+const fieldsnapshot* snapshotbuffer::get_latest()
+{
+    lock();
+    if (fresh) {
+        uint old_front = front;
+        front = ready;
+        ready = old_front;
+        fresh = false;
+    }
+    bool any = published;
+    unlock();
+    return any ? &snapshots[front] : 0;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+void snapshotbuffer::lock()
+{
+#ifdef _WIN32
+    EnterCriticalSection(&mutex);
+#else
+    pthread_mutex_lock(&mutex);
+#endif
+}
+
+void snapshotbuffer::unlock()
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&mutex);
+#else
+    pthread_mutex_unlock(&mutex);
+#endif
+}
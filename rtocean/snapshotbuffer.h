@@ -0,0 +1,83 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Own includes
+#include "fieldsnapshot.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * Three snapshots handed between one writer thread (the solver) and one reader
+ * thread (the renderer) without either of them waiting for the other. At any time
+ * the writer owns one snapshot, which it captures into, the reader owns one, which
+ * it draws from, and the third one is the latest published snapshot. Publishing
+ * and taking the latest snapshot only swap indices under the mutex, so a slow
+ * reader makes the writer overwrite snapshots that were never drawn instead of
+ * delaying it, and a slow writer makes the reader draw the same snapshot again.
+ */
+class snapshotbuffer
+{
+public:
+    /* Constructors and destructor */
+    snapshotbuffer();
+    ~snapshotbuffer();
+
+public:
+    /* Public methods, writer */
+    fieldsnapshot*       get_back_buffer();
+    void                 publish();
+
+    /* Public methods, reader */
+    const fieldsnapshot* get_latest();
+
+private:
+    /* Private methods */
+    void lock();
+    void unlock();
+
+private:
+    /* Private member variables */
+    fieldsnapshot snapshots[3];
+    uint back;  /* Owned by the writer */
+    uint ready; /* The latest published snapshot */
+    uint front; /* Owned by the reader */
+    bool fresh; /* If ready has been published since the reader last took it */
+    bool published; /* If anything has been published at all */
+#ifdef _WIN32
+    CRITICAL_SECTION mutex;
+#else
+    pthread_mutex_t  mutex;
+#endif
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    snapshotbuffer(snapshotbuffer&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* The snapshot to capture into before calling publish */
+inline
+fieldsnapshot* snapshotbuffer::get_back_buffer()
+{
+    return &snapshots[back];
+}
+
+#endif // SNAPSHOTBUFFER_H
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "solverthread.h"
+#include "message_handler.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+solverthread::solverthread(QObject* parent) :
+    QThread(parent)
+{
+    system_to_simulate = 0;
+    result = SR_FINISHED;
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Must not be called while the thread is running */
+void solverthread::set_system_to_simulate(watersystem* system)
+{
+    system_to_simulate = system;
+}
+
+/* Only valid once the thread has finished */
+int solverthread::get_result() const
+{
+    return result;
+}
+
+////////////////////////////////////////////////////////////////
+// PROTECTED METHODS
+////////////////////////////////////////////////////////////////
+
+void solverthread::run()
+{
+    try
+    {
+#if  DEBUG
+        if (!system_to_simulate) {
+            throw logic_error("Trying to run a simulation while no system is set");
+        }
+#endif
+        result = system_to_simulate->run_simulation(SIMULATION_TIME_STEP);
+    }
+    catch (std::exception &e) {
+        message_handler::inform_about_exception("solverthread::run()", e, true);
+    }
+}
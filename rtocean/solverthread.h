@@ -0,0 +1,47 @@
+#ifndef SOLVERTHREAD_H
+#define SOLVERTHREAD_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Qt includes
+#include <QThread>
+
+// Own includes
+#include "watersystem.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * Runs the simulation of a water system on its own thread, so that the user
+ * interface and the rendering never wait for a time step. The callbacks of the
+ * system are called on this thread; they must not touch any widgets directly.
+ * The thread finishes when the simulation is paused or aborted, and emits
+ * finished() then.
+ */
+class solverthread : public QThread
+{
+    Q_OBJECT
+
+public:
+    /* Constructor */
+    explicit solverthread(QObject* parent = 0);
+
+    /* Public methods */
+    void set_system_to_simulate(watersystem* system);
+    int  get_result() const;
+
+protected:
+    /* Protected methods */
+    void run();
+
+private:
+    /* Private member variables */
+    watersystem* system_to_simulate;
+    int result; /* What the last simulation ended with, see SIMULATION_RESULT */
+};
+
+#endif // SOLVERTHREAD_H
@@ -0,0 +1,360 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <algorithm>
+#include <stdexcept>
+using std::logic_error;
+
+// Own includes
+#include "subdomain.h"
+#include "morton.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+subdomain::subdomain(halotransport* transport)
+{
+    this->transport = transport;
+    first_cell = 0;
+    end_cell = 0;
+    generation = 0;
+    up_to_date = false;
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*
+ * Splits the domain between the processes, so that each subdomain gets about as many of
+ * the leaf cells that are in the store now. All processes must have the same store.
+ */
+void subdomain::partition(const leafstore& lf)
+{
+    uint num_processes = get_number_of_processes();
+    uint num_cells = lf.size();
+    bounds.resize(num_processes + 1);
+    bounds[0] = uint64(1) << (NUM_DIMENSIONS * SUBDOMAIN_LEVEL);
+    bounds[num_processes] = uint64(1) << (NUM_DIMENSIONS * (SUBDOMAIN_LEVEL + 1));
+    uint idx = 0;
+    for (uint r = 1; r < num_processes; r++) {
+        /* Start at the first subtree that starts after an even share of the cells */
+        idx = MAX(idx, uint(uint64(num_cells) * r / num_processes));
+        while (idx > 0 && idx < num_cells && get_subtree_key(lf.cell[idx]) == get_subtree_key(lf.cell[idx - 1])) {
+            idx++;
+        }
+        bounds[r] = idx < num_cells ? get_subtree_key(lf.cell[idx]) : bounds[num_processes];
+    }
+    up_to_date = false;
+    update(lf);
+}
+
+/* Finds the cells of the subdomain and the faces to the other subdomains again if the store has been rebuilt */
+void subdomain::update(const leafstore& lf)
+{
+#if  DEBUG
+    if (bounds.empty()) {
+        throw logic_error("Trying to update a subdomain that has not been partitioned");
+    }
+    if (!lf.is_up_to_date()) {
+        throw logic_error("Trying to update a subdomain from a leaf store that is out of date");
+    }
+#endif
+    if (up_to_date && generation == lf.get_generation()) {
+        return;
+    }
+    uint rank = get_rank();
+
+    /* The cells of the subdomain, which are consecutive */
+    uint num_cells = lf.size();
+    uint lower = 0;
+    uint upper = num_cells;
+    while (lower < upper) {
+        uint middle = lower + (upper - lower)/2;
+        if (get_subtree_key(lf.cell[middle]) < bounds[rank]) {
+            lower = middle + 1;
+        }
+        else {
+            upper = middle;
+        }
+    }
+    first_cell = lower;
+    upper = num_cells;
+    while (lower < upper) {
+        uint middle = lower + (upper - lower)/2;
+        if (get_subtree_key(lf.cell[middle]) < bounds[rank + 1]) {
+            lower = middle + 1;
+        }
+        else {
+            upper = middle;
+        }
+    }
+    end_cell = lower;
+
+    /* The faces to the cells of the other subdomains */
+    neighbors.resize(get_number_of_processes());
+    for (uint r = 0; r < neighbors.size(); r++) {
+        neighbors[r].faces.clear();
+        neighbors[r].own_cells.clear();
+        neighbors[r].halo_cells.clear();
+    }
+    for (uint idx = first_cell; idx < end_cell; idx++) {
+        for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+            uint ni = lf.neighbor[i];
+            if (ni >= first_cell && ni < end_cell) {
+                continue;
+            }
+            neighbor_subdomain& neighbor = neighbors[get_owner(get_subtree_key(lf.cell[ni]))];
+            boundary_face face;
+            face.pos_dir       = lf.neighbor_pos_dir[i];
+            face.negative_cell = face.pos_dir ? idx : ni;
+            face.positive_cell = face.pos_dir ? ni : idx;
+            face.f             = lf.neighbor_face[i];
+            neighbor.faces.push_back(face);
+            neighbor.own_cells.push_back(idx);
+            neighbor.halo_cells.push_back(ni);
+        }
+    }
+    halo_cells.clear();
+    for (uint r = 0; r < neighbors.size(); r++) {
+        neighbor_subdomain& neighbor = neighbors[r];
+        std::sort(neighbor.faces.begin(), neighbor.faces.end());
+        std::sort(neighbor.own_cells.begin(), neighbor.own_cells.end());
+        neighbor.own_cells.erase(std::unique(neighbor.own_cells.begin(), neighbor.own_cells.end()), neighbor.own_cells.end());
+        std::sort(neighbor.halo_cells.begin(), neighbor.halo_cells.end());
+        neighbor.halo_cells.erase(std::unique(neighbor.halo_cells.begin(), neighbor.halo_cells.end()), neighbor.halo_cells.end());
+        halo_cells.insert(halo_cells.end(), neighbor.halo_cells.begin(), neighbor.halo_cells.end());
+    }
+    std::sort(halo_cells.begin(), halo_cells.end());
+
+    generation = lf.get_generation();
+    up_to_date = true;
+}
+
+/* Whether the properties of the cell are kept up to date by this process: the cells of the subdomain and its halo */
+bool subdomain::is_local(uint idx) const
+{
+    return (idx >= first_cell && idx < end_cell) || std::binary_search(halo_cells.begin(), halo_cells.end(), idx);
+}
+
+/* Sends the volume coefficients and pressures of the cells next to the other subdomains, and receives the halo */
+void subdomain::exchange_cell_properties(leafstore& lf)
+{
+    const uint NUM_VALUES = 3;
+    for (uint r = 0; r < neighbors.size(); r++) {
+        send_buffer.clear();
+        for (uint j = 0; j < neighbors[r].own_cells.size(); j++) {
+            uint idx = neighbors[r].own_cells[j];
+            send_buffer.push_back(lf.water_vol_coeff[idx]);
+            send_buffer.push_back(lf.total_vol_coeff[idx]);
+            send_buffer.push_back(lf.p[idx]);
+        }
+        const std::vector<uint>& cells = neighbors[r].halo_cells;
+        exchange_buffers_with(r, NUM_VALUES * cells.size());
+        for (uint j = 0; j < cells.size(); j++) {
+            uint idx = cells[j];
+            lf.set_volume_coefficients(idx, receive_buffer[NUM_VALUES*j], receive_buffer[NUM_VALUES*j + 1]);
+            lf.p[idx] = receive_buffer[NUM_VALUES*j + 2];
+            lf.copy_pressure_to_cell(idx);
+        }
+    }
+}
+
+/* Sends the advected values of the faces to the other subdomains that the cells of this one own, and receives the rest */
+void subdomain::exchange_advected_values()
+{
+    const uint NUM_VALUES = 2 + NUM_DIMENSIONS;
+    for (uint r = 0; r < neighbors.size(); r++) {
+        send_buffer.clear();
+        for (uint j = 0; j < neighbors[r].faces.size(); j++) {
+            const boundary_face& face = neighbors[r].faces[j];
+            if (face.f->owns_advected_values(face.pos_dir)) {
+                send_buffer.push_back(face.f->water_vol_coeff);
+                send_buffer.push_back(face.f->total_vol_coeff);
+                for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+                    send_buffer.push_back(face.f->quasi_momentum_vector[dim]);
+                }
+            }
+        }
+        const std::vector<boundary_face>& faces = neighbors[r].faces;
+        uint num_faces = 0;
+        for (uint j = 0; j < faces.size(); j++) {
+            if (!faces[j].f->owns_advected_values(faces[j].pos_dir)) {
+                num_faces++;
+            }
+        }
+        exchange_buffers_with(r, NUM_VALUES * num_faces);
+        const pftype* values = num_faces ? &receive_buffer[0] : 0;
+        for (uint j = 0; j < faces.size(); j++) {
+            octface* f = faces[j].f;
+            if (!f->owns_advected_values(faces[j].pos_dir)) {
+                f->set_volume_coefficients(values[0], values[1]);
+                for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+                    f->quasi_momentum_vector[dim] = values[2 + dim];
+                }
+                values += NUM_VALUES;
+            }
+        }
+    }
+}
+
+/* Sends the velocities of the faces to the other subdomains that the cells of this one own, and receives the rest */
+void subdomain::exchange_velocities()
+{
+    for (uint r = 0; r < neighbors.size(); r++) {
+        send_buffer.clear();
+        for (uint j = 0; j < neighbors[r].faces.size(); j++) {
+            const boundary_face& face = neighbors[r].faces[j];
+            if (octface::owns_velocity(face.pos_dir)) {
+                send_buffer.push_back(face.f->vel);
+            }
+        }
+        const std::vector<boundary_face>& faces = neighbors[r].faces;
+        uint num_faces = 0;
+        for (uint j = 0; j < faces.size(); j++) {
+            if (!octface::owns_velocity(faces[j].pos_dir)) {
+                num_faces++;
+            }
+        }
+        exchange_buffers_with(r, num_faces);
+        const pftype* values = num_faces ? &receive_buffer[0] : 0;
+        for (uint j = 0; j < faces.size(); j++) {
+            if (!octface::owns_velocity(faces[j].pos_dir)) {
+                faces[j].f->vel = *values++;
+            }
+        }
+    }
+}
+
+/* Sends the values of the cells next to the other subdomains, one per leaf cell, and receives the ones of the halo */
+void subdomain::exchange_cell_values(std::vector<pftype>& values)
+{
+    for (uint r = 0; r < neighbors.size(); r++) {
+        send_buffer.clear();
+        for (uint j = 0; j < neighbors[r].own_cells.size(); j++) {
+            send_buffer.push_back(values[neighbors[r].own_cells[j]]);
+        }
+        const std::vector<uint>& cells = neighbors[r].halo_cells;
+        exchange_buffers_with(r, cells.size());
+        for (uint j = 0; j < cells.size(); j++) {
+            values[cells[j]] = receive_buffer[j];
+        }
+    }
+}
+
+/*
+ * Gives every process the volume coefficients, pressures and cell-center velocities of all the
+ * leaf cells, and the velocities of all their faces, which the processes need before they change
+ * the tree in a way that moves water between subdomains. Every process must call it. The message
+ * of a process grows with its leaf cells, and can be far larger than a ring buffer of the
+ * transport; all_gather streams it through (see exchange_buffers_with).
+ */
+void subdomain::share_leaf_cells(leafstore& lf)
+{
+    const uint NUM_VALUES = 3 + NUM_DIMENSIONS;
+    send_buffer.clear();
+    for (uint idx = first_cell; idx < end_cell; idx++) {
+        send_buffer.push_back(lf.water_vol_coeff[idx]);
+        send_buffer.push_back(lf.total_vol_coeff[idx]);
+        send_buffer.push_back(lf.p[idx]);
+        for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+            send_buffer.push_back(lf.ccv[idx][dim]);
+        }
+        for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+            send_buffer.push_back(lf.neighbor_face[i]->vel);
+        }
+    }
+    /* The subdomains are in the order of their leaf cells */
+    all_gather(send_buffer);
+    const pftype* values = send_buffer.empty() ? 0 : &send_buffer[0];
+    for (uint idx = 0; idx < lf.size(); idx++) {
+        lf.set_volume_coefficients(idx, values[0], values[1]);
+        lf.p[idx] = values[2];
+        lf.copy_pressure_to_cell(idx);
+        pfvec cell_center_velocity;
+        for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+            cell_center_velocity[dim] = values[3 + dim];
+        }
+        lf.set_cell_center_velocity(idx, cell_center_velocity);
+        values += NUM_VALUES;
+        for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+            lf.neighbor_face[i]->vel = *values++;
+        }
+    }
+}
+
+/* The largest of the values of all processes. Every process must call it. */
+double subdomain::get_global_max(double value)
+{
+    std::vector<double> values(1, value);
+    all_gather(values);
+    return *std::max_element(values.begin(), values.end());
+}
+
+/* The sum of the values of all processes, added up in the order of the processes. Every process must call it. */
+double subdomain::get_global_sum(double value)
+{
+    std::vector<double> values(1, value);
+    all_gather(values);
+    double sum = 0;
+    for (uint r = 0; r < values.size(); r++) {
+        sum += values[r];
+    }
+    return sum;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+/* The process whose subdomain has the subtree with the given key at SUBDOMAIN_LEVEL */
+uint subdomain::get_owner(uint64 key) const
+{
+    uint owner = uint(std::upper_bound(bounds.begin(), bounds.end(), key) - bounds.begin()) - 1;
+    return MIN(owner, get_number_of_processes() - 1);
+}
+
+/*
+ * Sends the send buffer to a process and receives size values from it into the receive buffer.
+ * The process with the lower rank sends first, and the other one receives first, so the message
+ * of one of them is streamed through the transport while the other one waits for it, whatever its
+ * size (see halotransport.h). Nothing is sent to the processes that are not next to this one.
+ */
+void subdomain::exchange_buffers_with(uint rank, uint size)
+{
+    receive_buffer.resize(size);
+    if (get_rank() < rank) {
+        send_buffer_to(rank);
+        receive_buffer_from(rank);
+    }
+    else {
+        receive_buffer_from(rank);
+        send_buffer_to(rank);
+    }
+}
+
+void subdomain::send_buffer_to(uint rank)
+{
+    if (!send_buffer.empty()) {
+        transport->send(rank, &send_buffer[0], send_buffer.size() * sizeof(pftype));
+    }
+}
+
+void subdomain::receive_buffer_from(uint rank)
+{
+    if (!receive_buffer.empty()) {
+        transport->receive(rank, &receive_buffer[0], receive_buffer.size() * sizeof(pftype));
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+uint64 subdomain::get_subtree_key(const octcell* c)
+{
+    return morton::key_at_level(c->key, c->lvl, SUBDOMAIN_LEVEL);
+}
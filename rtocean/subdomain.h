@@ -0,0 +1,180 @@
+#ifndef SUBDOMAIN_H
+#define SUBDOMAIN_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+
+// Own includes
+#include "leafstore.h"
+#include "halotransport.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * The part of the domain that one of the processes sharing a simulation is
+ * responsible for. Every process holds the whole tree, and changes its topology
+ * in the same way, so the leaf stores of the processes are the same and the
+ * leaf store indices can be used to tell the cells apart in the messages. The
+ * properties of the cells and faces are only kept up to date for the cells of
+ * the subdomain and the halo of cells next to it in the other subdomains.
+ *
+ * The subdomains are made of the subtrees at SUBDOMAIN_LEVEL, split in Morton
+ * order so that each process gets about as many leaf cells: the leaf cells of a
+ * subdomain are consecutive in the leaf store, and a subdomain keeps the same
+ * part of the root cell when cells are created. The leaf cells above the level
+ * belong to the subdomain of their first subtree.
+ *
+ * The faces between two subdomains are written by the process of one of the two
+ * cells (see octface), and the halo exchanges send what each process has written
+ * to the other one: the cell properties, the advected face values and the face
+ * velocities. The faces are listed in the same order by both processes, by the
+ * cells on either side, so nothing but the values themselves is sent.
+ */
+class subdomain
+{
+public:
+    /* Constructors and destructor */
+    subdomain(halotransport* transport);
+
+public:
+    /* Public methods */
+    uint   get_rank() const;
+    uint   get_number_of_processes() const;
+    void   partition(const leafstore& lf);
+    void   update(const leafstore& lf);
+    uint   get_first_cell() const;
+    uint   get_end_cell() const;
+    bool   is_local(uint idx) const;
+    void   exchange_cell_properties(leafstore& lf);
+    void   exchange_advected_values();
+    void   exchange_velocities();
+    void   share_leaf_cells(leafstore& lf);
+    void   exchange_cell_values(std::vector<pftype>& values);
+    double get_global_max(double value);
+    double get_global_sum(double value);
+    template<class T>
+    void   all_gather(std::vector<T>& values);
+
+private:
+    /* Private types */
+    struct boundary_face {
+        uint     negative_cell; /* Leaf store index of the cell on the negative side */
+        uint     positive_cell;
+        octface* f;
+        bool     pos_dir; /* Whether the other subdomain is in the positive direction, i.e. the cell of this one is on the negative side */
+
+        bool operator<(const boundary_face& other) const {
+            return negative_cell < other.negative_cell || (negative_cell == other.negative_cell && positive_cell < other.positive_cell);
+        }
+    };
+    struct neighbor_subdomain {
+        std::vector<boundary_face> faces; /* Sorted */
+        std::vector<uint> own_cells; /* The cells of this subdomain next to the other one, sorted */
+        std::vector<uint> halo_cells; /* The cells of the other subdomain next to this one, sorted */
+    };
+
+private:
+    /* Private member variables */
+    halotransport* transport;
+    std::vector<uint64> bounds; /* The first key at SUBDOMAIN_LEVEL of each subdomain, plus the end of the last one */
+    uint first_cell; /* The leaf cells of this subdomain */
+    uint end_cell;
+    uint generation; /* Of the leaf store the lists were made from */
+    bool up_to_date; /* Whether the lists were made after the subdomains were last partitioned */
+    std::vector<neighbor_subdomain> neighbors; /* Per process, empty for the ones that are not next to this one */
+    std::vector<uint> halo_cells; /* All of them, sorted */
+    std::vector<pftype> send_buffer;
+    std::vector<pftype> receive_buffer;
+
+private:
+    /* Private methods */
+    uint   get_owner(uint64 key) const;
+    void   exchange_buffers_with(uint rank, uint size);
+    void   send_buffer_to(uint rank);
+    void   receive_buffer_from(uint rank);
+
+    /* Private static methods */
+    static uint64 get_subtree_key(const octcell* c);
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    subdomain(subdomain&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+uint subdomain::get_rank() const
+{
+    return transport->get_rank();
+}
+
+inline
+uint subdomain::get_number_of_processes() const
+{
+    return transport->get_number_of_processes();
+}
+
+inline
+uint subdomain::get_first_cell() const
+{
+    return first_cell;
+}
+
+inline
+uint subdomain::get_end_cell() const
+{
+    return end_cell;
+}
+
+/*
+ * Gathers the values of all processes, in the order of the processes, which is the
+ * order of their subdomains. Every process must call it. T must be plain data. The
+ * processes take turns in the same way as in the halo exchanges (see
+ * exchange_buffers_with), so there is no limit on the number of values.
+ */
+template<class T>
+void subdomain::all_gather(std::vector<T>& values)
+{
+    uint num_processes = get_number_of_processes();
+    uint rank = get_rank();
+    uint num_values = values.size();
+    std::vector<T> all;
+    for (uint r = 0; r < num_processes; r++) {
+        if (r == rank) {
+            all.insert(all.end(), values.begin(), values.end());
+            continue;
+        }
+        bool sends_first = rank < r;
+        for (uint turn = 0; turn < 2; turn++) {
+            if (sends_first == (turn == 0)) {
+                transport->send(r, &num_values, sizeof(num_values));
+                if (num_values) {
+                    transport->send(r, &values[0], num_values * sizeof(T));
+                }
+            }
+            else {
+                uint num_received;
+                transport->receive(r, &num_received, sizeof(num_received));
+                if (num_received) {
+                    uint offset = all.size();
+                    all.resize(offset + num_received);
+                    transport->receive(r, &all[offset], num_received * sizeof(T));
+                }
+            }
+        }
+    }
+    values.swap(all);
+}
+
+#endif // SUBDOMAIN_H
@@ -0,0 +1,415 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::runtime_error;
+using std::exception;
+#ifndef _WIN32
+#include <unistd.h>
+#include <time.h>
+#endif
+
+// Own includes
+#include "threadpool.h"
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+threadpool::threadpool(uint number_of_threads)
+{
+    num_threads = 1;
+    range_job_function = 0;
+    grain_size = 1;
+    num_pending_tasks = 0;
+    generation = 0;
+    num_busy_workers = 0;
+    quitting = false;
+    failed = false;
+    queues.resize(1);
+    busy_times.resize(1, 0);
+#ifdef _WIN32
+    InitializeCriticalSection(&mutex);
+    InitializeConditionVariable(&work_posted);
+    InitializeConditionVariable(&job_finished);
+#else
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&work_posted, 0);
+    pthread_cond_init(&job_finished, 0);
+#endif
+    set_number_of_threads(number_of_threads);
+}
+
+threadpool::~threadpool()
+{
+    stop_threads();
+#ifdef _WIN32
+    DeleteCriticalSection(&mutex);
+#else
+    pthread_cond_destroy(&job_finished);
+    pthread_cond_destroy(&work_posted);
+    pthread_mutex_destroy(&mutex);
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/*
+ * Calls function(parameter, part, first, end) for ranges covering [0, num_items) and returns
+ * when all of them are done. The range is split in halves until the parts are no larger than
+ * grain_size, and the halves are shared between the threads by work stealing. If any of the
+ * calls throws, the exception is rethrown here as a runtime_error carrying the same message,
+ * once every thread has finished.
+ */
+void threadpool::run(range_function function, void* parameter, uint num_items, uint grain_size)
+{
+    run_range(function, parameter, 0, num_items, grain_size);
+}
+
+/* The same as run, for the items [first, end) */
+void threadpool::run_range(range_function function, void* parameter, uint first, uint end, uint grain_size)
+{
+    if (first >= end) {
+        return;
+    }
+    range_job_function = function;
+    this->grain_size = grain_size ? grain_size : 1;
+    task root = {0, parameter, 0, first, end};
+    run_job(root);
+}
+
+/*
+ * Calls function(this, parameter, argument, part) and returns when it and all the tasks it
+ * spawns, directly or through other tasks, are done. Exceptions are handled as in run.
+ */
+void threadpool::run_tasks(task_function function, void* parameter, void* argument)
+{
+    task root = {function, parameter, argument, 0, 0};
+    run_job(root);
+}
+
+/* Spawns a task of the running job; part is the thread the calling task runs on */
+void threadpool::spawn(task_function function, void* parameter, void* argument, uint part)
+{
+    task t = {function, parameter, argument, 0, 0};
+    push_task(t, part);
+}
+
+/*
+ * Sets the number of threads, the calling thread included. Zero means one thread per
+ * processor. Must not be called while a job is running.
+ */
+void threadpool::set_number_of_threads(uint number_of_threads)
+{
+    if (!number_of_threads) {
+        number_of_threads = get_number_of_processors();
+    }
+    if (number_of_threads == num_threads) {
+        return;
+    }
+    stop_threads();
+    start_threads(number_of_threads);
+}
+
+void threadpool::reset_busy_times()
+{
+    busy_times.assign(num_threads, 0);
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+uint threadpool::get_number_of_processors()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long n = info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n > 0 ? uint(n) : 1;
+}
+
+/* [s] Monotonic wall clock time */
+double threadpool::get_seconds()
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return double(count.QuadPart) / double(frequency.QuadPart);
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + 1e-9 * now.tv_nsec;
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+void threadpool::start_threads(uint number_of_threads)
+{
+    num_threads = number_of_threads;
+    queues.resize(num_threads);
+    busy_times.assign(num_threads, 0);
+    arguments.resize(num_threads - 1);
+    threads.resize(num_threads - 1);
+    for (uint i = 0; i < threads.size(); i++) {
+        arguments[i].pool = this;
+        arguments[i].thread_index = i + 1;
+        arguments[i].generation = generation;
+#ifdef _WIN32
+        threads[i] = CreateThread(0, 0, thread_main, &arguments[i], 0, 0);
+        bool created = threads[i] != 0;
+#else
+        bool created = !pthread_create(&threads[i], 0, thread_main, &arguments[i]);
+#endif
+        if (!created) {
+            threads.resize(i);
+            stop_threads();
+            throw runtime_error("Could not create a worker thread");
+        }
+    }
+}
+
+void threadpool::stop_threads()
+{
+    lock();
+    quitting = true;
+    wake_workers();
+    unlock();
+    for (uint i = 0; i < threads.size(); i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], 0);
+#endif
+    }
+    threads.clear();
+    arguments.clear();
+    quitting = false;
+    num_threads = 1;
+    queues.resize(1);
+    busy_times.assign(1, 0);
+}
+
+/* The main loop of a worker thread */
+void threadpool::work(uint thread_index, uint handled_generation)
+{
+    lock();
+    for (;;) {
+        while (generation == handled_generation && !quitting) {
+            wait_for_work();
+        }
+        if (quitting) {
+            break;
+        }
+        handled_generation = generation;
+        execute_tasks(thread_index);
+        num_busy_workers--;
+        if (!num_busy_workers) {
+            wake_caller();
+        }
+    }
+    unlock();
+}
+
+/* Posts a job, works on it on the calling thread and waits for the workers to finish */
+void threadpool::run_job(const task& root)
+{
+    lock();
+    failed = false;
+    failure_message.clear();
+    queues[0].push_back(root);
+    num_pending_tasks = 1;
+    num_busy_workers = threads.size();
+    generation++;
+    wake_workers();
+    execute_tasks(0);
+    wait_for_workers();
+    unlock();
+    if (failed) {
+        throw runtime_error(failure_message);
+    }
+}
+
+/* Runs tasks until the job is done. Must be called with the mutex locked. */
+void threadpool::execute_tasks(uint part)
+{
+    task t;
+    for (;;) {
+        if (take_task(part, t)) {
+            bool skip = failed;
+            unlock();
+            if (!skip) {
+                run_task(t, part);
+            }
+            lock();
+            num_pending_tasks--;
+            if (!num_pending_tasks) {
+                /* Let the idle threads see that the job is done */
+                wake_workers();
+            }
+        }
+        else if (num_pending_tasks) {
+            /* Other threads are still running tasks that may spawn new ones */
+            wait_for_work();
+        }
+        else {
+            break;
+        }
+    }
+}
+
+/* Takes the newest task of the own queue, or else steals the oldest task of another thread. Must be called with the mutex locked. */
+bool threadpool::take_task(uint part, task& t)
+{
+    if (!queues[part].empty()) {
+        t = queues[part].back();
+        queues[part].pop_back();
+        return true;
+    }
+    for (uint i = 1; i < num_threads; i++) {
+        std::deque<task>& victim = queues[(part + i) % num_threads];
+        if (!victim.empty()) {
+            t = victim.front();
+            victim.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void threadpool::run_task(task& t, uint part)
+{
+    double start = get_seconds();
+    try {
+        if (t.function) {
+            t.function(this, t.parameter, t.argument, part);
+        }
+        else {
+            /* Leave the upper halves to be stolen while handling the lower half */
+            while (t.end - t.first > grain_size) {
+                uint middle = t.first + (t.end - t.first)/2;
+                task upper = {0, t.parameter, 0, middle, t.end};
+                push_task(upper, part);
+                t.end = middle;
+            }
+            range_job_function(t.parameter, part, t.first, t.end);
+        }
+    }
+    catch (exception& error) {
+        lock();
+        if (!failed) {
+            failed = true;
+            failure_message = error.what();
+        }
+        unlock();
+    }
+    catch (...) {
+        lock();
+        if (!failed) {
+            failed = true;
+            failure_message = "Unknown exception in a task";
+        }
+        unlock();
+    }
+    busy_times[part] += get_seconds() - start;
+}
+
+void threadpool::push_task(const task& t, uint part)
+{
+    lock();
+    queues[part].push_back(t);
+    num_pending_tasks++;
+#ifdef _WIN32
+    WakeConditionVariable(&work_posted);
+#else
+    pthread_cond_signal(&work_posted);
+#endif
+    unlock();
+}
+
+/* Synchronization */
+
+void threadpool::lock()
+{
+#ifdef _WIN32
+    EnterCriticalSection(&mutex);
+#else
+    pthread_mutex_lock(&mutex);
+#endif
+}
+
+void threadpool::unlock()
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&mutex);
+#else
+    pthread_mutex_unlock(&mutex);
+#endif
+}
+
+/* Must be called with the mutex locked */
+void threadpool::wait_for_work()
+{
+#ifdef _WIN32
+    SleepConditionVariableCS(&work_posted, &mutex, INFINITE);
+#else
+    pthread_cond_wait(&work_posted, &mutex);
+#endif
+}
+
+/* Must be called with the mutex locked */
+void threadpool::wait_for_workers()
+{
+    while (num_busy_workers) {
+#ifdef _WIN32
+        SleepConditionVariableCS(&job_finished, &mutex, INFINITE);
+#else
+        pthread_cond_wait(&job_finished, &mutex);
+#endif
+    }
+}
+
+void threadpool::wake_workers()
+{
+#ifdef _WIN32
+    WakeAllConditionVariable(&work_posted);
+#else
+    pthread_cond_broadcast(&work_posted);
+#endif
+}
+
+void threadpool::wake_caller()
+{
+#ifdef _WIN32
+    WakeConditionVariable(&job_finished);
+#else
+    pthread_cond_signal(&job_finished);
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE STATIC METHODS
+////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+DWORD WINAPI threadpool::thread_main(LPVOID argument)
+#else
+void* threadpool::thread_main(void* argument)
+#endif
+{
+    thread_argument* a = static_cast<thread_argument*>(argument);
+    a->pool->work(a->thread_index, a->generation);
+    return 0;
+}
@@ -0,0 +1,158 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <vector>
+#include <deque>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Own includes
+#include "definitions.h"
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+/*
+ * A fixed set of worker threads sharing the work of one job at a time through work
+ * stealing. The calling thread works on the job too, so one thread means that
+ * everything is run directly by the caller. The threads are numbered from zero (the
+ * caller) up to the number of threads, and every call made for a job is told which
+ * thread (part) it runs on, which can be used to keep partial results per thread.
+ *
+ * A job is a tree of tasks. Each thread keeps the tasks it spawns in its own queue
+ * and takes the most recently spawned one first, so it works depth first; a thread
+ * that runs out of tasks steals the oldest task of another thread, which is the
+ * largest piece of work that is left. Tasks must therefore only write to data that
+ * belongs to them; which thread runs a task must not affect the result.
+ */
+class threadpool
+{
+public:
+    /* Types */
+    typedef void (*range_function)(void* parameter, uint part, uint first, uint end);
+    typedef void (*task_function)(threadpool* pool, void* parameter, void* argument, uint part);
+
+public:
+    /* Constructors and destructor */
+    threadpool(uint number_of_threads = 1);
+    ~threadpool();
+
+public:
+    /* Public methods */
+    void   run(range_function function, void* parameter, uint num_items, uint grain_size = 1);
+    void   run_range(range_function function, void* parameter, uint first, uint end, uint grain_size = 1);
+    void   run_tasks(task_function function, void* parameter, void* argument);
+    void   spawn(task_function function, void* parameter, void* argument, uint part);
+    void   set_number_of_threads(uint number_of_threads);
+    uint   get_number_of_threads() const;
+    double get_busy_time(uint part) const;
+    void   reset_busy_times();
+
+    /* Public static methods */
+    static uint   get_number_of_processors();
+    static double get_seconds();
+
+private:
+    /* Private types */
+    struct thread_argument {
+        threadpool* pool;
+        uint        thread_index;
+        uint        generation; /* The last job posted before the thread was started */
+    };
+    struct task {
+        task_function function; /* Zero for a range of the current range job */
+        void*         parameter;
+        void*         argument;
+        uint          first;
+        uint          end;
+    };
+
+private:
+    /* Private methods */
+    void start_threads(uint number_of_threads);
+    void stop_threads();
+    void work(uint thread_index, uint handled_generation);
+    void run_job(const task& root);
+    void execute_tasks(uint part);
+    bool take_task(uint part, task& t);
+    void run_task(task& t, uint part);
+    void push_task(const task& t, uint part);
+    void lock();
+    void unlock();
+    void wait_for_work();
+    void wait_for_workers();
+    void wake_workers();
+    void wake_caller();
+
+    /* Private static methods */
+#ifdef _WIN32
+    static DWORD WINAPI thread_main(LPVOID argument);
+#else
+    static void* thread_main(void* argument);
+#endif
+
+private:
+    /* Private member variables */
+
+    /* Threads */
+    uint num_threads; /* Including the calling thread */
+    std::vector<thread_argument> arguments; /* One per worker thread, must not move while the threads run */
+    std::vector<double> busy_times; /* [s] Per thread, the time spent running tasks */
+#ifdef _WIN32
+    std::vector<HANDLE>     threads;
+    CRITICAL_SECTION        mutex;
+    CONDITION_VARIABLE      work_posted;
+    CONDITION_VARIABLE      job_finished;
+#else
+    std::vector<pthread_t>  threads;
+    pthread_mutex_t         mutex;
+    pthread_cond_t          work_posted;
+    pthread_cond_t          job_finished;
+#endif
+
+    /* The current job (protected by the mutex) */
+    std::vector<std::deque<task> > queues; /* Per thread, the spawned tasks that have not been taken yet */
+    range_function range_job_function;
+    uint           grain_size; /* Ranges larger than this are split in two */
+    uint           num_pending_tasks; /* Spawned but not finished */
+    uint           generation; /* Increased for every new job */
+    uint           num_busy_workers;
+    bool           quitting;
+    bool           failed;
+    std::string    failure_message; /* The message of the first exception thrown by a task */
+
+private:
+    /*************************
+     * Disabled constructors *
+     *************************/
+    threadpool(threadpool&); // Copy constructor prevented from all use
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+uint threadpool::get_number_of_threads() const
+{
+    return num_threads;
+}
+
+/* The time thread part has spent running tasks since the busy times were last reset */
+inline
+double threadpool::get_busy_time(uint part) const
+{
+    return busy_times[part];
+}
+
+#endif // THREADPOOL_H
@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdexcept>
+using std::out_of_range;
+
+// Own includes
+#include "velocitykernel.h"
+#include "compile_time.h"
+
+#if  HAS_VECTOR_INSTRUCTIONS
+// Intrinsics (some of them warn about their own placeholder operand with some versions of GCC)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+
+/*
+ * The kernels must not fuse the multiplications and additions, since the scalar
+ * code, which is compiled without FMA, does not either
+ */
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+namespace velocitykernel {
+
+////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+namespace {
+
+const pftype WATER_DENSITY_COEFF = NORMAL_WATER_DENSITY - NORMAL_AIR_DENSITY; /* See physics::vol_coeffs_to_density */
+const pftype AIR_DENSITY_COEFF   = NORMAL_AIR_DENSITY;
+
+void update_velocities_scalar(leafstore& lf, uint first, uint end, pftype dt)
+{
+    for (uint f = first; f < end; f++) {
+        uint idx = lf.velocity_face_cell    [f];
+        uint ni  = lf.velocity_face_neighbor[f];
+        pftype own_mass_per_unit_area = lf.get_density(idx)*lf.s[idx]; // [kg/m^2]
+        pftype average_density = (lf.get_density(ni)*lf.s[ni] + own_mass_per_unit_area)/(lf.s[ni] + lf.s[idx]); // [kg/m^3]
+        lf.velocity_face[f]->update_velocity(lf.p[idx], lf.p[ni], average_density, dt);
+    }
+}
+
+#if  HAS_VECTOR_INSTRUCTIONS
+
+STATIC_ASSERT(sizeof(pftype) == sizeof(double));
+STATIC_ASSERT(sizeof(octface*) == sizeof(long long));
+
+/* The arrays of a leaf store as plain doubles */
+inline
+const double* raw(const std::vector<pftype>& v)
+{
+    return reinterpret_cast<const double*>(&v[0]);
+}
+
+/* How far the velocity is from the start of a face */
+inline
+long long get_velocity_offset(const octface* f)
+{
+    return reinterpret_cast<const char*>(&f->vel) - reinterpret_cast<const char*>(f);
+}
+
+__attribute__((target("avx2")))
+void update_velocities_avx2(leafstore& lf, uint first, uint end, pftype dt)
+{
+    const uint W = 4;
+    if (end - first < W) {
+        update_velocities_scalar(lf, first, end, dt);
+        return;
+    }
+    const double* p  = raw(lf.p);
+    const double* wc = raw(lf.water_vol_coeff);
+    const double* tc = raw(lf.total_vol_coeff);
+    const double* s  = raw(lf.s);
+    const double* dist = raw(lf.velocity_face_dist);
+    const double* g    = raw(lf.velocity_face_g);
+    const uint* cell     = &lf.velocity_face_cell    [0];
+    const uint* neighbor = &lf.velocity_face_neighbor[0];
+    octface* const* face = &lf.velocity_face[0];
+    const __m256i vel_offset = _mm256_set1_epi64x(get_velocity_offset(face[first]));
+    const __m256d water = _mm256_set1_pd(WATER_DENSITY_COEFF);
+    const __m256d air   = _mm256_set1_pd(AIR_DENSITY_COEFF);
+    const __m256d zero  = _mm256_setzero_pd();
+    const __m256d vdt   = _mm256_set1_pd(dt);
+    uint f = first;
+    for (; f + W <= end; f += W) {
+        __m128i i1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cell     + f));
+        __m128i i2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(neighbor + f));
+        __m256d p1 = _mm256_i32gather_pd(p, i1, 8);
+        __m256d p2 = _mm256_i32gather_pd(p, i2, 8);
+        __m256d s1 = _mm256_i32gather_pd(s, i1, 8);
+        __m256d s2 = _mm256_i32gather_pd(s, i2, 8);
+        __m256d rho1 = _mm256_add_pd(_mm256_mul_pd(_mm256_i32gather_pd(wc, i1, 8), water), _mm256_mul_pd(_mm256_i32gather_pd(tc, i1, 8), air));
+        __m256d rho2 = _mm256_add_pd(_mm256_mul_pd(_mm256_i32gather_pd(wc, i2, 8), water), _mm256_mul_pd(_mm256_i32gather_pd(tc, i2, 8), air));
+        __m256d average_density = _mm256_div_pd(_mm256_add_pd(_mm256_mul_pd(rho2, s2), _mm256_mul_pd(rho1, s1)), _mm256_add_pd(s2, s1));
+#if  NO_ATMOSPHERE
+        average_density = _mm256_set1_pd(NORMAL_WATER_DENSITY);
+#endif
+        __m256i addresses = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(face + f)), vel_offset);
+        __m256d vel = _mm256_i64gather_pd(static_cast<const double*>(0), addresses, 1);
+        __m256d acceleration = _mm256_sub_pd(_mm256_div_pd(_mm256_sub_pd(p1, p2), _mm256_mul_pd(_mm256_loadu_pd(dist + f), average_density)), _mm256_loadu_pd(g + f));
+        __m256d new_vel = _mm256_add_pd(vel, _mm256_mul_pd(acceleration, vdt));
+#if  !NO_ATMOSPHERE
+        /* Nothing to accelerate where there is no mass */
+        new_vel = _mm256_blendv_pd(vel, new_vel, _mm256_cmp_pd(average_density, zero, _CMP_NEQ_UQ));
+#endif
+        double result[W];
+        _mm256_storeu_pd(result, new_vel);
+        for (uint lane = 0; lane < W; lane++) {
+            face[f + lane]->vel = result[lane];
+        }
+    }
+    update_velocities_scalar(lf, f, end, dt);
+}
+
+__attribute__((target("avx512f")))
+void update_velocities_avx512(leafstore& lf, uint first, uint end, pftype dt)
+{
+    const uint W = 8;
+    if (end - first < W) {
+        update_velocities_scalar(lf, first, end, dt);
+        return;
+    }
+    const double* p  = raw(lf.p);
+    const double* wc = raw(lf.water_vol_coeff);
+    const double* tc = raw(lf.total_vol_coeff);
+    const double* s  = raw(lf.s);
+    const double* dist = raw(lf.velocity_face_dist);
+    const double* g    = raw(lf.velocity_face_g);
+    const uint* cell     = &lf.velocity_face_cell    [0];
+    const uint* neighbor = &lf.velocity_face_neighbor[0];
+    octface* const* face = &lf.velocity_face[0];
+    const __m512i vel_offset = _mm512_set1_epi64(get_velocity_offset(face[first]));
+    const __m512d water = _mm512_set1_pd(WATER_DENSITY_COEFF);
+    const __m512d air   = _mm512_set1_pd(AIR_DENSITY_COEFF);
+    const __m512d zero  = _mm512_setzero_pd();
+    const __m512d vdt   = _mm512_set1_pd(dt);
+    uint f = first;
+    for (; f + W <= end; f += W) {
+        __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cell     + f));
+        __m256i i2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(neighbor + f));
+        __m512d p1 = _mm512_i32gather_pd(i1, p, 8);
+        __m512d p2 = _mm512_i32gather_pd(i2, p, 8);
+        __m512d s1 = _mm512_i32gather_pd(i1, s, 8);
+        __m512d s2 = _mm512_i32gather_pd(i2, s, 8);
+        __m512d rho1 = _mm512_add_pd(_mm512_mul_pd(_mm512_i32gather_pd(i1, wc, 8), water), _mm512_mul_pd(_mm512_i32gather_pd(i1, tc, 8), air));
+        __m512d rho2 = _mm512_add_pd(_mm512_mul_pd(_mm512_i32gather_pd(i2, wc, 8), water), _mm512_mul_pd(_mm512_i32gather_pd(i2, tc, 8), air));
+        __m512d average_density = _mm512_div_pd(_mm512_add_pd(_mm512_mul_pd(rho2, s2), _mm512_mul_pd(rho1, s1)), _mm512_add_pd(s2, s1));
+#if  NO_ATMOSPHERE
+        average_density = _mm512_set1_pd(NORMAL_WATER_DENSITY);
+        __mmask8 accelerated = 0xFF;
+#else
+        /* Nothing to accelerate where there is no mass */
+        __mmask8 accelerated = _mm512_cmp_pd_mask(average_density, zero, _CMP_NEQ_UQ);
+#endif
+        __m512i addresses = _mm512_add_epi64(_mm512_loadu_si512(face + f), vel_offset);
+        __m512d vel = _mm512_i64gather_pd(addresses, static_cast<const double*>(0), 1);
+        __m512d acceleration = _mm512_sub_pd(_mm512_div_pd(_mm512_sub_pd(p1, p2), _mm512_mul_pd(_mm512_loadu_pd(dist + f), average_density)), _mm512_loadu_pd(g + f));
+        __m512d new_vel = _mm512_add_pd(vel, _mm512_mul_pd(acceleration, vdt));
+        _mm512_mask_i64scatter_pd(static_cast<double*>(0), accelerated, addresses, new_vel, 1);
+    }
+    update_velocities_scalar(lf, f, end, dt);
+}
+
+#endif // HAS_VECTOR_INSTRUCTIONS
+
+} // namespace
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+////////////////////////////////////////////////////////////////
+
+/* Updates the velocities of the velocity faces first up to end of the leaf store */
+void update_velocities(INSTRUCTION_SET instruction_set, leafstore& lf, uint first, uint end, pftype dt)
+{
+#if  DEBUG
+    if (first > end || end > lf.velocity_face.size()) {
+        throw out_of_range("Trying to update the velocities of velocity faces that are not in the leaf store");
+    }
+    if (!instructionset::is_supported(instruction_set)) {
+        throw out_of_range("Trying to update velocities with an instruction set that is not supported");
+    }
+#endif
+    switch (instruction_set) {
+#if  HAS_VECTOR_INSTRUCTIONS
+    case IS_AVX2:
+        update_velocities_avx2(lf, first, end, dt);
+        break;
+    case IS_AVX512:
+        update_velocities_avx512(lf, first, end, dt);
+        break;
+#endif
+    default:
+        update_velocities_scalar(lf, first, end, dt);
+        break;
+    }
+}
+
+} // namespace velocitykernel
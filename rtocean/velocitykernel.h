@@ -0,0 +1,32 @@
+#ifndef VELOCITYKERNEL_H
+#define VELOCITYKERNEL_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "leafstore.h"
+#include "instructionset.h"
+
+/*
+ * The update of the face velocities by the pressure gradients and gravity (see
+ * octface::update_velocity), run as one kernel over a range of the velocity faces
+ * of a leaf store. The pressures and the densities of the two cells are gathered
+ * per face, and the new velocities are written back to the faces.
+ *
+ * Every instruction set calculates each velocity with the same operations in the
+ * same order as octface::update_velocity, so they all give the same result to the
+ * last bit. The vector kernels also fetch the face velocities by address.
+ */
+namespace velocitykernel {
+
+////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////
+
+void update_velocities(INSTRUCTION_SET instruction_set, leafstore& lf, uint first, uint end, pftype dt);
+
+} // namespace velocitykernel
+
+#endif // VELOCITYKERNEL_H
@@ -1,584 +1,1522 @@
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-// Own includes
-#include "watersystem.h"
-#include "physics.h"
-
-#if  DEBUG
-#include <iostream>
-#include <iomanip>
-using std::cout;
-using std::endl;
-using std::setprecision;
-#endif
-
-////////////////////////////////////////////////////////////////
-// MACROS
-////////////////////////////////////////////////////////////////
-
-#define  DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(function, cell)        \
-    if ((cell)->has_child_array()) {                                 \
-        for (uint idx = 0; idx < octcell::MAX_NUM_CHILDREN; idx++) { \
-            if ((cell)->has_child(idx)) {                            \
-                /* Child exists */                                   \
-                octcell* c = (cell)->get_child(idx);                 \
-                (function)(c);                                       \
-            }                                                        \
-        }                                                            \
-        return;                                                      \
-    }
-
-////////////////////////////////////////////////////////////////
-// CONSTRUCTORS AND DESTRUCTOR
-////////////////////////////////////////////////////////////////
-
-watersystem::watersystem()
-{
-    w = 0;
-    max_v = 0;
-    operating = false;
-    num_time_steps_before_resting = 1;
-}
-
-////////////////////////////////////////////////////////////////
-// PUBLIC METHODS
-////////////////////////////////////////////////////////////////
-
-/* Control */
-
-void watersystem::evolve()
-{
-    start_operation();
-#if  DEBUG
-    if (!dt) {
-        throw logic_error("Trying to evolve system but time step is not defined");
-    }
-    if (!is_water_defined()) {
-        throw logic_error("Trying to evolve system while water is not defined");
-    }
-#endif
-    _evolve();
-    finish_operation();
-}
-
-int watersystem::run_simulation(pftype time_step)
-{
-    start_operation();
-    int ret = 0;
-    set_time_step(time_step);
-
-    started = true;
-    paused = false;
-    uint num_time_steps_until_resting = num_time_steps_before_resting;
-    while (!abort && !(paused && break_main_loop_when_pausing)) {
-        if (!num_time_steps_until_resting) {
-            /* Process everything that needs to be processed */
-            process_events();
-            num_time_steps_until_resting = num_time_steps_before_resting - 1;
-        }
-        else {
-            num_time_steps_until_resting--;
-        }
-
-        /* Evolve the system */
-        if (!paused) {
-            _evolve();
-        }
-    }
-
-    if (abort) {
-        ret = SR_ABORTED;
-    }
-    else if (paused) {
-        ret = SR_PAUSED;
-    }
-
-    finish_operation();
-    return ret;
-}
-
-////////////////////////////////////////////////////////////////
-// PRIVATE METHODS
-////////////////////////////////////////////////////////////////
-
-void watersystem::_evolve()
-{
-    static size_t current_print_screen_index = 0;
-    /* Check if dt needs to be decreased */
-    if (max_v) {
-        dt *= MAX_RECOMMENDED_V / max_v;
-        if (dt > max_dt) {
-            dt = max_dt;
-        }
-    }
-    else {
-        dt = max_dt;
-    }
-    max_v = 0;
-    /* Check if next_print_screen is going to be taken after this time step */
-    bool take_printscreen_after_time_step = false;
-    if (current_print_screen_index < NUM_PRINTSCREEN_TIMES &&
-            t + dt >= PRINTSCREEN_TIMES[current_print_screen_index]) {
-        take_printscreen_after_time_step = true;
-        dt = PRINTSCREEN_TIMES[current_print_screen_index] - t;
-#if  DEBUG
-        if (dt < 0) {
-            throw logic_error("Want's to step back in time because if printscreen");
-        }
-#endif
-    }
-    /* Update the time */
-    if (take_printscreen_after_time_step) {
-        t = PRINTSCREEN_TIMES[current_print_screen_index];
-        current_print_screen_index++;
-    }
-    else {
-        t += dt;
-    }
-    /* Calculate cell-center velocity vectors */
-    calculate_cell_center_properties_recursively(w->root);
-    /*
-     * Calculate cell-face alpha
-     * Calculate cell-face quasi-momentum vectors using the cell-face alpha and an UPWIND scheme.
-     */
-    calculate_cell_face_properties_recursively(w->root);
-    /*
-     * Advect mass
-     * Calculate the net quasi-momentum inflow in each cell
-     * Calculate the quasi-momentum increase in cell-faces due to increase of density in cells and remove that value from the net quasi-momentum increase
-     */
-    advect_cell_properties_recursivelly(w->root);
-
-    /* Convert cell-face velocity out to quasi-momentum out */
-    //convert_cell_face_vel_out_to_quasi_momentum_out_recursively(w->root);
-    //TODO: Distribute the remainding net quasi-momentum in the cells on the cell faces equaly per unit area
-    distribute_ceLl_quasi_momentum_on_cell_faces_recursively(w->root);
-    /* Convert cell-face quasi-momentum out to velocity out */
-    //convert_cell_face_quasi_momentum_out_to_vel_out_recursively(w->root);
-
-    update_velocities_by_the_pressure_gradients_recursively(w->root);
-
-    if (take_printscreen_after_time_step && take_printscreen_callback.is_defined()) {
-        take_printscreen_callback.func(take_printscreen_callback.param);
-    }
-}
-
-/*
- * Calculates cell center velocity vector
- */
-void watersystem::calculate_cell_center_properties_recursively(octcell* cell)
-{
-    DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(calculate_cell_face_properties_recursively, cell);
-
-    /* Reset cell-center velocity */
-    cell->ccv = pfvec();
-
-    /* Calculate new cell-center velocity averaged from the cell faces */
-    if (cell->has_fluid()) {
-        pfvec weights; /* The weights in all three directins */
-        pftype own_cell_density = cell->get_density();
-        nlset lists;
-        cell->add_leaf_neighbor_lists_to_list_set(lists);
-        for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-            pftype weight = node->v.cf_area*(own_cell_density + node->v.n->get_density());
-            cell->ccv[node->v.dim] += weight * node->v.get_vel_in_pos_dir();
-            weights[node->v.dim] += weight;
-        }
-        for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
-            if (weights[dim]) {
-                cell->ccv[dim] /= weights[dim];
-            }
-            else {
-                //TODO: Handle this case (it can occur for empty surface cells when the velocity shound't be non-zero)
-            }
-        }
-    }
-}
-
-/*
- * Calculates cell face alpha
- */
-void watersystem::calculate_cell_face_properties_recursively(octcell* cell)
-{
-    DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(calculate_cell_face_properties_recursively, cell);
-
-    /* Calculate cell-face alpha */
-    nlset lists;
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-#if    ALPHA_ADVECTION_SCHEME == UPWIND
-    /* UPWIND gives smearing!!! */
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.vel_out > 0) {
-            node->v.set_volume_coefficients(cell->water_vol_coeff, cell->total_vol_coeff);
-        }
-    }
-#elif  ALPHA_ADVECTION_SCHEME == HRIC || ALPHA_ADVECTION_SCHEME == HYPER_C || ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
-    /* Find average donor neighbor alpha */
-    pftype v = 0; // [1] Courant number
-    pftype average_donor_neighbor_alpha; // [1]
-    pftype cell_alpha = cell->total_vol_coeff ? cell->get_alpha() : pftype(0); // [1]
-    pftype guessed_water_in_volume_flux = 0; // [m^3/s]
-    pftype guessed_total_in_volume_flux = 0; // [m^3/s]
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.vel_out < 0) {
-            guessed_water_in_volume_flux -= node->v.n->water_vol_coeff * node->v.vel_out * node->v.cf_area;
-            guessed_total_in_volume_flux -= node->v.n->total_vol_coeff * node->v.vel_out * node->v.cf_area;
-        }
-        else {
-            pftype face_total_vol_coeff = cell->total_vol_coeff; // [1] Will depend on which scheme that is used to advect total volume (currently UPWIND)
-            pftype face_total_vol_fluxed = face_total_vol_coeff * node->v.vel_out * node->v.cf_area * dt; // [m^3]
-            v += face_total_vol_fluxed/cell->get_total_fluid_volume();
-        }
-    }
-#if COURANT_NUMBER_LIMITATION
-    if (v > max_v) {
-        max_v = v;
-    }
-#endif
-#if  DEBUG
-    if (v > 1) {
-        std::cerr << "Warning! Courant number > 1 ( = " << v << endl;
-        if (v > MAX_ALLOWED_V) {
-            throw logic_error("Courant number larger than MAX_ALLOWED_V");
-        }
-    }
-#endif
-    if (guessed_total_in_volume_flux) {
-        average_donor_neighbor_alpha = guessed_water_in_volume_flux/guessed_total_in_volume_flux;
-    }
-    else {
-        average_donor_neighbor_alpha = cell_alpha;
-    }
-    //v = guessed_water_in_volume_flux * dt / cell->get_cube_volume();
-
-    /* Set out volume coefficients to acceptor neighbors */
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.vel_out > 0) {
-            pftype acceptor_neighbor_alpha = node->v.n->total_vol_coeff ? node->v.n->get_alpha() : pftype(0); // [1]
-#if  ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
-            if (acceptor_neighbor_alpha > cell_alpha) {
-                acceptor_neighbor_alpha = 1;
-            }
-            else if (acceptor_neighbor_alpha < cell_alpha) {
-                acceptor_neighbor_alpha = 0;
-            }
-#endif
-            pftype face_alpha;
-            pftype face_total_vol_coeff = cell->total_vol_coeff; // [1]
-            if (acceptor_neighbor_alpha == average_donor_neighbor_alpha) {
-#if  ALPHA_ADVECTION_SCHEME == HRIC || ALPHA_ADVECTION_SCHEME == HYPER_C || ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
-                face_alpha = cell_alpha;
-#endif
-            }
-            else {
-                pftype cell_normalized_variable =
-                        (cell_alpha - average_donor_neighbor_alpha) /
-                        (acceptor_neighbor_alpha - average_donor_neighbor_alpha); // [1]
-                pftype face_normalized_variable; // [1];
-                if (cell_normalized_variable > 1 || cell_normalized_variable < 0) {
-                    /* Outer domain */
-                    face_normalized_variable = cell_normalized_variable;
-                }
-#if  ALPHA_ADVECTION_SCHEME == HRIC
-                else if (cell_normalized_variable < 0.5) {
-                    /* Inner domain */
-                    face_normalized_variable = 2 * cell_normalized_variable;
-                }
-#elif  ALPHA_ADVECTION_SCHEME == HYPER_C || ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
-                else if (cell_normalized_variable < v) {
-                    /* Inner domain */
-                    face_normalized_variable = cell_normalized_variable / v;
-                }
-#endif
-                else {
-                    face_normalized_variable = 1;
-                }
-
-                if (face_normalized_variable == 1) {
-                    face_alpha = acceptor_neighbor_alpha;
-                }
-                else if (face_normalized_variable == cell_normalized_variable) {
-                    face_alpha = cell_alpha;
-                }
-                else {
-                    face_alpha = average_donor_neighbor_alpha + face_normalized_variable * (acceptor_neighbor_alpha - average_donor_neighbor_alpha); // [1]
-                }
-#if  DEBUG
-                if (average_donor_neighbor_alpha < 0 || average_donor_neighbor_alpha > 1) {
-                    cout << "average_donor_neighbor_alpha: " << average_donor_neighbor_alpha << endl;
-                    throw logic_error("Strange value for average_donor_neighbor_alpha");
-                }
-                if (acceptor_neighbor_alpha < 0 || acceptor_neighbor_alpha > 1) {
-                    cout << "acceptor_neighbor_alpha: " << acceptor_neighbor_alpha << endl;
-                    throw logic_error("Strange value for acceptor_neighbor_alpha");
-                }
-                if (cell_alpha < 0 || cell_alpha > 1) {
-                    cout << "cell_alpha: " << cell_alpha << endl;
-                    throw logic_error("Strange value for cell_alpha");
-                }
-                if (face_alpha < 0 || face_alpha > 1) {
-                    cout << "face_alpha: " << face_alpha << endl;
-                    throw logic_error("Strange value for face_alpha");
-                }
-#endif
-            }
-            pftype face_water_vol_coeff = face_alpha * face_total_vol_coeff; // [1]
-            node->v.set_volume_coefficients(face_water_vol_coeff, face_total_vol_coeff);
-        }
-    }
-#else
-    "Don't know how to advect water"
-#endif // ALPHA_ADVECTION_SCHEME
-
-    //TODO: Calculate cell-face quasi-momentum scalars
-
-    /* Calculate cell-face quasi-momentum vectors using the UPWIND scheme */
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.vel_out >= 0) {
-            node->v.quasi_momentum_vector = cell->ccv * node->v.get_cell_face_density();
-        }
-    }
-}
-
-void watersystem::advect_cell_properties_recursivelly(octcell* cell)
-{
-    DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(advect_cell_properties_recursivelly, cell);
-
-    /*
-     * Update volume coefficients
-     * Calculate in quasi-momentum flux
-     */
-    pftype in_water_vol_flux = 0; // [m^3/s]
-    pftype in_total_vol_flux = 0; // [m^3/s]
-    pfvec  in_momentum_flux; // [kg*m/s^2] in momentum flux
-    pfvec  total_cell_face_area_velocity; // [m^3/s]
-
-    /* Loop through neighbors */
-    nlset lists;
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        pftype volume_flux_out = node->v.vel_out * node->v.cf_area; // [m^3/s]
-        in_water_vol_flux -= node->v.water_vol_coeff * volume_flux_out;
-        in_total_vol_flux -= node->v.total_vol_coeff * volume_flux_out;
-        in_momentum_flux -= node->v.quasi_momentum_vector * volume_flux_out;
-        total_cell_face_area_velocity[node->v.dim] += node->v.get_vel_in_pos_dir() * node->v.cf_area;
-    }
-
-    pftype volume_flux_to_volume_coefficient_factor = dt/cell->get_cube_volume(); /* [s/m^3] */
-    pftype d_water_vol_coeff = in_water_vol_flux * volume_flux_to_volume_coefficient_factor; /* [1] */
-    pftype d_total_vol_coeff = in_total_vol_flux * volume_flux_to_volume_coefficient_factor; /* [1] */
-    pftype d_density = physics::vol_coeffs_to_density(d_water_vol_coeff, d_total_vol_coeff); /* [kg/m^3] */
-    pfvec net_momentum_in_flow = dt * in_momentum_flux; // [kg*m/s] Net in momentum
-    cell->momentum_to_distribute = net_momentum_in_flow - d_density * total_cell_face_area_velocity * (0.5 * cell->s);
-
-    const pftype LIMIT = 4.0e-16 * (USE_DOUBLE_PRECISION_FOR_PHYSICS ? 1 : 1 << (52 - 23));
-    bool okay_to_decrease_water = false;
-    bool okay_to_increase_water = false;
-    bool no_fluid_left = false;
-    if (cell->total_vol_coeff + d_total_vol_coeff < 0 &&
-            cell->total_vol_coeff + d_total_vol_coeff > -LIMIT) {
-        no_fluid_left = true;
-    }
-    if (((cell->water_vol_coeff + d_water_vol_coeff) > (cell->total_vol_coeff + d_total_vol_coeff) &&
-         (cell->water_vol_coeff + d_water_vol_coeff) - (cell->total_vol_coeff + d_total_vol_coeff) < LIMIT) ||
-            ((cell->water_vol_coeff + d_water_vol_coeff) < (cell->total_vol_coeff + d_total_vol_coeff) &&
-             (cell->water_vol_coeff + d_water_vol_coeff) - (cell->total_vol_coeff + d_total_vol_coeff) > -LIMIT)) {
-        okay_to_decrease_water = true;
-    }
-    if ((cell->water_vol_coeff + d_water_vol_coeff < 0 &&
-         cell->water_vol_coeff + d_water_vol_coeff > -LIMIT) ||
-            (cell->water_vol_coeff + d_water_vol_coeff > 0 &&
-             cell->water_vol_coeff + d_water_vol_coeff < LIMIT)) {
-        okay_to_increase_water = true;
-    }
-#if  DEBUG
-    if (cell->total_vol_coeff + d_total_vol_coeff < 0 &&
-            !no_fluid_left) {
-        cout << endl;
-        cout << "Advection: Old water volume coefficient: " << cell->water_vol_coeff << endl;
-        cout << "Advection: Old total volume coefficient: " << cell->total_vol_coeff << endl;
-        cout << "Advection: Additional water volume coefficient: " << d_water_vol_coeff << endl;
-        cout << "Advection: Additional total volume coefficient: " << d_total_vol_coeff << endl;
-        cout << "Advectoin: New water volume coefficient: " << cell->water_vol_coeff + d_water_vol_coeff << endl;
-        cout << "Advection: New total volume coefficient: " << cell->total_vol_coeff + d_total_vol_coeff << endl;
-        cout << (okay_to_decrease_water ? "Okay" : "Not okay") << " to decrease water" << endl;
-        cout << (okay_to_increase_water ? "Okay" : "Not okay") << " to increase water" << endl;
-        throw logic_error("New total volume coefficient less than zero");
-    }
-    if (cell->water_vol_coeff + d_water_vol_coeff > cell->total_vol_coeff + d_total_vol_coeff &&
-            !okay_to_decrease_water) {
-        cout << endl;
-        cout << "Advection: Old water volume coefficient: " << cell->water_vol_coeff << endl;
-        cout << "Advection: Old total volume coefficient: " << cell->total_vol_coeff << endl;
-        cout << "Advection: Additional water volume coefficient: " << d_water_vol_coeff << endl;
-        cout << "Advection: Additional total volume coefficient: " << d_total_vol_coeff << endl;
-        cout << "Advectoin: New water volume coefficient: " << cell->water_vol_coeff + d_water_vol_coeff << endl;
-        cout << "Advection: New total volume coefficient: " << cell->total_vol_coeff + d_total_vol_coeff << endl;
-        cout << "Old water volume coefficient is " << cell->total_vol_coeff - cell->water_vol_coeff <<
-                " less than old total volume coefficient" << endl;
-        cout << "New water volume coefficient is " << (cell->water_vol_coeff + d_water_vol_coeff)-(cell->total_vol_coeff + d_total_vol_coeff) <<
-                " more than new total volume coefficient" << endl;
-        throw logic_error("New water volume coefficient more than new total volume coefficient in cell");
-    }
-    if (cell->water_vol_coeff + d_water_vol_coeff < 0 &&
-            !okay_to_increase_water) {
-        cout << endl;
-        cout << "Advection: Old water volume coefficient: " << cell->water_vol_coeff << endl;
-        cout << "Advection: Old total volume coefficient: " << cell->total_vol_coeff << endl;
-        cout << "Advection: Additional water volume coefficient: " << d_water_vol_coeff << endl;
-        cout << "Advection: Additional total volume coefficient: " << d_total_vol_coeff << endl;
-        cout << "Advectoin: New water volume coefficient: " << cell->water_vol_coeff + d_water_vol_coeff << endl;
-        cout << "Advection: New total volume coefficient: " << cell->total_vol_coeff + d_total_vol_coeff << endl;
-        throw logic_error("New water volume coefficient less than zero");
-    }
-#endif
-    if (!cell->water_vol_coeff && d_water_vol_coeff) {
-        cell->prepare_for_water();
-    }
-
-#if  NO_ATMOSPHERE
-#define TRY_TO_MAINTAIN_FULL_AIR_CELLS  0 // Experimental
-#else
-#define TRY_TO_MAINTAIN_FULL_AIR_CELLS  0 // Don't change this value
-#endif
-    if (no_fluid_left) {
-#if TRY_TO_MAINTAIN_FULL_AIR_CELLS
-        cell->set_volume_coefficients(0,
-                                      1);
-#else
-        cell->set_volume_coefficients(0,
-                                      0);
-#endif
-    }
-    else if (okay_to_decrease_water) {
-        cell->set_volume_coefficients(cell->total_vol_coeff + d_total_vol_coeff,
-                                      cell->total_vol_coeff + d_total_vol_coeff);
-    }
-    else if (okay_to_increase_water) {
-#if TRY_TO_MAINTAIN_FULL_AIR_CELLS
-        cell->set_volume_coefficients(0,
-                                      1);
-#else
-        cell->set_volume_coefficients(0,
-                                      cell->total_vol_coeff + d_total_vol_coeff);
-#endif
-    }
-    else {
-#if  TRY_TO_MAINTAIN_FULL_AIR_CELLS
-        if ((cell->total_vol_coeff + d_total_vol_coeff) - (cell->water_vol_coeff + d_water_vol_coeff) > 0.2) {
-            cell->set_volume_coefficients(cell->water_vol_coeff + d_water_vol_coeff,
-                                          1);
-        }
-        else {
-            cell->set_volume_coefficients(cell->water_vol_coeff + d_water_vol_coeff,
-                                          cell->total_vol_coeff + d_total_vol_coeff);
-        }
-#else
-        cell->set_volume_coefficients(cell->water_vol_coeff + d_water_vol_coeff,
-                                      cell->total_vol_coeff + d_total_vol_coeff);
-#endif
-    }
-
-#if  DEBUG
-    if (cell->water_vol_coeff < 0) {
-        throw logic_error("Water volume coefficient became negative");
-    }
-    if (cell->total_vol_coeff < 0) {
-        throw logic_error("Total volume coefficient became negative");
-    }
-    if (cell->water_vol_coeff > cell->total_vol_coeff) {
-        throw logic_error("Water volume coefficient became larger than total volume coefficient");
-    }
-#endif
-}
-
-#if 0
-void watersystem::convert_cell_face_vel_out_to_quasi_momentum_out_recursively(octcell* cell)
-{
-    DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(convert_cell_face_vel_out_to_quasi_momentum_out_recursively, cell);
-
-    /* Loop through neighbors */
-    nlset lists;
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        node->v.quasi_momentum_out = node->v.vel_out * node->v.get_average_cell_density();
-    }
-}
-
-void watersystem::convert_cell_face_quasi_momentum_out_to_vel_out_recursively(octcell* cell)
-{
-    DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(convert_cell_face_quasi_momentum_out_to_vel_out_recursively, cell);
-
-    /* Loop through neighbors */
-    nlset lists;
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.quasi_momentum_out) {
-            node->v.vel_out = node->v.quasi_momentum_out / node->v.get_average_cell_density();
-#if  DEBUG
-            if (!node->v.get_average_cell_density()) {
-                throw logic_error("Cell face has quasi momentum out but no density");
-            }
-#endif
-        }
-    }
-}
-#endif
-
-void watersystem::distribute_ceLl_quasi_momentum_on_cell_faces_recursively(octcell* cell)
-{
-    DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(distribute_ceLl_quasi_momentum_on_cell_faces_recursively, cell);
-
-    /* Measure areas */
-    pfvec areas;
-    nlset lists;
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        areas[node->v.dim] += node->v.cf_area;
-    }
-    /* Distribute quasi momentum */
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        node->v.vel_out += node->v.get_signed_dir() *
-                cell->momentum_to_distribute[node->v.dim]/(node->v.get_associated_mass_per_unit_area() * areas[node->v.dim]);
-    }
-}
-
-void watersystem::update_velocities_by_the_pressure_gradients_recursively(octcell* cell)
-{
-    DECLARE_RECURSIVE_LEAF_CELL_FUNCTION(update_velocities_by_the_pressure_gradients_recursively, cell);
-
-    /* Cell is a leaf cell */
-    /* Loop through neighbors */
-    nlset lists;
-    cell->add_leaf_neighbor_lists_to_list_set(lists);
-    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
-        if (node->v.should_calculate_new_velocity()) {
-            node->v.update_velocity(cell, node->v.n, dt);
-        }
-    }
-}
-
-/* Thread safety */
-
-void watersystem::start_operation()
-{
-    while (operating) {
-        // Wait for the other operation to finish
-        process_events();
-    }
-    operating = true;
-    abort = false;
-}
-
-void watersystem::finish_operation()
-{
-    if (!operating) {
-        throw logic_error("Tried to finish operation while not operating");
-    }
-    operating = false;
-}
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+// Own includes
+#include "watersystem.h"
+#include "physics.h"
+
+#if  DEBUG
+#include <iostream>
+#include <iomanip>
+using std::cout;
+using std::endl;
+using std::setprecision;
+#endif
+
+////////////////////////////////////////////////////////////////
+// MACROS
+////////////////////////////////////////////////////////////////
+
+#define  DECLARE_LEAF_CELL_LOOP(function)                          \
+    update_leaf_store();                                         \
+    for (uint idx = get_first_cell(); idx < get_end_cell(); idx++) { \
+        (function)(idx);                                         \
+    }
+
+/* For passes that only write to the cell being handled and to the faces it owns (see octface) */
+#define  DECLARE_PARALLEL_LEAF_CELL_LOOP(function)                 \
+    update_leaf_store();                                         \
+    workers.run_range(&watersystem::run_leaf_pass<&watersystem::function>, this, get_first_cell(), get_end_cell(), SOLVER_GRAIN_SIZE);
+
+////////////////////////////////////////////////////////////////
+// CONSTRUCTORS AND DESTRUCTOR
+////////////////////////////////////////////////////////////////
+
+watersystem::watersystem()
+{
+    w = 0;
+    max_v = 0;
+    current_print_screen_index = 0;
+    operating = false;
+    num_time_steps_before_resting = 1;
+    workers.set_number_of_threads(NUM_SOLVER_THREADS);
+    passes_fused = FUSE_SOLVER_PASSES;
+    domain = 0;
+    num_cell_updates = 0;
+    time_step_levels = TIME_STEP_LEVELS;
+    active_time_step_class = 0;
+    time_step_class_generation = 0;
+    time_step_classes_found = false;
+    regrid_interval = REGRID_INTERVAL;
+    num_time_steps_until_regridding = regrid_interval;
+    regridding = regrid_stats();
+#if  SIMD_SOLVER_KERNELS
+    instruction_set = instructionset::get_best();
+#else
+    instruction_set = IS_SCALAR;
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+/* Control */
+
+void watersystem::evolve()
+{
+    start_operation();
+#if  DEBUG
+    if (!dt) {
+        throw logic_error("Trying to evolve system but time step is not defined");
+    }
+    if (!is_water_defined()) {
+        throw logic_error("Trying to evolve system while water is not defined");
+    }
+#endif
+    _evolve();
+    finish_operation();
+}
+
+int watersystem::run_simulation(pftype time_step)
+{
+    start_operation();
+    int ret = 0;
+    set_time_step(time_step);
+
+    started = true;
+    paused = false;
+    uint num_time_steps_until_resting = num_time_steps_before_resting;
+    while (!abort && !(paused && break_main_loop_when_pausing)) {
+        if (!num_time_steps_until_resting) {
+            /* Process everything that needs to be processed */
+            process_events();
+            num_time_steps_until_resting = num_time_steps_before_resting - 1;
+        }
+        else {
+            num_time_steps_until_resting--;
+        }
+
+        /* Evolve the system */
+        if (!paused) {
+            _evolve();
+        }
+    }
+
+    if (abort) {
+        ret = SR_ABORTED;
+    }
+    else if (paused) {
+        ret = SR_PAUSED;
+    }
+
+    finish_operation();
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+////////////////////////////////////////////////////////////////
+
+void watersystem::_evolve()
+{
+    /* Check if dt needs to be decreased */
+    if (max_v) {
+        dt *= MAX_RECOMMENDED_V / max_v;
+        if (dt > max_dt) {
+            dt = max_dt;
+        }
+    }
+    else {
+        dt = max_dt;
+    }
+    max_v = 0;
+    /* The finest cells take this many time steps of dt in one call, see run_multi_rate_cycle */
+    uint num_time_steps = 1 << time_step_levels;
+    /* Check if next_print_screen is going to be taken after this time step */
+    bool take_printscreen_after_time_step = false;
+    if (current_print_screen_index < NUM_PRINTSCREEN_TIMES &&
+            t + dt * num_time_steps >= PRINTSCREEN_TIMES[current_print_screen_index]) {
+        take_printscreen_after_time_step = true;
+        dt = (PRINTSCREEN_TIMES[current_print_screen_index] - t) / num_time_steps;
+#if  DEBUG
+        if (dt < 0) {
+            throw logic_error("Want's to step back in time because if printscreen");
+        }
+#endif
+    }
+    /* Update the time */
+    if (take_printscreen_after_time_step) {
+        t = patype(PRINTSCREEN_TIMES[current_print_screen_index]);
+        current_print_screen_index++;
+    }
+    else {
+        t += patype(dt) * num_time_steps;
+    }
+    if (time_step_levels) {
+        /* The passes below, with the cells of each level stepped at their own rate */
+        run_multi_rate_cycle();
+    }
+    else {
+        if (passes_fused) {
+            /* The same as the two passes below, and as much of the advection as can be done at the same time */
+            calculate_properties_blockwise();
+        }
+        else {
+#if  CALCULATE_CELL_CENTER_VELOCITIES
+            /* Calculate cell-center velocity vectors */
+            calculate_cell_center_properties();
+#endif
+            /*
+             * Calculate cell-face alpha
+             * Calculate cell-face quasi-momentum vectors using the cell-face alpha and an UPWIND scheme.
+             */
+            calculate_cell_face_properties();
+        }
+        if (domain) {
+            /* The time step must be the same in all the processes */
+            max_v = pftype(domain->get_global_max(max_v));
+            domain->exchange_advected_values();
+        }
+        /*
+         * Advect mass
+         * Calculate the net quasi-momentum inflow in each cell
+         * Calculate the quasi-momentum increase in cell-faces due to increase of density in cells and remove that value from the net quasi-momentum increase
+         */
+        advect_cell_properties();
+
+        /* Convert cell-face velocity out to quasi-momentum out */
+        //convert_cell_face_vel_out_to_quasi_momentum_out();
+        //TODO: Distribute the remainding net quasi-momentum in the cells on the cell faces equaly per unit area
+        if (passes_fused && USE_ARTIFICIAL_COMPRESSIBILITY) {
+            /* Both of the passes below in one sweep */
+            update_face_velocities();
+        }
+        else {
+            distribute_ceLl_quasi_momentum_on_cell_faces();
+            /* Convert cell-face quasi-momentum out to velocity out */
+            //convert_cell_face_quasi_momentum_out_to_vel_out();
+
+#if  !USE_ARTIFICIAL_COMPRESSIBILITY
+            /* The pressures that make the velocities divergence free, which need all the quasi-momentum to be distributed */
+            solve_pressures();
+#endif
+            update_velocities_by_the_pressure_gradients();
+        }
+        if (domain) {
+            domain->exchange_velocities();
+        }
+    }
+    if (regrid_interval && !--num_time_steps_until_regridding) {
+        regrid();
+        num_time_steps_until_regridding = regrid_interval;
+    }
+
+    if (take_printscreen_after_time_step && take_printscreen_callback.is_defined()) {
+        take_printscreen_callback.func(take_printscreen_callback.param);
+    }
+}
+
+/*
+ * Multi-rate time stepping
+ *
+ * The Courant number of a cell grows with the velocity and shrinks with the size of the cell, so
+ * the time step is limited by the smallest cells, at the surface, while most of the cells are
+ * larger. Each leaf cell is given a time step class k, the number of levels it is above the
+ * finest leaf cells but at most time_step_levels, and steps with dt*2^k. One call takes
+ * 2^time_step_levels time steps of dt, in which the time steps of a cell of class k end where
+ * the ones of the coarser classes do: at the end of time step s of dt, the classes up to the
+ * number of trailing zero bits of s + 1 step.
+ *
+ * A cell calculates its faces at the start of its time step, and the velocity of a face is
+ * updated with the time step of the coarser of its two cells, so what a cell sends out is given
+ * by the same face values over the whole of its time step, as when all cells step together,
+ * which keeps the advection scheme bounded. What goes through a face between two classes while
+ * the coarser cell waits is summed up by the finer cell and moved to the coarser cell as a whole
+ * when it steps (see sum_multi_rate_fluxes), so the water that one cell loses is exactly what its
+ * neighbors get, and the momentum that the finer cell distributes on such a face waits for the
+ * velocity update of the face. All the sums are used up in the last time step of the cycle, in
+ * which all classes step. The topology is only changed at the end of the cycle, for all the cells
+ * that have got water in it (see prepare_cells_for_water).
+ *
+ * The fused passes are not used, and the water must not be split between processes.
+ */
+void watersystem::run_multi_rate_cycle()
+{
+    update_leaf_store();
+    find_time_step_classes();
+    leafstore& lf = w->leaves;
+    uint num_cells = lf.size();
+    uint num_time_steps = 1 << time_step_levels;
+    advection_results.resize(num_cells);
+    part_wetted_cells.resize(workers.get_number_of_threads());
+    for (uint step = 0; step < num_time_steps; step++) {
+        time_step_in_cycle = step;
+        active_time_step_class = 0;
+        while (active_time_step_class < time_step_levels && !((step + 1) & (1 << active_time_step_class))) {
+            active_time_step_class++;
+        }
+
+        /* Cell-center and cell-face properties of the cells that start a time step */
+        part_max_v.assign(workers.get_number_of_threads(), 0);
+        workers.run_range(&watersystem::run_multi_rate_face_pass, this, 0, num_cells, SOLVER_GRAIN_SIZE);
+        for (uint part = 0; part < part_max_v.size(); part++) {
+            if (part_max_v[part] > max_v) {
+                max_v = part_max_v[part];
+            }
+        }
+
+        /* Advection of the cells that step */
+        workers.run_range(&watersystem::run_stepped_leaf_pass<&watersystem::calculate_advection>, this, 0, num_cells, SOLVER_GRAIN_SIZE);
+        workers.run_range(&watersystem::run_apply_advection_pass, this, 0, num_cells, SOLVER_GRAIN_SIZE);
+#if  LOCAL_EQUATION_OF_STATE
+        /* The cells that have not stepped get the pressures they already have */
+        workers.run_range(&watersystem::run_pressure_pass, this, 0, num_cells, SOLVER_GRAIN_SIZE);
+#endif
+        for (uint k = 0; k <= active_time_step_class; k++) {
+            num_cell_updates += num_cells_in_time_step_class[k];
+        }
+
+        /* Face velocities */
+        workers.run_range(&watersystem::run_stepped_leaf_pass<&watersystem::distribute_ceLl_quasi_momentum_on_cell_faces>, this, 0, num_cells, SOLVER_GRAIN_SIZE);
+        workers.run_range(&watersystem::run_multi_rate_velocity_face_pass, this, 0, lf.first_velocity_face[num_cells], SOLVER_GRAIN_SIZE);
+    }
+    prepare_cells_for_water();
+}
+
+/* Finds the time step class of each leaf cell and face again if the leaf store has been rebuilt */
+void watersystem::find_time_step_classes()
+{
+    const leafstore& lf = w->leaves;
+    if (time_step_classes_found && time_step_class_generation == lf.get_generation()) {
+        return;
+    }
+    uint num_cells = lf.size();
+    uint finest_level = 0;
+    for (uint idx = 0; idx < num_cells; idx++) {
+        finest_level = MAX(finest_level, lf.cell[idx]->lvl);
+    }
+    time_step_class.resize(num_cells);
+    num_cells_in_time_step_class.assign(time_step_levels + 1, 0);
+    for (uint idx = 0; idx < num_cells; idx++) {
+        uint k = MIN(time_step_levels, finest_level - lf.cell[idx]->lvl);
+        time_step_class[idx] = uint8(k);
+        num_cells_in_time_step_class[k]++;
+    }
+    velocity_face_time_step_class.resize(lf.velocity_face.size());
+    for (uint f = 0; f < lf.velocity_face.size(); f++) {
+        velocity_face_time_step_class[f] = MAX(time_step_class[lf.velocity_face_cell[f]], time_step_class[lf.velocity_face_neighbor[f]]);
+    }
+    uint num_faces = 0;
+    for (uint i = 0; i < lf.neighbor_face.size(); i++) {
+        num_faces = MAX(num_faces, lf.neighbor_face[i]->idx + 1);
+    }
+    /* Nothing is left in the sums between two cycles */
+    interface_flux no_flux;
+    no_flux.water_vol = 0;
+    no_flux.total_vol = 0;
+    no_flux.vel_change = 0;
+    interface_fluxes.assign(num_faces, no_flux);
+    time_step_class_generation = lf.get_generation();
+    time_step_classes_found = true;
+}
+
+/* Whether the cell steps in the current time step */
+bool watersystem::is_stepped(uint idx) const
+{
+    return !time_step_levels || time_step_class[idx] <= active_time_step_class;
+}
+
+/* Whether a time step of the cell starts with the current time step */
+bool watersystem::is_starting_time_step(uint idx) const
+{
+    return !time_step_levels || !(time_step_in_cycle & ((1 << time_step_class[idx]) - 1));
+}
+
+/* [s] The time step of the cell */
+pftype watersystem::get_cell_time_step(uint idx) const
+{
+    if (!time_step_levels) {
+        return dt;
+    }
+    return dt * (1 << time_step_class[idx]);
+}
+
+/*
+ * Sums up the volumes and momentum that go into a cell through its faces in its time step, see
+ * run_multi_rate_cycle. A face to a finer cell adds what the finer cell has summed up in its
+ * earlier time steps, and a face to a coarser cell that does not step now has what goes through
+ * it added to the sum of the face.
+ */
+void watersystem::sum_multi_rate_fluxes(uint idx, patype& in_water_vol, patype& in_total_vol, pavec& in_momentum, pavec& total_cell_face_area_velocity)
+{
+    leafstore& lf = w->leaves;
+    uint k = time_step_class[idx];
+    for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+        octface* f = lf.neighbor_face[i];
+        bool pos_dir = lf.neighbor_pos_dir[i];
+        uint neighbor_k = time_step_class[lf.neighbor[i]];
+        interface_flux& sum = interface_fluxes[f->idx];
+        patype sign = pos_dir ? 1 : -1; // The sums are in the positive direction
+        if (neighbor_k < k) {
+            in_water_vol -= sign * sum.water_vol;
+            in_total_vol -= sign * sum.total_vol;
+            in_momentum  -= sign * sum.momentum;
+            sum.water_vol = 0;
+            sum.total_vol = 0;
+            sum.momentum  = pavec();
+        }
+        /* In the time step of the finer of the two cells */
+        patype volume_out = patype(f->get_vel_out(pos_dir)) * f->cf_area * patype(dt * (1 << MIN(k, neighbor_k))); // [m^3]
+        in_water_vol -= f->water_vol_coeff * volume_out;
+        in_total_vol -= f->total_vol_coeff * volume_out;
+        in_momentum  -= pavec(f->quasi_momentum_vector) * volume_out;
+        if (neighbor_k > active_time_step_class) {
+            /* The neighbor is coarser and steps later */
+            patype positive_volume = sign * volume_out; // [m^3]
+            sum.water_vol += f->water_vol_coeff * positive_volume;
+            sum.total_vol += f->total_vol_coeff * positive_volume;
+            sum.momentum  += pavec(f->quasi_momentum_vector) * positive_volume;
+        }
+        total_cell_face_area_velocity[f->dim] += patype(f->vel) * f->cf_area;
+    }
+}
+
+/*
+ * Regridding
+ *
+ * The tree is built with small cells around the surface where it starts (see fvoctree), but the
+ * surface moves away from them. Every regrid_interval time steps (cycles of multi-rate time steps),
+ * the leaf cells at the surface are found (see is_surface_cell), and the size of the cells is
+ * graded by their distance from the nearest surface cell as it is by the depth when the tree is
+ * built (see fvoctree::size_accuracy_below_surface). The distance is measured along the leaf
+ * cells, from center to center. A leaf cell larger than the size accuracy at its distance is
+ * refined, and a cell whose children are all leaf cells is coarsened if it is not larger than the
+ * size accuracy at the distance of its nearest child, less its own edge, so that it is not refined
+ * again at once. So the number of cells follows the length of the surface rather than the extent
+ * the water has had. A cell is refined together with its coarser leaf neighbors and only coarsened
+ * if none of its children has finer neighbors, so the leaf neighbors stay within one level of each
+ * other, and the water volume and the volume fluxes through the faces are kept (see
+ * octcell::refine_and_interpolate).
+ *
+ * The cells to change are listed by their Morton keys and changed in key order, the coarsened ones
+ * first. When the water is split between processes, each of them finds the surface cells and the
+ * cells to change of its own subdomain, and they are all gathered, so that every process measures
+ * the same distances and changes its tree in the same way. The children of a cell coarser than
+ * SUBDOMAIN_LEVEL may be in other subdomains than the cell, so the processes first share the
+ * properties of all the leaf cells (see subdomain::share_leaf_cells).
+ */
+void watersystem::regrid()
+{
+    double start = threadpool::get_seconds();
+    update_leaf_store();
+    const leafstore& lf = w->leaves;
+    uint num_cells = lf.size();
+    uint first = get_first_cell();
+    uint end = get_end_cell();
+
+    /* The surface cells and the unsettled cells, which all processes need to make the same choices */
+    surface_cells.clear();
+    unsettled_cells.clear();
+    for (uint idx = first; idx < end; idx++) {
+        if (is_surface_cell(idx)) {
+            surface_cells.push_back(idx);
+        }
+        if (!is_settled_cell(idx)) {
+            unsettled_cells.push_back(idx);
+        }
+    }
+    uint num_surface_cells = surface_cells.size();
+    if (domain) {
+        domain->all_gather(surface_cells);
+        domain->all_gather(unsettled_cells);
+    }
+    settled.assign(num_cells, 1);
+    for (uint i = 0; i < unsettled_cells.size(); i++) {
+        settled[unsettled_cells[i]] = 0;
+    }
+
+    /* The distance from the surface (Dijkstra's algorithm) */
+    typedef std::pair<double, uint> queued_cell;
+    std::priority_queue<queued_cell, std::vector<queued_cell>, std::greater<queued_cell> > queue;
+    surface_distance.assign(num_cells, std::numeric_limits<double>::max());
+    for (uint i = 0; i < surface_cells.size(); i++) {
+        surface_distance[surface_cells[i]] = 0;
+        queue.push(queued_cell(0, surface_cells[i]));
+    }
+    while (!queue.empty()) {
+        queued_cell q = queue.top();
+        queue.pop();
+        uint idx = q.second;
+        if (q.first > surface_distance[idx]) {
+            /* Already reached by a shorter path */
+            continue;
+        }
+        for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+            uint ni = lf.neighbor[i];
+            double distance = q.first + lf.get_half_edge_length(idx) + lf.get_half_edge_length(ni);
+            if (distance < surface_distance[ni]) {
+                surface_distance[ni] = distance;
+                queue.push(queued_cell(distance, ni));
+            }
+        }
+    }
+
+    /* The cells of this subdomain to change, and the parents of its cells */
+    refine_keys.clear();
+    coarsen_keys.clear();
+    for (uint idx = first; idx < end; idx++) {
+        octcell* c = lf.cell[idx];
+        if (c->get_edge_length() > w->size_accuracy_below_surface(pftype(surface_distance[idx]))) {
+            refine_keys.push_back(c->key);
+            continue;
+        }
+        /* The parent is considered once, by the process of its first child */
+        if (!c->has_parent() || c->get_parent()->get_child(0) != c) {
+            continue;
+        }
+        octcell* parent = c->get_parent();
+        double min_distance = std::numeric_limits<double>::max();
+        bool coarsen = true;
+        for (uint cidx = 0; cidx < octcell::MAX_NUM_CHILDREN && coarsen; cidx++) {
+            octcell* child = parent->has_child(cidx) ? parent->get_child(cidx) : 0;
+            if (!child || !lf.contains(child) || !settled[child->li]) {
+                coarsen = false;
+                break;
+            }
+            min_distance = MIN(min_distance, surface_distance[child->li]);
+        }
+        double edge = parent->get_edge_length();
+        if (coarsen && min_distance > 0 && edge <= w->size_accuracy_below_surface(pftype(MAX(min_distance - edge, 0.0)))) {
+            coarsen_keys.push_back(parent->key);
+        }
+    }
+    if (domain) {
+        domain->all_gather(refine_keys);
+        domain->all_gather(coarsen_keys);
+    }
+    std::sort(refine_keys.begin(), refine_keys.end());
+    std::sort(coarsen_keys.begin(), coarsen_keys.end());
+    if (domain && (!refine_keys.empty() || !coarsen_keys.empty())) {
+        domain->share_leaf_cells(w->leaves);
+    }
+
+    /* Coarsening first, since it may be kept from it by finer cells */
+    for (uint i = 0; i < coarsen_keys.size(); i++) {
+        octcell* c = w->find_cell(coarsen_keys[i]);
+        if (c && c->can_be_coarsened()) {
+            c->coarsen_and_average();
+            regridding.num_coarsened_cells++;
+        }
+    }
+    uint num_refined_cells = 0;
+    for (uint i = 0; i < refine_keys.size(); i++) {
+        octcell* c = w->find_cell(refine_keys[i]);
+        if (c && c->is_leaf()) {
+            num_refined_cells += c->refine_and_interpolate();
+        }
+    }
+    if (num_refined_cells) {
+        /* The children have the velocities of their parents in half the size, which the next time step must allow for */
+        max_v *= 2;
+    }
+    regridding.num_regriddings++;
+    regridding.num_refined_cells += num_refined_cells;
+    regridding.num_surface_cells = num_surface_cells;
+    regridding.time += threadpool::get_seconds() - start;
+}
+
+/* Whether the cell is at the surface: its alpha, or the difference to the alpha of a neighbor, is not close to 0 or 1 */
+bool watersystem::is_surface_cell(uint idx) const
+{
+    const leafstore& lf = w->leaves;
+    pftype alpha = 0;
+    if (lf.total_vol_coeff[idx]) {
+        alpha = lf.get_alpha(idx);
+    }
+    if (alpha > REGRID_ALPHA_TOLERANCE && alpha < 1 - REGRID_ALPHA_TOLERANCE) {
+        return true;
+    }
+    for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+        uint ni = lf.neighbor[i];
+        pftype neighbor_alpha = 0;
+        if (lf.total_vol_coeff[ni]) {
+            neighbor_alpha = lf.get_alpha(ni);
+        }
+        if (ABS(alpha - neighbor_alpha) > REGRID_ALPHA_TOLERANCE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Whether the fluid in the cell is close to the fluid in its siblings next to it, in its water and in
+ * its total volume, which is needed for its parent to be coarsened. Coarsening the cells where the
+ * density of the fluid varies, as in the air that the water leaves behind, lets the air get unstable.
+ * The siblings next to the cell are in its subdomain or its halo.
+ */
+bool watersystem::is_settled_cell(uint idx) const
+{
+    const leafstore& lf = w->leaves;
+    for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+        uint ni = lf.neighbor[i];
+        if (lf.cell[ni]->get_parent() != lf.cell[idx]->get_parent()) {
+            continue;
+        }
+        if (ABS(lf.water_vol_coeff[idx] - lf.water_vol_coeff[ni]) > REGRID_ALPHA_TOLERANCE ||
+                ABS(lf.total_vol_coeff[idx] - lf.total_vol_coeff[ni]) > REGRID_ALPHA_TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Calculates cell center velocity vector
+ */
+void watersystem::calculate_cell_center_properties()
+{
+    DECLARE_PARALLEL_LEAF_CELL_LOOP(calculate_cell_center_properties);
+}
+
+void watersystem::calculate_cell_center_properties(uint idx)
+{
+    leafstore& lf = w->leaves;
+
+    /* Reset cell-center velocity */
+    pfvec ccv;
+
+    /* Calculate new cell-center velocity averaged from the cell faces */
+    if (lf.total_vol_coeff[idx] > 0) {
+        pfvec weights; /* The weights in all three directins */
+        pftype own_cell_density = lf.get_density(idx);
+        for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+            octface* f = lf.neighbor_face[i];
+            pftype weight = f->cf_area*(own_cell_density + lf.get_density(lf.neighbor[i]));
+            ccv[f->dim] += weight * f->vel;
+            weights[f->dim] += weight;
+        }
+        for (uint dim = 0; dim < NUM_DIMENSIONS; dim++) {
+            if (weights[dim]) {
+                ccv[dim] /= weights[dim];
+            }
+            else {
+                //TODO: Handle this case (it can occur for empty surface cells when the velocity shound't be non-zero)
+            }
+        }
+    }
+    lf.set_cell_center_velocity(idx, ccv);
+}
+
+/*
+ * Calculates cell face alpha
+ */
+void watersystem::calculate_cell_face_properties()
+{
+    update_leaf_store();
+    part_max_v.assign(workers.get_number_of_threads(), 0);
+    workers.run_range(&watersystem::run_cell_face_pass, this, get_first_cell(), get_end_cell(), SOLVER_GRAIN_SIZE);
+    for (uint part = 0; part < part_max_v.size(); part++) {
+        if (part_max_v[part] > max_v) {
+            max_v = part_max_v[part];
+        }
+    }
+}
+
+/* Also raises max_courant_number to the Courant number of the cell if it is larger */
+void watersystem::calculate_cell_face_properties(uint idx, pftype& max_courant_number)
+{
+    leafstore& lf = w->leaves;
+    uint first = lf.first_neighbor[idx];
+    uint end   = lf.first_neighbor[idx + 1];
+
+    /* Calculate cell-face alpha */
+#if    ALPHA_ADVECTION_SCHEME == UPWIND
+    /* UPWIND gives smearing!!! */
+    for (uint i = first; i < end; i++) {
+        if (lf.neighbor_face[i]->get_vel_out(lf.neighbor_pos_dir[i]) > 0) {
+            lf.neighbor_face[i]->set_volume_coefficients(lf.water_vol_coeff[idx], lf.total_vol_coeff[idx]);
+        }
+    }
+#elif  ALPHA_ADVECTION_SCHEME == HRIC || ALPHA_ADVECTION_SCHEME == HYPER_C || ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
+    /* Find average donor neighbor alpha */
+    pftype v = 0; // [1] Courant number
+    pftype average_donor_neighbor_alpha; // [1]
+    pftype cell_alpha = lf.total_vol_coeff[idx] ? lf.get_alpha(idx) : pftype(0); // [1]
+    pftype guessed_water_in_volume_flux = 0; // [m^3/s]
+    pftype guessed_total_in_volume_flux = 0; // [m^3/s]
+    for (uint i = first; i < end; i++) {
+        octface* f = lf.neighbor_face[i];
+        pftype vel_out = f->get_vel_out(lf.neighbor_pos_dir[i]); // [m/s]
+        if (vel_out < 0) {
+            guessed_water_in_volume_flux -= lf.water_vol_coeff[lf.neighbor[i]] * vel_out * f->cf_area;
+            guessed_total_in_volume_flux -= lf.total_vol_coeff[lf.neighbor[i]] * vel_out * f->cf_area;
+        }
+        else {
+            pftype face_total_vol_coeff = lf.total_vol_coeff[idx]; // [1] Will depend on which scheme that is used to advect total volume (currently UPWIND)
+            pftype face_total_vol_fluxed = face_total_vol_coeff * vel_out * f->cf_area * get_cell_time_step(idx); // [m^3]
+            v += face_total_vol_fluxed/lf.total_vol_coeff[idx] * lf.get_inverse_cube_volume(idx);
+        }
+    }
+#if COURANT_NUMBER_LIMITATION
+    if (v > max_courant_number) {
+        max_courant_number = v;
+    }
+#endif
+#if  DEBUG
+    if (v > 1) {
+        std::cerr << "Warning! Courant number > 1 ( = " << v << endl;
+        if (v > MAX_ALLOWED_V) {
+            throw logic_error("Courant number larger than MAX_ALLOWED_V");
+        }
+    }
+#endif
+#if  ALPHA_ADVECTION_SCHEME == HYPER_C || ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
+    /*
+     * The scheme is only bounded for Courant numbers up to 1; above that it lets a
+     * cell without water give water to its acceptor neighbors
+     */
+    pftype bounded_v = MIN(v, pftype(1)); // [1]
+#endif
+    if (guessed_total_in_volume_flux) {
+        average_donor_neighbor_alpha = guessed_water_in_volume_flux/guessed_total_in_volume_flux;
+    }
+    else {
+        average_donor_neighbor_alpha = cell_alpha;
+    }
+    //v = guessed_water_in_volume_flux * dt / cell->get_cube_volume();
+
+    /* Set out volume coefficients to acceptor neighbors */
+    for (uint i = first; i < end; i++) {
+        if (lf.neighbor_face[i]->get_vel_out(lf.neighbor_pos_dir[i]) > 0) {
+            uint ni = lf.neighbor[i];
+            pftype acceptor_neighbor_alpha = lf.total_vol_coeff[ni] ? lf.get_alpha(ni) : pftype(0); // [1]
+#if  ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
+            if (acceptor_neighbor_alpha > cell_alpha) {
+                acceptor_neighbor_alpha = 1;
+            }
+            else if (acceptor_neighbor_alpha < cell_alpha) {
+                acceptor_neighbor_alpha = 0;
+            }
+#endif
+            pftype face_alpha;
+            pftype face_total_vol_coeff = lf.total_vol_coeff[idx]; // [1]
+            if (acceptor_neighbor_alpha == average_donor_neighbor_alpha) {
+#if  ALPHA_ADVECTION_SCHEME == HRIC || ALPHA_ADVECTION_SCHEME == HYPER_C || ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
+                face_alpha = cell_alpha;
+#endif
+            }
+            else {
+                pftype cell_normalized_variable =
+                        (cell_alpha - average_donor_neighbor_alpha) /
+                        (acceptor_neighbor_alpha - average_donor_neighbor_alpha); // [1]
+                pftype face_normalized_variable; // [1];
+                if (cell_normalized_variable > 1 || cell_normalized_variable < 0) {
+                    /* Outer domain */
+                    face_normalized_variable = cell_normalized_variable;
+                }
+#if  ALPHA_ADVECTION_SCHEME == HRIC
+                else if (cell_normalized_variable < 0.5) {
+                    /* Inner domain */
+                    face_normalized_variable = 2 * cell_normalized_variable;
+                }
+#elif  ALPHA_ADVECTION_SCHEME == HYPER_C || ALPHA_ADVECTION_SCHEME == HIGH_CONTRAST_SCHEME
+                else if (cell_normalized_variable < bounded_v) {
+                    /* Inner domain */
+                    face_normalized_variable = cell_normalized_variable / bounded_v;
+                }
+#endif
+                else {
+                    face_normalized_variable = 1;
+                }
+
+                if (face_normalized_variable == 1) {
+                    face_alpha = acceptor_neighbor_alpha;
+                }
+                else if (face_normalized_variable == cell_normalized_variable) {
+                    face_alpha = cell_alpha;
+                }
+                else {
+                    face_alpha = average_donor_neighbor_alpha + face_normalized_variable * (acceptor_neighbor_alpha - average_donor_neighbor_alpha); // [1]
+                }
+#if  DEBUG
+                if (average_donor_neighbor_alpha < 0 || average_donor_neighbor_alpha > 1) {
+                    cout << "average_donor_neighbor_alpha: " << average_donor_neighbor_alpha << endl;
+                    throw logic_error("Strange value for average_donor_neighbor_alpha");
+                }
+                if (acceptor_neighbor_alpha < 0 || acceptor_neighbor_alpha > 1) {
+                    cout << "acceptor_neighbor_alpha: " << acceptor_neighbor_alpha << endl;
+                    throw logic_error("Strange value for acceptor_neighbor_alpha");
+                }
+                if (cell_alpha < 0 || cell_alpha > 1) {
+                    cout << "cell_alpha: " << cell_alpha << endl;
+                    throw logic_error("Strange value for cell_alpha");
+                }
+                if (face_alpha < 0 || face_alpha > 1) {
+                    cout << "face_alpha: " << face_alpha << endl;
+                    throw logic_error("Strange value for face_alpha");
+                }
+#endif
+            }
+            pftype face_water_vol_coeff = face_alpha * face_total_vol_coeff; // [1]
+            lf.neighbor_face[i]->set_volume_coefficients(face_water_vol_coeff, face_total_vol_coeff);
+        }
+    }
+#else
+    "Don't know how to advect water"
+#endif // ALPHA_ADVECTION_SCHEME
+
+    //TODO: Calculate cell-face quasi-momentum scalars
+
+    /* Calculate cell-face quasi-momentum vectors using the UPWIND scheme */
+    for (uint i = first; i < end; i++) {
+        octface* f = lf.neighbor_face[i];
+        if (f->owns_advected_values(lf.neighbor_pos_dir[i])) {
+            f->quasi_momentum_vector = lf.ccv[idx] * f->get_cell_face_density();
+        }
+    }
+}
+
+/*
+ * Advects the cells in two steps: the new properties of all cells are calculated in parallel,
+ * only reading the faces, and then applied in parallel, only writing to the cells. The cells
+ * that get water are prepared for it afterwards (see prepare_cells_for_water), so all cells are
+ * advected through the faces as they were at the start of the pass.
+ */
+void watersystem::advect_cell_properties()
+{
+    update_leaf_store();
+    leafstore& lf = w->leaves;
+    uint first = get_first_cell();
+    uint end = get_end_cell();
+    num_cell_updates += end - first;
+    if (passes_fused) {
+        /* Most of the cells have been calculated by calculate_properties_blockwise already */
+        workers.run_range(&watersystem::run_leaf_pass<&watersystem::calculate_remaining_advection>, this, first, end, SOLVER_GRAIN_SIZE);
+    }
+    else {
+        advection_results.resize(lf.size());
+        workers.run_range(&watersystem::run_leaf_pass<&watersystem::calculate_advection>, this, first, end, SOLVER_GRAIN_SIZE);
+    }
+    part_wetted_cells.resize(workers.get_number_of_threads());
+    workers.run_range(&watersystem::run_apply_advection_pass, this, first, end, SOLVER_GRAIN_SIZE);
+#if  LOCAL_EQUATION_OF_STATE
+    /* The pressures of all the cells that have been applied */
+    workers.run_range(&watersystem::run_pressure_pass, this, first, end, SOLVER_GRAIN_SIZE);
+#endif
+    if (domain) {
+        /* The cells next to the ones that get water must be up to date in the halo */
+        domain->exchange_cell_properties(lf);
+    }
+    prepare_cells_for_water();
+}
+
+void watersystem::calculate_advection(uint idx)
+{
+    leafstore& lf = w->leaves;
+    octcell* cell = lf.cell[idx];
+    advection_result& r = advection_results[idx];
+
+    /*
+     * Update volume coefficients
+     * Calculate in quasi-momentum flux
+     * The sums are kept in the accumulation precision, see USE_DOUBLE_PRECISION_FOR_ACCUMULATION
+     */
+    patype in_water_vol_flux = 0; // [m^3/s]
+    patype in_total_vol_flux = 0; // [m^3/s]
+    pavec  in_momentum_flux; // [kg*m/s^2] in momentum flux
+    pavec  total_cell_face_area_velocity; // [m^3/s]
+    patype time_step = patype(dt); // [s] What the fluxes are multiplied by
+
+    /* Loop through neighbors */
+    if (time_step_levels) {
+        /* The fluxes are summed up as volumes [m^3] and momentum [kg*m/s] over the time step of the cell */
+        sum_multi_rate_fluxes(idx, in_water_vol_flux, in_total_vol_flux, in_momentum_flux, total_cell_face_area_velocity);
+        time_step = 1;
+    }
+    else if (lf.has_valid_neighbor_span(idx)) {
+        for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+            octface* f = lf.neighbor_face[i];
+            patype volume_flux_out = patype(f->get_vel_out(lf.neighbor_pos_dir[i])) * f->cf_area; // [m^3/s]
+            in_water_vol_flux -= f->water_vol_coeff * volume_flux_out;
+            in_total_vol_flux -= f->total_vol_coeff * volume_flux_out;
+            in_momentum_flux -= pavec(f->quasi_momentum_vector) * volume_flux_out;
+            total_cell_face_area_velocity[f->dim] += patype(f->vel) * f->cf_area;
+        }
+    }
+    else {
+        /* The cell has got new neighbors earlier in this pass, which only its neighbor lists know about */
+        nlset lists;
+        cell->add_leaf_neighbor_lists_to_list_set(lists);
+        for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+            octface* f = node->v.f;
+            patype volume_flux_out = patype(node->v.get_vel_out()) * f->cf_area; // [m^3/s]
+            in_water_vol_flux -= f->water_vol_coeff * volume_flux_out;
+            in_total_vol_flux -= f->total_vol_coeff * volume_flux_out;
+            in_momentum_flux -= pavec(f->quasi_momentum_vector) * volume_flux_out;
+            total_cell_face_area_velocity[f->dim] += patype(f->vel) * f->cf_area;
+        }
+    }
+
+    patype volume_flux_to_volume_coefficient_factor = time_step * lf.get_inverse_cube_volume(idx); /* [s/m^3] */
+    patype d_water_vol_coeff = in_water_vol_flux * volume_flux_to_volume_coefficient_factor; /* [1] */
+    patype d_total_vol_coeff = in_total_vol_flux * volume_flux_to_volume_coefficient_factor; /* [1] */
+    patype d_density = physics::vol_coeffs_to_density(d_water_vol_coeff, d_total_vol_coeff); /* [kg/m^3] */
+    pavec net_momentum_in_flow = time_step * in_momentum_flux; // [kg*m/s] Net in momentum
+    r.momentum_to_distribute = pfvec(net_momentum_in_flow - d_density * total_cell_face_area_velocity * patype(lf.get_half_edge_length(idx)));
+
+    /* The old volume coefficients in the accumulation precision */
+    patype water_vol_coeff(lf.water_vol_coeff[idx]); /* [1] */
+    patype total_vol_coeff(lf.total_vol_coeff[idx]); /* [1] */
+    /* The stored coefficients carry the rounding errors of the storage precision, also when they are summed in double precision */
+    const patype LIMIT = 4.0e-16 * (USE_DOUBLE_PRECISION_FOR_PHYSICS ? 1 : 1 << (52 - 23));
+    bool okay_to_decrease_water = false;
+    bool okay_to_increase_water = false;
+    bool no_fluid_left = false;
+    if (total_vol_coeff + d_total_vol_coeff < 0 &&
+            total_vol_coeff + d_total_vol_coeff > -LIMIT) {
+        no_fluid_left = true;
+    }
+    if (((water_vol_coeff + d_water_vol_coeff) > (total_vol_coeff + d_total_vol_coeff) &&
+         (water_vol_coeff + d_water_vol_coeff) - (total_vol_coeff + d_total_vol_coeff) < LIMIT) ||
+            ((water_vol_coeff + d_water_vol_coeff) < (total_vol_coeff + d_total_vol_coeff) &&
+             (water_vol_coeff + d_water_vol_coeff) - (total_vol_coeff + d_total_vol_coeff) > -LIMIT)) {
+        okay_to_decrease_water = true;
+    }
+    if ((water_vol_coeff + d_water_vol_coeff < 0 &&
+         water_vol_coeff + d_water_vol_coeff > -LIMIT) ||
+            (water_vol_coeff + d_water_vol_coeff > 0 &&
+             water_vol_coeff + d_water_vol_coeff < LIMIT)) {
+        okay_to_increase_water = true;
+    }
+#if  DEBUG
+    if (total_vol_coeff + d_total_vol_coeff < 0 &&
+            !no_fluid_left) {
+        cout << endl;
+        cout << "Advection: Old water volume coefficient: " << lf.water_vol_coeff[idx] << endl;
+        cout << "Advection: Old total volume coefficient: " << lf.total_vol_coeff[idx] << endl;
+        cout << "Advection: Additional water volume coefficient: " << d_water_vol_coeff << endl;
+        cout << "Advection: Additional total volume coefficient: " << d_total_vol_coeff << endl;
+        cout << "Advectoin: New water volume coefficient: " << water_vol_coeff + d_water_vol_coeff << endl;
+        cout << "Advection: New total volume coefficient: " << total_vol_coeff + d_total_vol_coeff << endl;
+        cout << (okay_to_decrease_water ? "Okay" : "Not okay") << " to decrease water" << endl;
+        cout << (okay_to_increase_water ? "Okay" : "Not okay") << " to increase water" << endl;
+        throw logic_error("New total volume coefficient less than zero");
+    }
+    if (water_vol_coeff + d_water_vol_coeff > total_vol_coeff + d_total_vol_coeff &&
+            !okay_to_decrease_water) {
+        cout << endl;
+        cout << "Advection: Old water volume coefficient: " << lf.water_vol_coeff[idx] << endl;
+        cout << "Advection: Old total volume coefficient: " << lf.total_vol_coeff[idx] << endl;
+        cout << "Advection: Additional water volume coefficient: " << d_water_vol_coeff << endl;
+        cout << "Advection: Additional total volume coefficient: " << d_total_vol_coeff << endl;
+        cout << "Advectoin: New water volume coefficient: " << water_vol_coeff + d_water_vol_coeff << endl;
+        cout << "Advection: New total volume coefficient: " << total_vol_coeff + d_total_vol_coeff << endl;
+        cout << "Old water volume coefficient is " << total_vol_coeff - water_vol_coeff <<
+                " less than old total volume coefficient" << endl;
+        cout << "New water volume coefficient is " << (water_vol_coeff + d_water_vol_coeff)-(total_vol_coeff + d_total_vol_coeff) <<
+                " more than new total volume coefficient" << endl;
+        throw logic_error("New water volume coefficient more than new total volume coefficient in cell");
+    }
+    if (water_vol_coeff + d_water_vol_coeff < 0 &&
+            !okay_to_increase_water) {
+        cout << endl;
+        cout << "Advection: Old water volume coefficient: " << lf.water_vol_coeff[idx] << endl;
+        cout << "Advection: Old total volume coefficient: " << lf.total_vol_coeff[idx] << endl;
+        cout << "Advection: Additional water volume coefficient: " << d_water_vol_coeff << endl;
+        cout << "Advection: Additional total volume coefficient: " << d_total_vol_coeff << endl;
+        cout << "Advectoin: New water volume coefficient: " << water_vol_coeff + d_water_vol_coeff << endl;
+        cout << "Advection: New total volume coefficient: " << total_vol_coeff + d_total_vol_coeff << endl;
+        throw logic_error("New water volume coefficient less than zero");
+    }
+#endif
+    r.gets_water = !water_vol_coeff && d_water_vol_coeff;
+
+#if  NO_ATMOSPHERE
+#define TRY_TO_MAINTAIN_FULL_AIR_CELLS  0 // Experimental
+#else
+#define TRY_TO_MAINTAIN_FULL_AIR_CELLS  0 // Don't change this value
+#endif
+    if (no_fluid_left) {
+#if TRY_TO_MAINTAIN_FULL_AIR_CELLS
+        r.set_volume_coefficients(0,
+                                   1);
+#else
+        r.set_volume_coefficients(0,
+                                   0);
+#endif
+    }
+    else if (okay_to_decrease_water) {
+        r.set_volume_coefficients(pftype(total_vol_coeff + d_total_vol_coeff),
+                                   pftype(total_vol_coeff + d_total_vol_coeff));
+    }
+    else if (okay_to_increase_water) {
+#if TRY_TO_MAINTAIN_FULL_AIR_CELLS
+        r.set_volume_coefficients(0,
+                                   1);
+#else
+        r.set_volume_coefficients(0,
+                                   pftype(total_vol_coeff + d_total_vol_coeff));
+#endif
+    }
+    else {
+#if  TRY_TO_MAINTAIN_FULL_AIR_CELLS
+        if ((total_vol_coeff + d_total_vol_coeff) - (water_vol_coeff + d_water_vol_coeff) > 0.2) {
+            r.set_volume_coefficients(pftype(water_vol_coeff + d_water_vol_coeff),
+                                       1);
+        }
+        else {
+            r.set_volume_coefficients(pftype(water_vol_coeff + d_water_vol_coeff),
+                                       pftype(total_vol_coeff + d_total_vol_coeff));
+        }
+#else
+        r.set_volume_coefficients(pftype(water_vol_coeff + d_water_vol_coeff),
+                                   pftype(total_vol_coeff + d_total_vol_coeff));
+#endif
+    }
+}
+
+/* Applies the result of calculate_advection to a cell */
+void watersystem::apply_advection(uint idx)
+{
+    leafstore& lf = w->leaves;
+    const advection_result& r = advection_results[idx];
+
+    lf.set_momentum_to_distribute(idx, r.momentum_to_distribute);
+    lf.set_volume_coefficients(idx, r.water_vol_coeff, r.total_vol_coeff);
+#if  DEBUG
+    if (lf.water_vol_coeff[idx] < 0) {
+        throw logic_error("Water volume coefficient became negative");
+    }
+    if (lf.total_vol_coeff[idx] < 0) {
+        throw logic_error("Total volume coefficient became negative");
+    }
+    if (lf.water_vol_coeff[idx] > lf.total_vol_coeff[idx]) {
+        throw logic_error("Water volume coefficient became larger than total volume coefficient");
+    }
+#endif
+}
+
+/*
+ * Prepares the cells that have got water in this time step for it (see octcell::prepare_for_water).
+ * Creating the new air cells next to them changes the topology, which must be done serially, but
+ * it is done for all of them in one batch: the sides that need new cells are found in parallel,
+ * and the requests for the cells that already exist are dropped there. The rest are sorted by the
+ * cell they ask for, which makes the order independent of the threads. No two of them are the
+ * same, since a side belongs to one cell, but two cells may ask for the children of the same cell
+ * from opposite sides; each request creates the half next to its own cell, and nothing that has
+ * been created by an earlier one (see octcell::create_new_air_neighbors). Then the faces to the
+ * cells without water, the new ones included, are given the mean velocity of the water around
+ * each cell, in parallel again, since such a face is next to one cell with water only.
+ *
+ * When the water is split between processes, each of them finds the requests of its own cells,
+ * and they are all gathered, so that every process changes its tree in the same way.
+ */
+void watersystem::prepare_cells_for_water()
+{
+    leafstore& lf = w->leaves;
+    wetted_cells.clear();
+    for (uint part = 0; part < part_wetted_cells.size(); part++) {
+        wetted_cells.insert(wetted_cells.end(), part_wetted_cells[part].begin(), part_wetted_cells[part].end());
+        part_wetted_cells[part].clear();
+    }
+    std::sort(wetted_cells.begin(), wetted_cells.end());
+    /* A cell may get water more than once in a cycle of multi-rate time steps */
+    wetted_cells.erase(std::unique(wetted_cells.begin(), wetted_cells.end()), wetted_cells.end());
+    wetted_mean_vel.resize(wetted_cells.size());
+    part_air_neighbor_requests.resize(workers.get_number_of_threads());
+    workers.run(&watersystem::run_air_neighbor_request_pass, this, wetted_cells.size());
+
+    air_neighbor_requests.clear();
+    for (uint part = 0; part < part_air_neighbor_requests.size(); part++) {
+        air_neighbor_requests.insert(air_neighbor_requests.end(), part_air_neighbor_requests[part].begin(), part_air_neighbor_requests[part].end());
+        part_air_neighbor_requests[part].clear();
+    }
+    if (domain) {
+        domain->all_gather(wetted_cells);
+        domain->all_gather(wetted_mean_vel);
+        domain->all_gather(air_neighbor_requests);
+    }
+    if (wetted_cells.empty()) {
+        return;
+    }
+    /* The leaf store indices are gone once the topology has been changed */
+    wetted_leaf_cells.resize(wetted_cells.size());
+    for (uint i = 0; i < wetted_cells.size(); i++) {
+        wetted_leaf_cells[i] = lf.cell[wetted_cells[i]];
+    }
+    std::sort(air_neighbor_requests.begin(), air_neighbor_requests.end());
+    if (domain && regridding.num_coarsened_cells && !air_neighbor_requests.empty()) {
+        /* A coarsened cell that gets air neighbors is refined again, and its children may be in other subdomains (see regrid) */
+        domain->share_leaf_cells(lf);
+    }
+    for (uint i = 0; i < air_neighbor_requests.size(); i++) {
+        const air_neighbor_request& request = air_neighbor_requests[i];
+        lf.cell[request.cell]->create_new_air_neighbors(request.side >> 1, request.side & 1);
+    }
+    if (domain && !lf.is_up_to_date()) {
+        /* The new cells in the halo have been made from cells that may not have been in it */
+        update_leaf_store();
+        domain->exchange_cell_properties(lf);
+    }
+
+    workers.run(&watersystem::run_wetted_face_pass, this, wetted_cells.size());
+}
+
+
+#if 0
+void watersystem::convert_cell_face_vel_out_to_quasi_momentum_out()
+{
+    DECLARE_LEAF_CELL_LOOP(convert_cell_face_vel_out_to_quasi_momentum_out);
+}
+
+void watersystem::convert_cell_face_vel_out_to_quasi_momentum_out(uint idx)
+{
+    /* Loop through neighbors */
+    nlset lists;
+    w->leaves.cell[idx]->add_leaf_neighbor_lists_to_list_set(lists);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        if (node->v.should_calculate_new_velocity()) {
+            node->v.f->quasi_momentum = node->v.f->vel * node->v.get_average_cell_density();
+        }
+    }
+}
+
+void watersystem::convert_cell_face_quasi_momentum_out_to_vel_out()
+{
+    DECLARE_LEAF_CELL_LOOP(convert_cell_face_quasi_momentum_out_to_vel_out);
+}
+
+void watersystem::convert_cell_face_quasi_momentum_out_to_vel_out(uint idx)
+{
+    /* Loop through neighbors */
+    nlset lists;
+    w->leaves.cell[idx]->add_leaf_neighbor_lists_to_list_set(lists);
+    for (nlnode* node = lists.get_first_node(); node; node = lists.get_next_node()) {
+        if (node->v.should_calculate_new_velocity() && node->v.f->quasi_momentum) {
+            node->v.f->vel = node->v.f->quasi_momentum / node->v.get_average_cell_density();
+#if  DEBUG
+            if (!node->v.get_average_cell_density()) {
+                throw logic_error("Cell face has quasi momentum out but no density");
+            }
+#endif
+        }
+    }
+}
+#endif
+
+void watersystem::distribute_ceLl_quasi_momentum_on_cell_faces()
+{
+    DECLARE_PARALLEL_LEAF_CELL_LOOP(distribute_ceLl_quasi_momentum_on_cell_faces);
+}
+
+void watersystem::distribute_ceLl_quasi_momentum_on_cell_faces(uint idx)
+{
+    leafstore& lf = w->leaves;
+    uint first = lf.first_neighbor[idx];
+    uint end   = lf.first_neighbor[idx + 1];
+
+    /* Measure areas */
+    pfvec areas;
+    for (uint i = first; i < end; i++) {
+        areas[lf.neighbor_face[i]->dim] += lf.neighbor_face[i]->cf_area;
+    }
+    /*
+     * Distribute quasi momentum
+     * Only the cell on the negative side of a face distributes momentum on it. This is how it has
+     * always worked: when each side had its own copy of the velocity, the copy of the cell on the
+     * positive side was overwritten when the velocity was updated by the pressure gradient.
+     */
+    pftype own_mass_per_unit_area = lf.get_density(idx)*lf.s[idx]; // [kg/m^2]
+    for (uint i = first; i < end; i++) {
+        if (octface::owns_velocity(lf.neighbor_pos_dir[i])) {
+            octface* f = lf.neighbor_face[i];
+            uint ni = lf.neighbor[i];
+            pftype associated_mass_per_unit_area = 0.5 * (lf.get_density(ni)*lf.s[ni] + own_mass_per_unit_area); // [kg/m^2]
+            pftype vel_change = lf.momentum_to_distribute[idx][f->dim]/(associated_mass_per_unit_area * areas[f->dim]); // [m/s]
+            if (time_step_levels && time_step_class[ni] > time_step_class[idx]) {
+                /* The velocity of a face to a coarser cell only changes when the coarser cell steps, see run_multi_rate_cycle */
+                pftype& waiting = interface_fluxes[f->idx].vel_change;
+                if (time_step_class[ni] > active_time_step_class) {
+                    waiting += vel_change;
+                    continue;
+                }
+                vel_change += waiting;
+                waiting = 0;
+            }
+            f->vel += vel_change;
+        }
+    }
+}
+
+/* The pressures for the velocity update of the time step, see pressuresolver.h */
+void watersystem::solve_pressures()
+{
+    update_leaf_store();
+    if (domain) {
+        /* The faces that the halo cells own have only got their quasi-momentum in the other processes */
+        domain->exchange_velocities();
+    }
+    pressure_solver.solve(workers, w->leaves, domain, get_first_cell(), get_end_cell(), dt);
+}
+
+/* Runs over the velocity faces rather than over the cells, see velocitykernel.h */
+void watersystem::update_velocities_by_the_pressure_gradients()
+{
+    update_leaf_store();
+    const leafstore& lf = w->leaves;
+    workers.run_range(&watersystem::run_velocity_face_pass, this, lf.first_velocity_face[get_first_cell()], lf.first_velocity_face[get_end_cell()], SOLVER_GRAIN_SIZE);
+}
+
+/*
+ * Fused passes
+ *
+ * A pass needs another pass to be done with a cell if it reads something that the other pass
+ * writes to the cell or to one of its faces. Only advection reads faces that the neighbors
+ * write in the same time step, so the passes fall into three sweeps over the leaf cells:
+ *   1. Cell-center velocities, cell-face properties and advection of the cells whose faces are
+ *      done (calculate_properties_blockwise)
+ *   2. The rest of the advection, and applying it in leaf order (advect_cell_properties)
+ *   3. Distribution of the quasi-momentum and the pressure gradient update (update_face_velocities)
+ * Every value is calculated from the same inputs as when the passes are run one by one, so the
+ * result is the same to the last bit.
+ */
+
+/*
+ * Sweeps the leaf cells in blocks of SOLVER_BLOCK_SIZE consecutive cells, which cover whole
+ * subtrees apart from the ends, so that the cells of a block mostly border to each other. The
+ * blocks are swept in sub-blocks, and a cell is advected as soon as the sub-block holding its
+ * last neighbor has been swept, while the data is still in the cache. The cells that border to
+ * other blocks are left for advect_cell_properties.
+ */
+void watersystem::calculate_properties_blockwise()
+{
+    update_leaf_store();
+    uint num_cells = w->leaves.size();
+    advection_results.resize(num_cells);
+    advection_calculated.assign(num_cells, 0);
+    part_max_v.assign(workers.get_number_of_threads(), 0);
+    uint num_blocks = (get_end_cell() - get_first_cell() + SOLVER_BLOCK_SIZE - 1) / SOLVER_BLOCK_SIZE;
+    workers.run(&watersystem::run_block_pass, this, num_blocks);
+    for (uint part = 0; part < part_max_v.size(); part++) {
+        if (part_max_v[part] > max_v) {
+            max_v = part_max_v[part];
+        }
+    }
+}
+
+/* Also raises max_courant_number to the largest Courant number in the block */
+void watersystem::calculate_properties_in_block(uint first, uint end, pftype& max_courant_number)
+{
+    const uint NUM_SUB_BLOCKS = (SOLVER_BLOCK_SIZE + SOLVER_SUB_BLOCK_SIZE - 1) / SOLVER_SUB_BLOCK_SIZE;
+    const uint NO_CELL = uint(-1);
+    leafstore& lf = w->leaves;
+    /* The cells waiting for a later sub-block to be swept, as one linked list per sub-block */
+    uint first_waiting[NUM_SUB_BLOCKS];
+    uint next_waiting[SOLVER_BLOCK_SIZE];
+    for (uint sub = 0; sub < NUM_SUB_BLOCKS; sub++) {
+        first_waiting[sub] = NO_CELL;
+    }
+
+    for (uint sub = 0, sub_first = first; sub_first < end; sub++, sub_first += SOLVER_SUB_BLOCK_SIZE) {
+        uint sub_end = MIN(sub_first + SOLVER_SUB_BLOCK_SIZE, end);
+        for (uint idx = sub_first; idx < sub_end; idx++) {
+#if  CALCULATE_CELL_CENTER_VELOCITIES
+            calculate_cell_center_properties(idx);
+#endif
+            calculate_cell_face_properties(idx, max_courant_number);
+        }
+        /* Advect the cells whose neighbors are all done, or else find the sub-block they wait for */
+        for (uint idx = sub_first; idx < sub_end; idx++) {
+            uint lowest  = idx;
+            uint highest = idx;
+            for (uint i = lf.first_neighbor[idx]; i < lf.first_neighbor[idx + 1]; i++) {
+                lowest  = MIN(lowest , lf.neighbor[i]);
+                highest = MAX(highest, lf.neighbor[i]);
+            }
+            if (lowest < first || highest >= end) {
+                /* Left for advect_cell_properties */
+                continue;
+            }
+            uint awaited_sub = (highest - first) / SOLVER_SUB_BLOCK_SIZE;
+            if (awaited_sub == sub) {
+                calculate_advection(idx);
+                advection_calculated[idx] = true;
+            }
+            else {
+                next_waiting[idx - first] = first_waiting[awaited_sub];
+                first_waiting[awaited_sub] = idx;
+            }
+        }
+        /* Advect the cells of earlier sub-blocks that waited for this one */
+        for (uint idx = first_waiting[sub]; idx != NO_CELL; idx = next_waiting[idx - first]) {
+            calculate_advection(idx);
+            advection_calculated[idx] = true;
+        }
+    }
+}
+
+void watersystem::calculate_remaining_advection(uint idx)
+{
+    if (!advection_calculated[idx]) {
+        calculate_advection(idx);
+    }
+}
+
+void watersystem::update_face_velocities()
+{
+    update_leaf_store();
+    workers.run_range(&watersystem::run_face_velocity_pass, this, get_first_cell(), get_end_cell(), SOLVER_GRAIN_SIZE);
+}
+
+/* Runs a leaf cell pass over a range of leaf store indices (see threadpool) */
+template<void (watersystem::*pass)(uint)>
+void watersystem::run_leaf_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    for (uint idx = first; idx < end; idx++) {
+        (ws->*pass)(idx);
+    }
+    part = part;
+}
+
+/* Runs a leaf cell pass over the cells of a range that step in the current time step, see run_multi_rate_cycle */
+template<void (watersystem::*pass)(uint)>
+void watersystem::run_stepped_leaf_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    for (uint idx = first; idx < end; idx++) {
+        if (ws->is_stepped(idx)) {
+            (ws->*pass)(idx);
+        }
+    }
+    part = part;
+}
+
+/* Runs the cell-face pass over a range of leaf store indices, keeping the largest Courant number of each thread */
+void watersystem::run_cell_face_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    pftype max_courant_number = ws->part_max_v[part];
+    for (uint idx = first; idx < end; idx++) {
+        ws->calculate_cell_face_properties(idx, max_courant_number);
+    }
+    ws->part_max_v[part] = max_courant_number;
+}
+
+/* Runs the velocity update over a range of velocity faces */
+void watersystem::run_velocity_face_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    velocitykernel::update_velocities(ws->instruction_set, ws->w->leaves, first, end, ws->dt);
+    part = part;
+}
+
+/*
+ * Runs the distribution of the quasi-momentum over a range of leaf cells and then the velocity
+ * update over the velocity faces of the same cells. Both passes only write to the faces that the
+ * cell owns the velocity of, and the second one only reads the velocity of the face it updates.
+ */
+void watersystem::run_face_velocity_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    leafstore& lf = ws->w->leaves;
+    for (uint idx = first; idx < end; idx++) {
+        ws->distribute_ceLl_quasi_momentum_on_cell_faces(idx);
+    }
+    velocitykernel::update_velocities(ws->instruction_set, lf, lf.first_velocity_face[first], lf.first_velocity_face[end], ws->dt);
+    part = part;
+}
+
+/*
+ * Runs the pressure kernel over a range of leaf cells. When applying the advection has changed
+ * the topology, the cells that are no longer leaf cells were skipped there, and are skipped here.
+ */
+void watersystem::run_pressure_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    leafstore& lf = ws->w->leaves;
+    pressurekernel::calculate_pressures(ws->instruction_set, lf, first, end);
+    for (uint idx = first; idx < end; idx++) {
+        if (lf.is_up_to_date() || lf.cell[idx]->is_leaf()) {
+            lf.copy_pressure_to_cell(idx);
+        }
+    }
+    part = part;
+}
+
+/* Applies the advection of a range of leaf cells, keeping the cells that get water in the list of the thread */
+void watersystem::run_apply_advection_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    leafstore& lf = ws->w->leaves;
+    for (uint idx = first; idx < end; idx++) {
+        if (!ws->is_stepped(idx)) {
+            continue;
+        }
+        ws->apply_advection(idx);
+        if (ws->advection_results[idx].gets_water && lf.cell[idx]->has_water()) {
+            ws->part_wetted_cells[part].push_back(idx);
+        }
+    }
+}
+
+/* Finds the sides of a range of the wetted cells that may need new air cells next to them */
+void watersystem::run_air_neighbor_request_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    const fvoctree* tree = ws->w;
+    for (uint i = first; i < end; i++) {
+        octcell* cell = tree->leaves.cell[ws->wetted_cells[i]];
+        uint sides = cell->get_sides_without_water(ws->wetted_mean_vel[i]);
+        for (uint side = 0; side < 2*NUM_DIMENSIONS; side++) {
+            if (!(sides & (1 << side))) {
+                continue;
+            }
+            uint dim = side >> 1;
+            bool pos_dir = side & 1;
+            air_neighbor_request request;
+            if (!morton::neighbor_key(cell->key, cell->lvl, dim, pos_dir, request.key)) {
+                /* Outside of the root cell */
+                continue;
+            }
+            /* Nothing is created if the cells there already exist (see octcell::create_new_air_neighbors) */
+            octcell* n = tree->find_smallest_cell_containing(request.key);
+            if (n->is_fine_enough()) {
+                continue;
+            }
+            if (n->key == request.key && n->has_child_array()) {
+                bool has_all_children = true;
+                for (uint child_idx = 0; child_idx < octcell::MAX_NUM_CHILDREN; child_idx++) {
+                    if (octcell::positive_direction_of_child(child_idx, dim) != pos_dir && !n->has_child(child_idx)) {
+                        has_all_children = false;
+                    }
+                }
+                if (has_all_children) {
+                    continue;
+                }
+            }
+            request.side = side;
+            request.cell = ws->wetted_cells[i];
+            ws->part_air_neighbor_requests[part].push_back(request);
+        }
+    }
+}
+
+/*
+ * Sets the velocities of the faces between a range of the wetted cells and their neighbors without
+ * water. A process only sets them for the cells whose properties it has.
+ */
+void watersystem::run_wetted_face_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    for (uint i = first; i < end; i++) {
+        octcell* cell = ws->wetted_leaf_cells[i];
+        if (ws->domain && !ws->domain->is_local(cell->li)) {
+            continue;
+        }
+        if (!cell->is_leaf()) {
+            /* Refined as the coarser neighbor of a new air cell (see octcell::refine_coarser_leaf_neighbors) */
+            continue;
+        }
+        cell->set_velocities_to_cells_without_water(ws->wetted_mean_vel[i]);
+    }
+    part = part;
+}
+
+/* Runs the cell-center and cell-face passes over the cells of a range that start a time step, see run_multi_rate_cycle */
+void watersystem::run_multi_rate_face_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    pftype max_courant_number = ws->part_max_v[part];
+    for (uint idx = first; idx < end; idx++) {
+        if (ws->is_starting_time_step(idx)) {
+#if  CALCULATE_CELL_CENTER_VELOCITIES
+            ws->calculate_cell_center_properties(idx);
+#endif
+            ws->calculate_cell_face_properties(idx, max_courant_number);
+        }
+    }
+    ws->part_max_v[part] = max_courant_number;
+}
+
+/* Runs the velocity update over the faces of a range that are updated in the current time step, in runs of faces of the same class */
+void watersystem::run_multi_rate_velocity_face_pass(void* watersystem_object, uint part, uint first, uint end)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    const std::vector<uint8>& face_class = ws->velocity_face_time_step_class;
+    uint f = first;
+    while (f < end) {
+        uint k = face_class[f];
+        uint run_end = f + 1;
+        while (run_end < end && face_class[run_end] == k) {
+            run_end++;
+        }
+        if (k <= ws->active_time_step_class) {
+            velocitykernel::update_velocities(ws->instruction_set, ws->w->leaves, f, run_end, ws->dt * (1 << k));
+        }
+        f = run_end;
+    }
+    part = part;
+}
+
+/* Runs calculate_properties_in_block over a range of blocks, keeping the largest Courant number of each thread */
+void watersystem::run_block_pass(void* watersystem_object, uint part, uint first_block, uint end_block)
+{
+    watersystem* ws = static_cast<watersystem*>(watersystem_object);
+    uint end_cell = ws->get_end_cell();
+    pftype max_courant_number = ws->part_max_v[part];
+    for (uint block = first_block; block < end_block; block++) {
+        uint first = ws->get_first_cell() + block * SOLVER_BLOCK_SIZE;
+        ws->calculate_properties_in_block(first, MIN(first + SOLVER_BLOCK_SIZE, end_cell), max_courant_number);
+    }
+    ws->part_max_v[part] = max_courant_number;
+}
+
+/* Leaf cells */
+
+void watersystem::update_leaf_store()
+{
+    w->update_leaf_store();
+    if (domain) {
+        domain->update(w->leaves);
+    }
+}
+
+uint watersystem::get_first_cell() const
+{
+    return domain ? domain->get_first_cell() : 0;
+}
+
+uint watersystem::get_end_cell() const
+{
+    return domain ? domain->get_end_cell() : w->leaves.size();
+}
+
+/* Thread safety */
+
+void watersystem::start_operation()
+{
+    while (operating) {
+        // Wait for the other operation to finish
+        process_events();
+    }
+    operating = true;
+    abort = false;
+}
+
+void watersystem::finish_operation()
+{
+    if (!operating) {
+        throw logic_error("Tried to finish operation while not operating");
+    }
+    operating = false;
+}
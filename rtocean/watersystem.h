@@ -1,357 +1,687 @@
-#ifndef WATERSYSTEM_H
-#define WATERSYSTEM_H
-
-////////////////////////////////////////////////////////////////
-// INCLUDE FILES
-////////////////////////////////////////////////////////////////
-
-// Own includes
-#include "fvoctree.h"
-#include "callback.h"
-
-////////////////////////////////////////////////////////////////
-// ENUMS
-////////////////////////////////////////////////////////////////
-
-enum SIMULATION_RESULT {
-    SR_FINISHED,
-    SR_PAUSED,
-    SR_ABORTED,
-    NUM_SIMULATION_RESULTS
-};
-
-////////////////////////////////////////////////////////////////
-// CLASS DEFINITION
-////////////////////////////////////////////////////////////////
-
-class watersystem
-{
-public:
-    /* Constructors and destructor */
-    watersystem();
-
-public:
-    /* Water */
-    bool      is_water_defined() const;
-    void      define_water(fvoctree* water, pftype start_time = 0, bool time_staggered = false, pftype time_step = 0);
-    void      redefine_water(fvoctree* water, pftype start_time = 0, bool time_staggered = false, pftype time_step = 0);
-    void      undefine_water();
-    const fvoctree* get_water() const;
-    /* Time */
-    pftype    get_time() const;
-    void      set_time(pftype time);
-    pftype    get_time_step() const;
-    void      set_time_step(pftype time_step);
-    void      set_number_of_time_steps_before_resting(uint number_of_time_steps);
-    /* Control */
-    void      evolve();
-    int       run_simulation(pftype time_step);
-    bool      is_started() const;
-    bool      is_paused() const;
-    bool      is_operating() const;
-    void      pause_simulation(bool jump_out_of_main_loop = true);
-    void      continue_simulation();
-    void      abort_ongoing_operation();
-    /* Callback */
-    void set_state_updated_callback   (callback<void (*)(void*)> callback);
-    void set_state_updated_callback   (void (*function)(void*), void* parameter);
-    void set_take_printscreen_callback(callback<void (*)(void*)> callback);
-    void set_take_printscreen_callback(void (*function)(void*), void* parameter);
-
-    /* Static functions */
-    static pftype vol_coeffs_to_density(pftype water_volume_coeff, pftype total_volume_coeff);
-
-private:
-    /* Private member variables */
-
-    /* Simulation */
-    fvoctree* w ;     // Water
-    pftype    t ;     // Time
-    pftype    dt;     // Time step
-    pftype    max_dt; // The maximum time step length (only active if COURANT_NUMBER_LIMITATION is true)
-    pftype    max_v;  // The maximum measured courant number
-    uint      num_time_steps_before_resting; // Ths number of time steps before calling the state_updated_callback function
-
-    /* Control */
-    bool      started; // If the simulation is running or not
-    bool      operating; // If some operation is already using some of the class members
-    bool      paused; // If the simulation should stop or not
-    bool      break_main_loop_when_pausing; // If the main loop should break or not when paused
-    bool      abort; // If the main loop should quit or not
-
-    /* Callback */
-    //callback<void (*)(void*, string)> output_callback;
-    callback<void (*)(void*)> state_updated_callback;
-    callback<void (*)(void*)> take_printscreen_callback;
-
-private:
-    /* Private methods */
-
-    /* Control */
-    void _evolve();
-
-    /* Simulation */
-    void calculate_cell_center_properties_recursively(octcell* cell);
-    void calculate_cell_face_properties_recursively(octcell* cell);
-    void calculate_delta_alpha_recursively(octcell* cell);
-    void clamp_advect_alpha_recursively(octcell* cell);
-    void calculate_alpha_gradient_recursively(octcell* cell);
-    void advect_cell_properties_recursivelly(octcell* cell);
-    //void convert_cell_face_vel_out_to_quasi_momentum_out_recursively(octcell* cell);
-    void distribute_ceLl_quasi_momentum_on_cell_faces_recursively(octcell* cell);
-    //void convert_cell_face_quasi_momentum_out_to_vel_out_recursively(octcell* cell);
-    //bool advect_and_update_pressure_recursively(octcell* cell);
-    void update_velocities_by_the_pressure_gradients_recursively(octcell* cell);
-
-    /* Thread safety */
-    void start_operation();
-    void finish_operation();
-
-    /* Miscellaneous */
-    void process_events();
-};
-
-////////////////////////////////////////////////////////////////
-// PUBLIC METHODS
-////////////////////////////////////////////////////////////////
-
-inline
-bool watersystem::is_water_defined() const
-{
-    return w;
-}
-
-inline
-void watersystem::define_water(fvoctree* water, pftype start_time, bool time_staggered, pftype time_step)
-{
-#if  DEBUG
-    if (!water) {
-        throw logic_error("Trying to define water using a NULL pointer");
-    }
-    if (w) {
-        throw logic_error("Trying to define water when it is already defined");
-    }
-#endif
-
-    w = water;
-    t = start_time;
-    if (time_staggered) {
-        dt = time_step;
-    }
-    else {
-        dt = 0;
-        set_time_step(time_step);
-    }
-    max_dt = time_step;
-    started = false;
-    paused = false;
-    abort = false;
-}
-
-inline
-void watersystem::redefine_water(fvoctree* water, pftype start_time, bool time_staggered, pftype time_step)
-{
-    undefine_water();
-    define_water(water, start_time, time_staggered, time_step);
-}
-
-inline
-void watersystem::undefine_water()
-{
-#if  DEBUG
-    if (!w) {
-        throw logic_error("Trying to undefine water but it is not currently defined");
-    }
-#endif
-    delete w;
-    w = 0;
-}
-
-inline
-const fvoctree *watersystem::get_water() const
-{
-    return w;
-}
-
-inline
-pftype watersystem::get_time() const
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Trying to get time while no water is defined");
-    }
-#endif
-    return t;
-}
-
-inline
-void watersystem::set_time(pftype time)
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Trying to set time while no water is defined");
-    }
-#endif
-    t = time;
-}
-
-inline
-pftype watersystem::get_time_step() const
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Trying to get time step while no water is defined");
-    }
-#endif
-    return dt;
-}
-
-inline
-void watersystem::set_number_of_time_steps_before_resting(uint number_of_time_steps)
-{
-#if  DEBUG
-    if (number_of_time_steps <= 0) {
-        throw logic_error("Trying to set an invalid number of time steps before resting");
-    }
-#endif
-    num_time_steps_before_resting = number_of_time_steps;
-}
-
-inline
-void watersystem::set_time_step(pftype time_step)
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Trying to set time step while no water is defined");
-    }
-#endif
-    if (dt != time_step) {
-        // TODO: Update time-staggered parameters (velocities)
-#if  TIME_STEP_CHANGE_CORRECTION && !COURANT_NUMBER_LIMITATION
-        dt = 0.5 * (time_step - dt);
-        update_velocities_by_the_pressure_gradients_recursively(w->root);
-#endif
-#if  COURANT_NUMBER_LIMITATION
-        max_dt = time_step;
-#else
-        dt = time_step;
-#endif
-    }
-}
-
-inline
-bool watersystem::is_started() const
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Asking if simulation is started while no water is defined");
-    }
-#endif
-    return started;
-}
-
-inline
-bool watersystem::is_paused() const
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Asking if simulation is paused while no water is defined");
-    }
-#endif
-    return paused;
-}
-
-inline
-bool watersystem::is_operating() const
-{
-    return operating;
-}
-
-inline
-void watersystem::pause_simulation(bool jump_out_of_main_loop)
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Trying to pause simulation while no water is defined");
-    }
-    if (!started) {
-        throw logic_error("Trying to pause simulation while not started any");
-    }
-    if (paused) {
-        throw logic_error("Trying to pause simulation while already paused");
-    }
-#endif
-    paused = true;
-    break_main_loop_when_pausing = jump_out_of_main_loop;
-}
-
-inline
-void watersystem::continue_simulation()
-{
-#if  DEBUG
-    if (!is_water_defined()) {
-        throw logic_error("Trying to continue simulation while no water is defined");
-    }
-    if (!started) {
-        throw logic_error("Trying to continue simulation while not started any");
-    }if (!paused) {
-        throw logic_error("Trying to continue simulation while not paused");
-    }
-#endif
-    if (break_main_loop_when_pausing) {
-        paused = false;
-    }
-    else {
-        run_simulation(dt);
-    }
-}
-
-inline
-void watersystem::abort_ongoing_operation()
-{
-#if  DEBUG
-    if (!operating) {
-        throw logic_error("Trying to abort operation while not doing any");
-    }
-#endif
-    abort = true;
-}
-
-inline
-void watersystem::set_state_updated_callback(callback<void (*)(void*)> callback)
-{
-    state_updated_callback = callback;
-}
-
-inline
-void watersystem::set_state_updated_callback(void (*function)(void*), void* parameter)
-{
-    state_updated_callback.func  = function ;
-    state_updated_callback.param = parameter;
-}
-
-inline
-void watersystem::set_take_printscreen_callback(callback<void (*)(void*)> callback)
-{
-    take_printscreen_callback = callback;
-}
-
-inline
-void watersystem::set_take_printscreen_callback(void (*function)(void*), void* parameter)
-{
-    take_printscreen_callback.func  = function ;
-    take_printscreen_callback.param = parameter;
-}
-
-/* Miscellaneous */
-
-inline
-void watersystem::process_events()
-{
-    // Let the application process its events
-    if (state_updated_callback.is_defined()) {
-        state_updated_callback.func(state_updated_callback.param);
-    }
-}
-
-#endif // WATERSYSTEM_H
+#ifndef WATERSYSTEM_H
+#define WATERSYSTEM_H
+
+////////////////////////////////////////////////////////////////
+// INCLUDE FILES
+////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "fvoctree.h"
+#include "callback.h"
+#include "threadpool.h"
+#include "fieldsnapshot.h"
+#include "velocitykernel.h"
+#include "pressurekernel.h"
+#include "pressuresolver.h"
+#include "subdomain.h"
+
+////////////////////////////////////////////////////////////////
+// ENUMS
+////////////////////////////////////////////////////////////////
+
+enum SIMULATION_RESULT {
+    SR_FINISHED,
+    SR_PAUSED,
+    SR_ABORTED,
+    NUM_SIMULATION_RESULTS
+};
+
+////////////////////////////////////////////////////////////////
+// CLASS DEFINITION
+////////////////////////////////////////////////////////////////
+
+class watersystem
+{
+public:
+    /* Types */
+    struct regrid_stats {
+        uint   num_regriddings;
+        uint   num_refined_cells; /* In all the regriddings */
+        uint   num_coarsened_cells;
+        uint   num_surface_cells; /* Found by this process in the last regridding */
+        double time; /* [s] Spent regridding */
+    };
+
+public:
+    /* Constructors and destructor */
+    watersystem();
+
+public:
+    /* Water */
+    bool      is_water_defined() const;
+    void      define_water(fvoctree* water, pftype start_time = 0, bool time_staggered = false, pftype time_step = 0);
+    void      redefine_water(fvoctree* water, pftype start_time = 0, bool time_staggered = false, pftype time_step = 0);
+    void      undefine_water();
+    const fvoctree* get_water() const;
+    /* Time */
+    patype    get_time() const;
+    void      set_time(patype time);
+    pftype    get_time_step() const;
+    void      set_time_step(pftype time_step);
+    void      set_number_of_time_steps_before_resting(uint number_of_time_steps);
+    uint      get_time_step_levels() const;
+    void      set_time_step_levels(uint levels);
+    uint64    get_number_of_cell_updates() const;
+    /* Grid */
+    uint      get_regrid_interval() const;
+    void      set_regrid_interval(uint number_of_time_steps);
+    const regrid_stats& get_regrid_stats() const;
+    /* Pressures */
+    const pressuresolver::solve_stats& get_pressure_solver_stats() const;
+    /* Threads */
+    uint      get_number_of_threads() const;
+    void      set_number_of_threads(uint number_of_threads);
+    double    get_thread_busy_time(uint thread) const;
+    void      reset_thread_busy_times();
+    bool      are_passes_fused() const;
+    void      set_passes_fused(bool fused);
+    INSTRUCTION_SET get_instruction_set() const;
+    void      set_instruction_set(INSTRUCTION_SET instruction_set);
+    /* Processes */
+    void      set_subdomain(subdomain* domain);
+    /* Output */
+    void      capture_snapshot(fieldsnapshot& snapshot);
+    /* Control */
+    void      evolve();
+    int       run_simulation(pftype time_step);
+    bool      is_started() const;
+    bool      is_paused() const;
+    bool      is_operating() const;
+    void      pause_simulation(bool jump_out_of_main_loop = true);
+    void      continue_simulation();
+    void      abort_ongoing_operation();
+    /* Callback */
+    void set_state_updated_callback   (callback<void (*)(void*)> callback);
+    void set_state_updated_callback   (void (*function)(void*), void* parameter);
+    void set_take_printscreen_callback(callback<void (*)(void*)> callback);
+    void set_take_printscreen_callback(void (*function)(void*), void* parameter);
+
+    /* Static functions */
+    static pftype vol_coeffs_to_density(pftype water_volume_coeff, pftype total_volume_coeff);
+
+private:
+    /* Private types */
+
+    /* The new properties of a leaf cell, calculated in parallel and applied in parallel once all of them have been calculated */
+    struct advection_result {
+        pfvec  momentum_to_distribute; // [kg*m/s]
+        pftype water_vol_coeff; // [1]
+        pftype total_vol_coeff; // [1]
+        bool   gets_water; // If the cell has no water but gets some, see octcell::prepare_for_water
+
+        void set_volume_coefficients(pftype water_volume_coefficient, pftype total_volume_coefficient) {
+            water_vol_coeff = water_volume_coefficient;
+            total_vol_coeff = total_volume_coefficient;
+        }
+    };
+
+    /* What the cell on the fine side of a face has done to it while the cell on its coarse side waits for its time step (see run_multi_rate_cycle) */
+    struct interface_flux {
+        patype water_vol; // [m^3] Moved through the face in the positive direction
+        patype total_vol; // [m^3]
+        pavec  momentum; // [kg*m/s]
+        pftype vel_change; // [m/s] Distributed on the face, see distribute_ceLl_quasi_momentum_on_cell_faces
+    };
+
+    /* A side of a cell that has got water, where new air cells may be needed (see prepare_cells_for_water) */
+    struct air_neighbor_request {
+        uint64 key; // The Morton key of the cell next to the side, at the level of the cell
+        uint   side; // 2*dim + pos_dir
+        uint   cell; // Leaf store index, which is the same in all processes (see subdomain)
+
+        bool operator<(const air_neighbor_request& other) const {
+            return key < other.key || (key == other.key && side < other.side);
+        }
+    };
+
+private:
+    /* Private member variables */
+
+    /* Simulation */
+    fvoctree* w ;     // Water
+    patype    t ;     // Time, summed in the accumulation precision
+    pftype    dt;     // Time step
+    pftype    max_dt; // The maximum time step length (only active if COURANT_NUMBER_LIMITATION is true)
+    pftype    max_v;  // The maximum measured courant number
+    size_t    current_print_screen_index; // The next one of PRINTSCREEN_TIMES to stop at
+    uint      num_time_steps_before_resting; // Ths number of time steps before calling the state_updated_callback function
+    threadpool workers; // Runs the leaf cell passes that only write to data owned by the cell being handled
+    std::vector<pftype> part_max_v; // The maximum courant number found by each thread in the cell-face pass
+    std::vector<advection_result> advection_results; // Per leaf cell
+    std::vector<std::vector<uint> > part_wetted_cells; // The leaf cells each thread has found to get water when applying the advection
+    std::vector<uint> wetted_cells; // The leaf cells that have got water in this time step, in leaf order
+    std::vector<pfvec> wetted_mean_vel; // Per wetted cell, the mean velocity of the water around it
+    std::vector<octcell*> wetted_leaf_cells; // The wetted cells themselves, which stay valid when the leaf store is rebuilt
+    std::vector<std::vector<air_neighbor_request> > part_air_neighbor_requests; // The requests found by each thread
+    std::vector<air_neighbor_request> air_neighbor_requests; // Sorted
+    std::vector<uint8> advection_calculated; // Per leaf cell, if the result was calculated in the blockwise sweep (bytes, since the blocks are swept in parallel)
+    bool      passes_fused; // If the passes share sweeps over the leaf cells, see calculate_properties_blockwise
+    INSTRUCTION_SET instruction_set; // The instructions the kernels are run with, see instructionset.h
+    subdomain* domain; // The part of the water simulated by this process when it is split between processes, or 0
+    uint64    num_cell_updates; // The number of times a leaf cell has been advected
+    /* Multi-rate time stepping, see run_multi_rate_cycle */
+    uint      time_step_levels; // The cells step with dt times 2^k for k up to this
+    uint      time_step_in_cycle; // The current time step of dt in the cycle
+    uint      active_time_step_class; // The cells of the classes up to this one end a time step of theirs in the current one
+    std::vector<uint8> time_step_class; // Per leaf cell, k
+    std::vector<uint8> velocity_face_time_step_class; // Per velocity face, the higher class of its two cells
+    std::vector<uint>  num_cells_in_time_step_class;
+    std::vector<interface_flux> interface_fluxes; // Per face store index, summed by the fine side of a face between two classes and used up by the coarse side
+    uint      time_step_class_generation; // Of the leaf store the classes were found for
+    bool      time_step_classes_found;
+    /* Regridding, see regrid */
+    uint      regrid_interval; // The number of time steps between the regriddings, 0 if the cells are kept
+    uint      num_time_steps_until_regridding;
+    regrid_stats regridding;
+    std::vector<uint>   surface_cells; // Leaf store indices
+    std::vector<uint>   unsettled_cells; // Leaf store indices of the cells that keep their parents from being coarsened, see is_settled_cell
+    std::vector<uint8>  settled; // Per leaf cell
+    std::vector<double> surface_distance; // Per leaf cell, [m] along the leaf cells to the nearest surface cell
+    std::vector<uint64> refine_keys; // The Morton keys of the cells to refine
+    std::vector<uint64> coarsen_keys; // The Morton keys of the cells to coarsen
+    /* Pressures, when they are solved for (USE_ARTIFICIAL_COMPRESSIBILITY 0) */
+    pressuresolver pressure_solver;
+
+    /* Control (the flags may be set from another thread than the one running the simulation) */
+    volatile bool started; // If the simulation is running or not
+    volatile bool operating; // If some operation is already using some of the class members
+    volatile bool paused; // If the simulation should stop or not
+    volatile bool break_main_loop_when_pausing; // If the main loop should break or not when paused
+    volatile bool abort; // If the main loop should quit or not
+
+    /* Callback */
+    //callback<void (*)(void*, string)> output_callback;
+    callback<void (*)(void*)> state_updated_callback;
+    callback<void (*)(void*)> take_printscreen_callback;
+
+private:
+    /* Private methods */
+
+    /* Control */
+    void _evolve();
+    void run_multi_rate_cycle();
+    void find_time_step_classes();
+    bool is_stepped(uint idx) const;
+    bool is_starting_time_step(uint idx) const;
+    pftype get_cell_time_step(uint idx) const;
+    void sum_multi_rate_fluxes(uint idx, patype& in_water_vol, patype& in_total_vol, pavec& in_momentum, pavec& total_cell_face_area_velocity);
+    void regrid();
+    bool is_surface_cell(uint idx) const;
+    bool is_settled_cell(uint idx) const;
+
+    /* Leaf cells (the ones of the subdomain when the water is split between processes) */
+    void update_leaf_store();
+    uint get_first_cell() const;
+    uint get_end_cell() const;
+
+    /* Simulation (each pass loops over all leaf cells, the overloads taking an index handle one leaf cell) */
+    void calculate_cell_center_properties();
+    void calculate_cell_center_properties(uint idx);
+    void calculate_cell_face_properties();
+    void calculate_cell_face_properties(uint idx, pftype& max_courant_number);
+    void calculate_delta_alpha_recursively(octcell* cell);
+    void clamp_advect_alpha_recursively(octcell* cell);
+    void calculate_alpha_gradient_recursively(octcell* cell);
+    void advect_cell_properties();
+    void calculate_advection(uint idx);
+    void apply_advection(uint idx);
+    void prepare_cells_for_water();
+    //void convert_cell_face_vel_out_to_quasi_momentum_out();
+    void distribute_ceLl_quasi_momentum_on_cell_faces();
+    void distribute_ceLl_quasi_momentum_on_cell_faces(uint idx);
+    //void convert_cell_face_quasi_momentum_out_to_vel_out();
+    //bool advect_and_update_pressure_recursively(octcell* cell);
+    void solve_pressures();
+    void update_velocities_by_the_pressure_gradients();
+    void calculate_properties_blockwise();
+    void calculate_properties_in_block(uint first, uint end, pftype& max_courant_number);
+    void calculate_remaining_advection(uint idx);
+    void update_face_velocities();
+    template<void (watersystem::*pass)(uint)>
+    static void run_leaf_pass(void* watersystem_object, uint part, uint first, uint end);
+    template<void (watersystem::*pass)(uint)>
+    static void run_stepped_leaf_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_cell_face_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_block_pass(void* watersystem_object, uint part, uint first_block, uint end_block);
+    static void run_velocity_face_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_face_velocity_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_pressure_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_apply_advection_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_air_neighbor_request_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_wetted_face_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_multi_rate_face_pass(void* watersystem_object, uint part, uint first, uint end);
+    static void run_multi_rate_velocity_face_pass(void* watersystem_object, uint part, uint first, uint end);
+
+    /* Thread safety */
+    void start_operation();
+    void finish_operation();
+
+    /* Miscellaneous */
+    void process_events();
+};
+
+////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+////////////////////////////////////////////////////////////////
+
+inline
+bool watersystem::is_water_defined() const
+{
+    return w;
+}
+
+inline
+void watersystem::define_water(fvoctree* water, pftype start_time, bool time_staggered, pftype time_step)
+{
+#if  DEBUG
+    if (!water) {
+        throw logic_error("Trying to define water using a NULL pointer");
+    }
+    if (w) {
+        throw logic_error("Trying to define water when it is already defined");
+    }
+#endif
+
+    w = water;
+    t = patype(start_time);
+    current_print_screen_index = 0;
+    while (current_print_screen_index < NUM_PRINTSCREEN_TIMES && PRINTSCREEN_TIMES[current_print_screen_index] < start_time) {
+        current_print_screen_index++;
+    }
+    if (time_staggered) {
+        dt = time_step;
+    }
+    else {
+        dt = 0;
+        set_time_step(time_step);
+    }
+    max_dt = time_step;
+    num_cell_updates = 0;
+    time_step_classes_found = false;
+    num_time_steps_until_regridding = regrid_interval;
+    regridding = regrid_stats();
+    pressure_solver.reset_stats();
+    started = false;
+    paused = false;
+    abort = false;
+}
+
+inline
+void watersystem::redefine_water(fvoctree* water, pftype start_time, bool time_staggered, pftype time_step)
+{
+    undefine_water();
+    define_water(water, start_time, time_staggered, time_step);
+}
+
+inline
+void watersystem::undefine_water()
+{
+#if  DEBUG
+    if (!w) {
+        throw logic_error("Trying to undefine water but it is not currently defined");
+    }
+#endif
+    delete w;
+    w = 0;
+}
+
+inline
+const fvoctree *watersystem::get_water() const
+{
+    return w;
+}
+
+inline
+patype watersystem::get_time() const
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Trying to get time while no water is defined");
+    }
+#endif
+    return t;
+}
+
+inline
+void watersystem::set_time(patype time)
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Trying to set time while no water is defined");
+    }
+#endif
+    t = time;
+}
+
+inline
+pftype watersystem::get_time_step() const
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Trying to get time step while no water is defined");
+    }
+#endif
+    return dt;
+}
+
+inline
+void watersystem::set_number_of_time_steps_before_resting(uint number_of_time_steps)
+{
+#if  DEBUG
+    if (number_of_time_steps <= 0) {
+        throw logic_error("Trying to set an invalid number of time steps before resting");
+    }
+#endif
+    num_time_steps_before_resting = number_of_time_steps;
+}
+
+inline
+uint watersystem::get_time_step_levels() const
+{
+    return time_step_levels;
+}
+
+/*
+ * Lets the cells coarser than the finest ones take longer time steps, up to 2^levels times
+ * as long, see run_multi_rate_cycle. Zero steps all cells with the same time step. May be
+ * called between time steps, but not while the water is split between processes, and only
+ * with artificial compressibility.
+ */
+inline
+void watersystem::set_time_step_levels(uint levels)
+{
+    /* Not only in debug builds, since the halo exchanges and the pressure solver are not run by run_multi_rate_cycle */
+    if (levels && domain) {
+        throw logic_error("Trying to step the cells at different rates while the water is split between processes");
+    }
+#if  !USE_ARTIFICIAL_COMPRESSIBILITY
+    if (levels) {
+        throw logic_error("Trying to step the cells at different rates while the pressures are solved for");
+    }
+#endif
+    time_step_levels = levels;
+    time_step_classes_found = false;
+}
+
+/* The number of times a leaf cell has been advected since the water was defined, which grows with the simulated time more slowly the more levels the time steps have */
+inline
+uint64 watersystem::get_number_of_cell_updates() const
+{
+    return num_cell_updates;
+}
+
+/* Grid */
+
+inline
+uint watersystem::get_regrid_interval() const
+{
+    return regrid_interval;
+}
+
+/* Lets the cells follow the surface, regridding every number of time steps, see regrid. Zero keeps the cells. May be called between time steps. */
+inline
+void watersystem::set_regrid_interval(uint number_of_time_steps)
+{
+    regrid_interval = number_of_time_steps;
+    num_time_steps_until_regridding = number_of_time_steps;
+}
+
+inline
+const watersystem::regrid_stats& watersystem::get_regrid_stats() const
+{
+    return regridding;
+}
+
+/* Pressures */
+
+inline
+const pressuresolver::solve_stats& watersystem::get_pressure_solver_stats() const
+{
+    return pressure_solver.get_stats();
+}
+
+/* Threads */
+
+inline
+uint watersystem::get_number_of_threads() const
+{
+    return workers.get_number_of_threads();
+}
+
+/* Zero means one thread per processor. May be called between time steps, also from the callbacks. */
+inline
+void watersystem::set_number_of_threads(uint number_of_threads)
+{
+    workers.set_number_of_threads(number_of_threads);
+}
+
+/*
+ * [s] The time a thread has spent in the solver passes since the busy times were last reset.
+ * The calling thread is number zero. Comparing the threads shows how well the work is balanced.
+ */
+inline
+double watersystem::get_thread_busy_time(uint thread) const
+{
+#if  DEBUG
+    if (thread >= workers.get_number_of_threads()) {
+        throw out_of_range("Trying to get the busy time of a thread that does not exist");
+    }
+#endif
+    return workers.get_busy_time(thread);
+}
+
+inline
+void watersystem::reset_thread_busy_times()
+{
+    workers.reset_busy_times();
+}
+
+/* Processes */
+
+/*
+ * Lets this process simulate only its part of the water, see subdomain.h. Every process that
+ * shares the simulation must have the same water and call this with its own subdomain, which
+ * splits the water between them, before the simulation is started.
+ */
+inline
+void watersystem::set_subdomain(subdomain* domain)
+{
+#if  DEBUG
+    if (domain && !is_water_defined()) {
+        throw logic_error("Trying to split the water between processes while no water is defined");
+    }
+#endif
+    if (domain && time_step_levels) {
+        throw logic_error("Trying to split the water between processes while the cells are stepped at different rates");
+    }
+    this->domain = domain;
+    if (domain) {
+        w->update_leaf_store();
+        domain->partition(w->leaves);
+    }
+}
+
+inline
+bool watersystem::are_passes_fused() const
+{
+    return passes_fused;
+}
+
+/* Both ways give the same result, fusing the passes only changes the order in which the memory is swept */
+inline
+void watersystem::set_passes_fused(bool fused)
+{
+    passes_fused = fused;
+}
+
+inline
+INSTRUCTION_SET watersystem::get_instruction_set() const
+{
+    return instruction_set;
+}
+
+/* All instruction sets give the same result, see velocitykernel.h and pressurekernel.h */
+inline
+void watersystem::set_instruction_set(INSTRUCTION_SET instruction_set)
+{
+#if  DEBUG
+    if (!instructionset::is_supported(instruction_set)) {
+        throw logic_error("Trying to run the kernels with an instruction set that the processor does not support");
+    }
+#endif
+    this->instruction_set = instruction_set;
+}
+
+/*
+ * Copies the current fields into the snapshot. Must be called between time steps, i.e. on
+ * the thread running the simulation from one of the callbacks, or while no simulation runs.
+ */
+inline
+void watersystem::capture_snapshot(fieldsnapshot& snapshot)
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Trying to capture a snapshot while no water is defined");
+    }
+#endif
+    snapshot.capture(w, get_time());
+}
+
+inline
+void watersystem::set_time_step(pftype time_step)
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Trying to set time step while no water is defined");
+    }
+#endif
+    if (dt != time_step) {
+        // TODO: Update time-staggered parameters (velocities)
+#if  TIME_STEP_CHANGE_CORRECTION && !COURANT_NUMBER_LIMITATION
+        dt = 0.5 * (time_step - dt);
+        update_velocities_by_the_pressure_gradients();
+#endif
+#if  COURANT_NUMBER_LIMITATION
+        max_dt = time_step;
+#else
+        dt = time_step;
+#endif
+    }
+}
+
+inline
+bool watersystem::is_started() const
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Asking if simulation is started while no water is defined");
+    }
+#endif
+    return started;
+}
+
+inline
+bool watersystem::is_paused() const
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Asking if simulation is paused while no water is defined");
+    }
+#endif
+    return paused;
+}
+
+inline
+bool watersystem::is_operating() const
+{
+    return operating;
+}
+
+inline
+void watersystem::pause_simulation(bool jump_out_of_main_loop)
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Trying to pause simulation while no water is defined");
+    }
+    if (!started) {
+        throw logic_error("Trying to pause simulation while not started any");
+    }
+    if (paused) {
+        throw logic_error("Trying to pause simulation while already paused");
+    }
+#endif
+    paused = true;
+    break_main_loop_when_pausing = jump_out_of_main_loop;
+}
+
+inline
+void watersystem::continue_simulation()
+{
+#if  DEBUG
+    if (!is_water_defined()) {
+        throw logic_error("Trying to continue simulation while no water is defined");
+    }
+    if (!started) {
+        throw logic_error("Trying to continue simulation while not started any");
+    }if (!paused) {
+        throw logic_error("Trying to continue simulation while not paused");
+    }
+#endif
+    if (break_main_loop_when_pausing) {
+        paused = false;
+    }
+    else {
+        run_simulation(dt);
+    }
+}
+
+inline
+void watersystem::abort_ongoing_operation()
+{
+#if  DEBUG
+    if (!operating) {
+        throw logic_error("Trying to abort operation while not doing any");
+    }
+#endif
+    abort = true;
+}
+
+inline
+void watersystem::set_state_updated_callback(callback<void (*)(void*)> callback)
+{
+    state_updated_callback = callback;
+}
+
+inline
+void watersystem::set_state_updated_callback(void (*function)(void*), void* parameter)
+{
+    state_updated_callback.func  = function ;
+    state_updated_callback.param = parameter;
+}
+
+inline
+void watersystem::set_take_printscreen_callback(callback<void (*)(void*)> callback)
+{
+    take_printscreen_callback = callback;
+}
+
+inline
+void watersystem::set_take_printscreen_callback(void (*function)(void*), void* parameter)
+{
+    take_printscreen_callback.func  = function ;
+    take_printscreen_callback.param = parameter;
+}
+
+/* Miscellaneous */
+
+inline
+void watersystem::process_events()
+{
+    // Let the application process its events
+    if (state_updated_callback.is_defined()) {
+        state_updated_callback.func(state_updated_callback.param);
+    }
+}
+
+#endif // WATERSYSTEM_H